@@ -0,0 +1,75 @@
+/******************************************************************************
+ * @file BenchUtil.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Helpers shared by the host benchmarks of the signal processing
+ *
+ * @details Seeded random numbers, the time measurement and the reference
+ * FIR coefficients of FilterBench and DSPBench.
+ *
+ *
+ *****************************************************************************/
+#ifndef _BENCH_UTIL_H_
+#define _BENCH_UTIL_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+#include <time.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#define BENCH_SEED                  12345u  //!< Seed of the generated signals
+
+#define BENCH_FIR_TAPS              16      //!< Number of taps of the reference FIR filter
+#define BENCH_FIR_FRACTIONAL_BITS   15      //!< The reference coefficients are Q15
+
+/**
+ * @brief Initializer of the reference FIR coefficients: a Hamming windowed
+ * sinc low pass with a cutoff at a quarter of the sample rate. The sum is
+ * 32768 (gain 1), the benchmarks store it as int32_t or int16_t.
+ */
+#define BENCH_FIR_COEFFICIENTS { \
+    -79, -136, 312, 654, -1244, -2280, 4501, 14656, \
+    14656, 4501, -2280, -1244, 654, 312, -136, -79, \
+}
+
+
+/***** TYPES *****************************************************************/
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief xorshift32 random generator
+ *
+ * @param pState    State of the generator, initialized with the seed (not 0)
+ *
+ * @return Next random number
+ */
+static inline uint32_t benchRandom(uint32_t* pState)
+{
+    *pState ^= *pState << 13;
+    *pState ^= *pState >> 17;
+    *pState ^= *pState << 5;
+
+    return *pState;
+}
+
+/**
+ * @brief Returns the time between two time stamps in nanoseconds
+ */
+static inline double benchElapsedNanoseconds(const struct timespec* pStart, const struct timespec* pEnd)
+{
+    return (double) (pEnd->tv_sec - pStart->tv_sec) * 1e9 + (double) (pEnd->tv_nsec - pStart->tv_nsec);
+}
+
+#endif
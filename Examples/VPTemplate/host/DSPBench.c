@@ -0,0 +1,256 @@
+/******************************************************************************
+ * @file DSPBench.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Host benchmark and reference check for the DSP kernels
+ *
+ * @details Every kernel has to match its direct implementation of
+ * DSPBenchmark.c exactly. The check runs on
+ * seeded full scale samples (including -32768) for all lengths up to
+ * CHECK_MAX_LENGTH at even and odd start addresses, so the odd last sample
+ * and the unaligned pair reads are covered. Afterwards both are timed on a
+ * block of BENCH_LENGTH samples.
+ *
+ * On the host the kernels run with the C replacements of the SIMD
+ * instructions, so the timing only shows the overhead of the pairwise
+ * algorithm (about 1x), not the gain of the instructions. The gain is
+ * measured on the Cortex-M4 by dspRunBenchmark() with the cycle counter
+ * (DSP_BENCHMARK_ENABLED); here it runs with a nanosecond counter to check
+ * that the firmware benchmark reports no mismatch.
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "DSP/DSPKernels.h"
+#include "DSP/DSPBenchmark.h"
+
+#include "BenchUtil.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+static const uint32_t BENCH_RUNS = 2000;                //!< Timed runs per kernel
+
+static const int16_t BENCH_SCALE = 26214;               //!< 0.8 in Q15
+static const int16_t BENCH_OFFSET = 12000;              //!< Offset of the scale benchmark, saturates some samples
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define BENCH_LENGTH        4096    //!< Samples per timed block
+#define CHECK_MAX_LENGTH    64      //!< Largest block length of the reference check
+
+/**
+ * @brief Times BENCH_RUNS calls of a statement
+ *
+ * @param pTime     Receives the time per sample [ns]
+ */
+#define BENCH_TIME(pTime, statement) \
+    do { \
+        struct timespec start; \
+        struct timespec end; \
+        clock_gettime(CLOCK_MONOTONIC, &start); \
+        for (uint32_t run = 0; run < BENCH_RUNS; run++) \
+        { \
+            statement; \
+            benchClobber(); \
+        } \
+        clock_gettime(CLOCK_MONOTONIC, &end); \
+        *(pTime) = benchElapsedNanoseconds(&start, &end) / ((double) BENCH_RUNS * BENCH_LENGTH); \
+    } while (0)
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static void buildSamples(void);
+static void benchClobber(void);
+static uint32_t hostNanoseconds(void);
+static int32_t checkKernels(void);
+static void benchmarkKernels(void);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static int16_t s_samplesA[BENCH_LENGTH + BENCH_FIR_TAPS];   //!< First input (with FIR history)
+static int16_t s_samplesB[BENCH_LENGTH + BENCH_FIR_TAPS];   //!< Second input of the dot product
+static int16_t s_output[BENCH_LENGTH];                  //!< Output of the kernel
+static int16_t s_referenceOutput[BENCH_LENGTH];         //!< Output of the reference
+static volatile int64_t s_sink;                         //!< Keeps the results of the timed calls
+static const int16_t s_firCoefficients[BENCH_FIR_TAPS] = BENCH_FIR_COEFFICIENTS;   //!< Reference low pass
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int main(void)
+{
+    buildSamples();
+
+    int32_t failures = checkKernels();
+    printf("DSP kernel check: lengths 0..%u, even and odd start, %s\n", CHECK_MAX_LENGTH,
+           (failures == 0) ? "all exact" : "MISMATCH");
+
+    benchmarkKernels();
+
+    printf("\nFirmware benchmark with the nanosecond counter:\n");
+    failures += dspRunBenchmark(hostNanoseconds, printf);
+
+    return (failures == 0) ? 0 : 1;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief Fills the inputs with full scale xorshift noise, -32768 included
+ */
+static void buildSamples(void)
+{
+    uint32_t random = BENCH_SEED;
+    for (uint32_t i = 0; i < BENCH_LENGTH + BENCH_FIR_TAPS; i++)
+    {
+        benchRandom(&random);
+        s_samplesA[i] = (int16_t) random;
+        s_samplesB[i] = (int16_t) (random >> 16);
+    }
+    s_samplesA[3] = INT16_MIN;
+    s_samplesB[3] = INT16_MIN;
+    s_samplesA[8] = INT16_MAX;
+}
+
+/**
+ * @brief Keeps the compiler from merging or removing the timed runs
+ */
+static void benchClobber(void)
+{
+    __asm__ volatile("" ::: "memory");
+}
+
+/**
+ * @brief Counter of dspRunBenchmark(), the host has no cycle counter
+ */
+static uint32_t hostNanoseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t) ((uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec);
+}
+
+/**
+ * @brief Compares all kernels with the references
+ *
+ * @return Number of mismatches
+ */
+static int32_t checkKernels(void)
+{
+    int32_t failures = 0;
+
+    for (uint32_t start = 0; start < 2; start++)
+    {
+        const int16_t* pA = &s_samplesA[start];
+        const int16_t* pB = &s_samplesB[start];
+
+        for (uint32_t length = 0; length <= CHECK_MAX_LENGTH; length++)
+        {
+            if (dspDotProduct16(pA, pB, length) != dspDirectDotProduct16(pA, pB, length))
+            {
+                printf("ERROR: dot product, start %u, length %u\n", start, length);
+                failures++;
+            }
+
+            if (dspSumOfSquares16(pA, length) != dspDirectSumOfSquares16(pA, length))
+            {
+                printf("ERROR: sum of squares, start %u, length %u\n", start, length);
+                failures++;
+            }
+
+            // The output starts at an odd address as well, the last sample stays untouched
+            memset(s_output, 0x55, sizeof(s_output));
+            memset(s_referenceOutput, 0x55, sizeof(s_referenceOutput));
+            dspScaleOffset16(pA, &s_output[start], length, BENCH_SCALE, BENCH_OFFSET);
+            dspDirectScaleOffset16(pA, &s_referenceOutput[start], length, BENCH_SCALE, BENCH_OFFSET);
+            if (memcmp(s_output, s_referenceOutput, sizeof(s_output)) != 0)
+            {
+                printf("ERROR: scale and offset, start %u, length %u\n", start, length);
+                failures++;
+            }
+
+            for (uint32_t taps = 1; taps <= BENCH_FIR_TAPS; taps += 3)
+            {
+                memset(s_output, 0x55, sizeof(s_output));
+                memset(s_referenceOutput, 0x55, sizeof(s_referenceOutput));
+                dspFir16(&s_firCoefficients[BENCH_FIR_TAPS - taps], taps, pA, s_output, length);
+                dspDirectFir16(&s_firCoefficients[BENCH_FIR_TAPS - taps], taps, pA, s_referenceOutput, length);
+                if (memcmp(s_output, s_referenceOutput, sizeof(s_output)) != 0)
+                {
+                    printf("ERROR: FIR, start %u, length %u, taps %u\n", start, length, taps);
+                    failures++;
+                }
+            }
+
+            if (length > 0)
+            {
+                int16_t minimum = 0;
+                int16_t maximum = 0;
+                int16_t referenceMinimum = 0;
+                int16_t referenceMaximum = 0;
+                dspMinMax16(pA, length, &minimum, &maximum);
+                dspDirectMinMax16(pA, length, &referenceMinimum, &referenceMaximum);
+                if (minimum != referenceMinimum || maximum != referenceMaximum)
+                {
+                    printf("ERROR: min/max, start %u, length %u\n", start, length);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Times the kernels and the references on a block of BENCH_LENGTH samples
+ */
+static void benchmarkKernels(void)
+{
+    int16_t minimum = 0;
+    int16_t maximum = 0;
+    double kernelTime = 0.0;
+    double referenceTime = 0.0;
+
+    printf("\nDSP kernels (%u samples per block, %s)\n", BENCH_LENGTH,
+           DSP_SIMD_ENABLED ? "SIMD instructions" : "C replacements of the SIMD instructions");
+    printf("%-24s %18s %18s %10s\n", "kernel", "packed [ns/sample]", "direct [ns/sample]", "speedup");
+
+    BENCH_TIME(&kernelTime, s_sink = dspDotProduct16(s_samplesA, s_samplesB, BENCH_LENGTH));
+    BENCH_TIME(&referenceTime, s_sink = dspDirectDotProduct16(s_samplesA, s_samplesB, BENCH_LENGTH));
+    printf("%-24s %18.3f %18.3f %9.2fx\n", "dot product", kernelTime, referenceTime, referenceTime / kernelTime);
+
+    BENCH_TIME(&kernelTime, dspFir16(s_firCoefficients, BENCH_FIR_TAPS, s_samplesA, s_output, BENCH_LENGTH));
+    BENCH_TIME(&referenceTime, dspDirectFir16(s_firCoefficients, BENCH_FIR_TAPS, s_samplesA, s_output, BENCH_LENGTH));
+    printf("%-24s %18.3f %18.3f %9.2fx\n", "FIR 16 taps", kernelTime, referenceTime, referenceTime / kernelTime);
+
+    BENCH_TIME(&kernelTime, dspScaleOffset16(s_samplesA, s_output, BENCH_LENGTH, BENCH_SCALE, BENCH_OFFSET));
+    BENCH_TIME(&referenceTime, dspDirectScaleOffset16(s_samplesA, s_output, BENCH_LENGTH, BENCH_SCALE, BENCH_OFFSET));
+    printf("%-24s %18.3f %18.3f %9.2fx\n", "scale and offset", kernelTime, referenceTime, referenceTime / kernelTime);
+
+    BENCH_TIME(&kernelTime, dspMinMax16(s_samplesA, BENCH_LENGTH, &minimum, &maximum); s_sink = minimum + maximum);
+    BENCH_TIME(&referenceTime, dspDirectMinMax16(s_samplesA, BENCH_LENGTH, &minimum, &maximum); s_sink = minimum + maximum);
+    printf("%-24s %18.3f %18.3f %9.2fx\n", "min/max", kernelTime, referenceTime, referenceTime / kernelTime);
+
+    BENCH_TIME(&kernelTime, s_sink = dspSumOfSquares16(s_samplesA, BENCH_LENGTH));
+    BENCH_TIME(&referenceTime, s_sink = dspDirectSumOfSquares16(s_samplesA, BENCH_LENGTH));
+    printf("%-24s %18.3f %18.3f %9.2fx\n", "sum of squares", kernelTime, referenceTime, referenceTime / kernelTime);
+}
@@ -0,0 +1,432 @@
+/******************************************************************************
+ * @file FilterBench.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Host benchmark and reference check for the Filter library
+ *
+ * @details Every filter processes the same seeded signal (a slow ramp with
+ * noise in the range of the potentiometer voltages). The moving average
+ * and the FIR filter have to match a direct implementation exactly, the
+ * EMA and the IIR filter a floating point reference within their rounding.
+ * The EMA runs with alpha = 1/4 (shift) and alpha = 1/5 (division).
+ * The moving average is also timed against the former implementation of
+ * the ADC service, which shifts the whole window for every sample.
+ *
+ * The sliding median is compared with sorting a copy of the window for
+ * every sample at window sizes from 5 to 64, on the signal with spikes.
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Filter/Filter.h"
+
+#include "BenchUtil.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+static const int32_t BENCH_EMA_SHIFT = 2;               //!< alpha = 1/4 like the first potentiometer (shift)
+static const int32_t BENCH_EMA_DIVISOR = 5;             //!< alpha = 1/5 (multiplication and division)
+
+static const uint8_t BENCH_IIR_FRACTIONAL_BITS = 15;    //!< Q15 coefficients
+static const double BENCH_IIR_TOLERANCE = 4.0;          //!< Allowed deviation of the IIR from the reference [digits]
+
+static const uint16_t BENCH_MEDIAN_WINDOWS[] = {5, 8, 16, 32, 64};     //!< Window sizes of the median benchmark
+static const int32_t BENCH_SPIKE_PERIOD = 97;           //!< Every n-th sample of the median signal is a spike
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define BENCH_SAMPLES               1000000 //!< Number of filtered samples per run
+#define BENCH_WINDOW_SIZE           32      //!< Window of the moving averages
+#define BENCH_MEDIAN_SAMPLES        200000  //!< Number of samples of the median benchmark (the sorting is slow)
+#define BENCH_MEDIAN_MAX_WINDOW     64      //!< Largest window of the median benchmark
+
+#define ARRAY_SIZE(x)       (sizeof(x) / sizeof((x)[0]))
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static void buildSignal(void);
+static int32_t checkEMA(int32_t scalingFactor, int32_t expectedShift, double* pTime, double* pMaxError);
+static int32_t checkMovingAverage(double* pTime, double* pShiftTime);
+static int32_t checkIIR(double* pTime, double* pMaxError);
+static int32_t checkFIR(double* pTime);
+static int32_t checkMedian(uint16_t windowSize, double* pTime, double* pSortTime);
+static int compareValues(const void* pA, const void* pB);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static int32_t s_signal[BENCH_SAMPLES];                 //!< Input of the filters [µV]
+static int32_t s_output[BENCH_SAMPLES];                 //!< Output of the filter under test
+
+static const int32_t s_firCoefficients[BENCH_FIR_TAPS] = BENCH_FIR_COEFFICIENTS;   //!< Reference low pass
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int main(void)
+{
+    buildSignal();
+
+    double emaTime = 0.0;
+    double emaError = 0.0;
+    double emaDivisionTime = 0.0;
+    double emaDivisionError = 0.0;
+    double maTime = 0.0;
+    double maShiftTime = 0.0;
+    double iirTime = 0.0;
+    double iirError = 0.0;
+    double firTime = 0.0;
+
+    int32_t failures = checkEMA(1 << BENCH_EMA_SHIFT, BENCH_EMA_SHIFT, &emaTime, &emaError);
+    failures += checkEMA(BENCH_EMA_DIVISOR, -1, &emaDivisionTime, &emaDivisionError);
+    failures += checkMovingAverage(&maTime, &maShiftTime);
+    failures += checkIIR(&iirTime, &iirError);
+    failures += checkFIR(&firTime);
+
+    printf("Filter benchmark (%u samples)\n", BENCH_SAMPLES);
+    printf("%-28s %14s %18s\n", "filter", "[ns/sample]", "max error [digits]");
+    printf("%-28s %14.2f %18.2f\n", "EMA 1/4 (shift)", emaTime, emaError);
+    printf("%-28s %14.2f %18.2f\n", "EMA 1/5 (division)", emaDivisionTime, emaDivisionError);
+    printf("%-28s %14.2f %18s\n", "moving average (ring)", maTime, "exact");
+    printf("%-28s %14.2f %18s\n", "moving average (shift)", maShiftTime, "-");
+    printf("%-28s %14.2f %18.2f\n", "IIR first order", iirTime, iirError);
+    printf("%-28s %14.2f %18s\n", "FIR 16 taps", firTime, "exact");
+
+    printf("\nSliding median (%u samples, spike every %d samples)\n", BENCH_MEDIAN_SAMPLES, BENCH_SPIKE_PERIOD);
+    printf("%8s %18s %18s %10s\n", "window", "heaps [ns/sample]", "sort [ns/sample]", "speedup");
+    for (uint32_t i = 0; i < ARRAY_SIZE(BENCH_MEDIAN_WINDOWS); i++)
+    {
+        double medianTime = 0.0;
+        double sortTime = 0.0;
+        failures += checkMedian(BENCH_MEDIAN_WINDOWS[i], &medianTime, &sortTime);
+        printf("%8u %18.2f %18.2f %9.2fx\n", BENCH_MEDIAN_WINDOWS[i], medianTime, sortTime, sortTime / medianTime);
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief Builds a ramp from 0.5 V to 2.5 V and back with a noise of
+ * +-50 mV, like a potentiometer which is turned slowly
+ */
+static void buildSignal(void)
+{
+    uint32_t random = BENCH_SEED;
+    for (int32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        benchRandom(&random);
+
+        int32_t position = i % (BENCH_SAMPLES / 4);
+        int32_t ramp = (i / (BENCH_SAMPLES / 4)) % 2 == 0 ? position : (BENCH_SAMPLES / 4) - position;
+        s_signal[i] = 500000 + (int32_t) (((int64_t) ramp * 2000000) / (BENCH_SAMPLES / 4))
+                    + (int32_t) (random % 100001) - 50000;
+    }
+}
+
+/**
+ * @brief Times the EMA filter with alpha = 1 / scalingFactor and compares
+ * it with a floating point EMA. Rounding every step to the nearest digit
+ * keeps the deviation within 0.5 / alpha, truncating would double it.
+ *
+ * @param scalingFactor     Scaling factor, alpha is 1
+ * @param expectedShift     Expected shift of the filter, -1 for the division
+ *
+ * @return Number of failed checks
+ */
+static int32_t checkEMA(int32_t scalingFactor, int32_t expectedShift, double* pTime, double* pMaxError)
+{
+    EMAFilterData_t ema;
+    if (filterInitEMA(&ema, scalingFactor, 1, true) != FILTER_ERR_OK || ema.shift != expectedShift)
+    {
+        printf("ERROR: EMA initialization failed\n");
+        return 1;
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        s_output[i] = filterEMA(&ema, s_signal[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *pTime = benchElapsedNanoseconds(&start, &end) / BENCH_SAMPLES;
+
+    double alpha = 1.0 / scalingFactor;
+    double tolerance = 0.5 * scalingFactor;
+    double reference = s_signal[0];
+    *pMaxError = 0.0;
+    for (int32_t i = 1; i < BENCH_SAMPLES; i++)
+    {
+        reference += alpha * (s_signal[i] - reference);
+        *pMaxError = fmax(*pMaxError, fabs(s_output[i] - reference));
+    }
+
+    if (*pMaxError > tolerance)
+    {
+        printf("ERROR: EMA 1/%d deviates by %.2f digits from the reference\n", scalingFactor, *pMaxError);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Times the ring buffer moving average and the former shifting
+ * window, both have to return the same averages once the window is filled
+ *
+ * @return Number of failed checks
+ */
+static int32_t checkMovingAverage(double* pTime, double* pShiftTime)
+{
+    MovingAverageData_t movingAverage;
+    int32_t window[BENCH_WINDOW_SIZE];
+    if (FILTER_INIT_MOVING_AVERAGE(&movingAverage, window) != FILTER_ERR_OK)
+    {
+        printf("ERROR: moving average initialization failed\n");
+        return 1;
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        s_output[i] = filterMovingAverage(&movingAverage, s_signal[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *pTime = benchElapsedNanoseconds(&start, &end) / BENCH_SAMPLES;
+
+    // Former implementation of the ADC service
+    static int32_t lastInputs[BENCH_WINDOW_SIZE];
+    int32_t failures = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int32_t n = 0; n < BENCH_SAMPLES; n++)
+    {
+        int32_t sum = s_signal[n];
+        for (int32_t i = BENCH_WINDOW_SIZE - 1; i > 0; i--)
+        {
+            lastInputs[i] = lastInputs[i - 1];
+            sum += lastInputs[i];
+        }
+        lastInputs[0] = s_signal[n];
+
+        if (n >= BENCH_WINDOW_SIZE - 1 && sum / BENCH_WINDOW_SIZE != s_output[n])
+        {
+            failures++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *pShiftTime = benchElapsedNanoseconds(&start, &end) / BENCH_SAMPLES;
+
+    if (failures != 0)
+    {
+        printf("ERROR: moving average differs in %d samples\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Times a first order low pass (IIR) and compares it with the same
+ * filter in floating point
+ *
+ * @return Number of failed checks
+ */
+static int32_t checkIIR(double* pTime, double* pMaxError)
+{
+    // Low pass y = 0.1 * (x + x1) / 2 + 0.9 * y1 (bilinear form)
+    const double b = 0.05;
+    const double a = -0.9;
+    int32_t scale = 1 << BENCH_IIR_FRACTIONAL_BITS;
+    int32_t bScaled = (int32_t) lround(b * scale);
+    int32_t aScaled = (int32_t) lround(a * scale);
+
+    IIRFilterData_t iir;
+    if (filterInitIIR(&iir, bScaled, bScaled, aScaled, BENCH_IIR_FRACTIONAL_BITS, true) != FILTER_ERR_OK ||
+        filterInitIIR(&iir, bScaled, bScaled, -scale, BENCH_IIR_FRACTIONAL_BITS, false) != FILTER_ERR_INVALID_PARAM)
+    {
+        printf("ERROR: IIR initialization failed\n");
+        return 1;
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        s_output[i] = filterIIR(&iir, s_signal[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *pTime = benchElapsedNanoseconds(&start, &end) / BENCH_SAMPLES;
+
+    // The reference uses the quantized coefficients, so only the rounding differs
+    double bReference = (double) bScaled / scale;
+    double aReference = (double) aScaled / scale;
+    double previousOutput = s_signal[0] * (2.0 * bReference) / (1.0 + aReference);
+    *pMaxError = fabs(s_output[0] - previousOutput);
+    for (int32_t i = 1; i < BENCH_SAMPLES; i++)
+    {
+        previousOutput = bReference * s_signal[i] + bReference * s_signal[i - 1] - aReference * previousOutput;
+        *pMaxError = fmax(*pMaxError, fabs(s_output[i] - previousOutput));
+    }
+
+    if (*pMaxError > BENCH_IIR_TOLERANCE)
+    {
+        printf("ERROR: IIR deviates by %.2f digits from the reference\n", *pMaxError);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Times the FIR filter and compares it with the direct convolution
+ *
+ * @return Number of failed checks
+ */
+static int32_t checkFIR(double* pTime)
+{
+    FIRFilterData_t fir;
+    int32_t history[BENCH_FIR_TAPS];
+    if (FILTER_INIT_FIR(&fir, s_firCoefficients, history, BENCH_FIR_FRACTIONAL_BITS) != FILTER_ERR_OK)
+    {
+        printf("ERROR: FIR initialization failed\n");
+        return 1;
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        s_output[i] = filterFIR(&fir, s_signal[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *pTime = benchElapsedNanoseconds(&start, &end) / BENCH_SAMPLES;
+
+    // Before the start the input is assumed constant (first value)
+    int32_t failures = 0;
+    for (int32_t n = 0; n < BENCH_SAMPLES; n++)
+    {
+        int64_t accumulator = 0;
+        for (int32_t k = 0; k < BENCH_FIR_TAPS; k++)
+        {
+            accumulator += (int64_t) s_firCoefficients[k] * s_signal[(n - k >= 0) ? n - k : 0];
+        }
+        int32_t expected = (int32_t) ((accumulator + (1 << (BENCH_FIR_FRACTIONAL_BITS - 1))) >> BENCH_FIR_FRACTIONAL_BITS);
+
+        if (expected != s_output[n])
+        {
+            failures++;
+        }
+    }
+
+    if (failures != 0)
+    {
+        printf("ERROR: FIR differs in %d samples\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Times the median filter and the sorting of a window copy for every
+ * sample, both have to return the same medians (also while filling)
+ *
+ * @param windowSize Window size of both variants
+ *
+ * @return Number of failed checks
+ */
+static int32_t checkMedian(uint16_t windowSize, double* pTime, double* pSortTime)
+{
+    static int32_t input[BENCH_MEDIAN_SAMPLES];
+    static int32_t sorted[BENCH_MEDIAN_SAMPLES];
+
+    // Full scale spikes on top of the ramp
+    for (int32_t i = 0; i < BENCH_MEDIAN_SAMPLES; i++)
+    {
+        input[i] = (i % BENCH_SPIKE_PERIOD == 0) ? 3300000 : s_signal[i];
+    }
+
+    MedianFilterData_t median;
+    MedianFilterNode_t nodes[BENCH_MEDIAN_MAX_WINDOW];
+    if (filterInitMedian(&median, nodes, windowSize) != FILTER_ERR_OK)
+    {
+        printf("ERROR: median initialization failed\n");
+        return 1;
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int32_t i = 0; i < BENCH_MEDIAN_SAMPLES; i++)
+    {
+        s_output[i] = filterMedian(&median, input[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *pTime = benchElapsedNanoseconds(&start, &end) / BENCH_MEDIAN_SAMPLES;
+
+    int32_t window[BENCH_MEDIAN_MAX_WINDOW];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int32_t i = 0; i < BENCH_MEDIAN_SAMPLES; i++)
+    {
+        int32_t count = (i + 1 < windowSize) ? i + 1 : windowSize;
+        memcpy(window, &input[i + 1 - count], (size_t) count * sizeof(int32_t));
+        qsort(window, (size_t) count, sizeof(int32_t), compareValues);
+
+        sorted[i] = ((count & 1) != 0) ? window[count / 2] :
+                    (int32_t) (((int64_t) window[count / 2 - 1] + window[count / 2]) / 2);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *pSortTime = benchElapsedNanoseconds(&start, &end) / BENCH_MEDIAN_SAMPLES;
+
+    int32_t failures = 0;
+    for (int32_t i = 0; i < BENCH_MEDIAN_SAMPLES; i++)
+    {
+        if (sorted[i] != s_output[i])
+        {
+            failures++;
+        }
+    }
+
+    if (failures != 0)
+    {
+        printf("ERROR: median of window %u differs in %d samples\n", windowSize, failures);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Compare function of qsort() for int32_t values
+ */
+static int compareValues(const void* pA, const void* pB)
+{
+    int32_t a = *(const int32_t*) pA;
+    int32_t b = *(const int32_t*) pB;
+
+    return (a > b) - (a < b);
+}
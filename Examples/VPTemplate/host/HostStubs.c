@@ -0,0 +1,286 @@
+/******************************************************************************
+ * @file HostStubs.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief HAL module stubs of the host builds
+ *
+ * @details The stack monitoring is replaced as well, as it scans the stack
+ * region given by the linker script of the target.
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "stm32g4xx_hal.h"
+
+#include "HostStubs.h"
+#include "LEDModule.h"
+#include "DisplayModule.h"
+#include "LogOutput.h"
+#include "StackMonitoring.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define HOST_BUTTON_COUNT           3           //!< Number of buttons
+#define HOST_ADC_MAX_MICROVOLT      3300000     //!< Reference voltage of the ADC
+#define HOST_ADC_MAX_DIGITS         65535       //!< Maximum raw value, scaled to 16 bit like the firmware
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static int32_t s_adcMicrovolt[ADC_CHANNEL_COUNT];         //!< Simulated ADC input voltages
+static ADCConversionCallback s_conversionCallback = 0;          //!< Registered ADC conversion callback
+static ADCBlock_t s_adcBlock;                                   //!< Block of the last simulated conversion
+static const ADCProfile_t* s_adcProfile = &gADCProfileStandard;    //!< Active ADC profile
+static ADCChannelValue_t s_adcChannelValues[ADC_CHANNEL_COUNT];     //!< Decimated values of the channels
+static uint32_t s_adcDecimationSums[ADC_CHANNEL_COUNT];             //!< Sum of the block values of the running decimation period
+static uint32_t s_adcDecimationBlocks[ADC_CHANNEL_COUNT];           //!< Number of blocks of the running decimation period
+static Button_Status_t s_buttonStatus[HOST_BUTTON_COUNT] = {BUTTON_RELEASED, BUTTON_RELEASED, BUTTON_RELEASED};    //!< Simulated buttons
+static bool s_logEcho = false;                                  //!< Print the log output to stdout
+static uint32_t s_logCount = 0;                                 //!< Number of log outputs
+
+const int32_t STACK_CHECK_FAILED = -1;                          //!< Return value for failed stack check
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+void hostSetADCVoltage(ADC_Channel_t channel, int32_t microvolt)
+{
+    if ((uint32_t) channel < ADC_CHANNEL_COUNT)
+    {
+        s_adcMicrovolt[channel] = microvolt;
+    }
+}
+
+void hostTriggerADCConversion(void)
+{
+    // The inputs don't change within a block
+    s_adcBlock.sequence = (s_adcBlock.sequence != 0) ? s_adcBlock.sequence + ADC_BLOCK_SEQUENCES : 1;
+    s_adcBlock.timestamp = HAL_GetTick();
+    for (int32_t sequence = 0; sequence < ADC_BLOCK_SEQUENCES; sequence++)
+    {
+        for (int32_t i = 0; i < ADC_CHANNEL_COUNT; i++)
+        {
+            s_adcBlock.values[sequence][i] = (uint16_t) adcReadChannelRaw((ADC_Channel_t) i);
+        }
+    }
+
+    // Decimation like the firmware, the block average is the value of any sequence
+    for (int32_t i = 0; i < ADC_CHANNEL_COUNT; i++)
+    {
+        uint32_t decimation = (s_adcProfile->channels[i].decimation > 1) ? s_adcProfile->channels[i].decimation : 1;
+
+        s_adcDecimationSums[i] += s_adcBlock.values[0][i];
+        s_adcDecimationBlocks[i]++;
+        if (s_adcDecimationBlocks[i] >= decimation)
+        {
+            s_adcChannelValues[i].value = (uint16_t) ((s_adcDecimationSums[i] + decimation / 2) / decimation);
+            s_adcChannelValues[i].count = (s_adcChannelValues[i].count != UINT16_MAX) ? s_adcChannelValues[i].count + 1 : 1;
+            s_adcDecimationSums[i] = 0;
+            s_adcDecimationBlocks[i] = 0;
+        }
+    }
+
+    if (s_conversionCallback != 0)
+    {
+        s_conversionCallback();
+    }
+}
+
+void hostSetButton(Button_t button, Button_Status_t status)
+{
+    if ((uint32_t) button < HOST_BUTTON_COUNT)
+    {
+        s_buttonStatus[button] = status;
+    }
+}
+
+void hostSetLogEcho(bool echo)
+{
+    s_logEcho = echo;
+}
+
+uint32_t hostGetLogCount(void)
+{
+    return s_logCount;
+}
+
+int32_t adcInitialize()
+{
+    return adcSetProfile(&gADCProfileStandard);
+}
+
+int32_t adcSetProfile(const ADCProfile_t* pProfile)
+{
+    if (pProfile == 0 || pProfile->triggerFrequency == 0)
+    {
+        return ADC_ERR_INVALID_PARAM;
+    }
+
+    // The decimation restarts, the values of the previous profile stay readable
+    s_adcProfile = pProfile;
+    memset(s_adcDecimationSums, 0, sizeof(s_adcDecimationSums));
+    memset(s_adcDecimationBlocks, 0, sizeof(s_adcDecimationBlocks));
+
+    return ADC_ERR_OK;
+}
+
+const ADCProfile_t* adcGetProfile()
+{
+    return s_adcProfile;
+}
+
+int32_t adcGetChannelValue(ADC_Channel_t adcChannel, ADCChannelValue_t* pValue)
+{
+    if ((uint32_t) adcChannel >= ADC_CHANNEL_COUNT)
+    {
+        memset(pValue, 0, sizeof(ADCChannelValue_t));
+        return ADC_ERR_NO_DATA;
+    }
+
+    *pValue = s_adcChannelValues[adcChannel];
+
+    return (pValue->count != 0) ? ADC_ERR_OK : ADC_ERR_NO_DATA;
+}
+
+int32_t adcRegisterConversionCallback(ADCConversionCallback callback)
+{
+    s_conversionCallback = callback;
+
+    return ADC_ERR_OK;
+}
+
+int32_t adcReadChannel(ADC_Channel_t adcChannel)
+{
+    return ((uint32_t) adcChannel < ADC_CHANNEL_COUNT) ? s_adcMicrovolt[adcChannel] : 0;
+}
+
+int32_t adcReadChannelRaw(ADC_Channel_t adcChannel)
+{
+    return (int32_t) (((int64_t) adcReadChannel(adcChannel) * HOST_ADC_MAX_DIGITS) / HOST_ADC_MAX_MICROVOLT);
+}
+
+int32_t adcGetSnapshot(ADCSnapshot_t* pSnapshot)
+{
+    if (s_adcBlock.sequence == 0)
+    {
+        memset(pSnapshot, 0, sizeof(ADCSnapshot_t));
+        return ADC_ERR_NO_DATA;
+    }
+
+    pSnapshot->sequence = s_adcBlock.sequence + ADC_BLOCK_SEQUENCES - 1;
+    pSnapshot->timestamp = s_adcBlock.timestamp;
+    memcpy(pSnapshot->values, s_adcBlock.values[ADC_BLOCK_SEQUENCES - 1], sizeof(pSnapshot->values));
+
+    return ADC_ERR_OK;
+}
+
+int32_t adcGetBlock(ADCBlock_t* pBlock)
+{
+    *pBlock = s_adcBlock;
+
+    return (s_adcBlock.sequence != 0) ? ADC_ERR_OK : ADC_ERR_NO_DATA;
+}
+
+int32_t adcConvertToMicrovolt(int32_t rawValue)
+{
+    return (int32_t) (((int64_t) rawValue * HOST_ADC_MAX_MICROVOLT) / HOST_ADC_MAX_DIGITS);
+}
+
+int32_t buttonInitialize()
+{
+    return 0;
+}
+
+Button_Status_t buttonGetButtonStatus(Button_t button)
+{
+    return ((uint32_t) button < HOST_BUTTON_COUNT) ? s_buttonStatus[button] : BUTTON_RELEASED;
+}
+
+int32_t ledInitialize()
+{
+    return 0;
+}
+
+void ledToggleLED(LED_t led)
+{
+}
+
+void ledSetLED(LED_t led, LED_Status_t ledStatus)
+{
+}
+
+int32_t displayInitialize()
+{
+    return 0;
+}
+
+int32_t displayShowDigit(Display_t outputDisplay, int8_t digit)
+{
+    return 0;
+}
+
+void outputLog(const char* msg)
+{
+    s_logCount++;
+    if (s_logEcho)
+    {
+        fputs(msg, stdout);
+    }
+}
+
+int outputLogf(const char* format, ...)
+{
+    int ret = 0;
+    va_list va;
+
+    s_logCount++;
+    va_start(va, format);
+    if (s_logEcho)
+    {
+        ret = vprintf(format, va);
+    }
+    else
+    {
+        ret = vsnprintf(0, 0, format, va);
+    }
+    va_end(va);
+
+    return ret;
+}
+
+void cyclic250ms_StackMonitoring()
+{
+}
+
+int32_t getFreeBytes()
+{
+    return STACK_CHECK_FAILED;
+}
+
+uint8_t getStackValidity()
+{
+    return 1;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * @file HostStubs.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Header file for the HAL module stubs of the host builds
+ *
+ * @details The stubs replace the HAL modules (ADC, buttons, LEDs, display,
+ * log output) below the services, so that the services and the application
+ * can run on the host. The inputs are set by the host program.
+ *
+ *
+ *****************************************************************************/
+#ifndef _HOST_STUBS_H_
+#define _HOST_STUBS_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ADCModule.h"
+#include "ButtonModule.h"
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+
+
+/***** TYPES *****************************************************************/
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Sets the voltage returned by adcReadChannel() for a channel
+ *
+ * @param channel ADC channel
+ * @param microvolt Voltage in microvolt
+ */
+void hostSetADCVoltage(ADC_Channel_t channel, int32_t microvolt);
+
+/**
+ * @brief Completes a block of conversion sequences with the set voltages,
+ * updates the decimated channel values of the active profile and calls
+ * the registered ADC conversion callback, like the DMA interrupt
+ */
+void hostTriggerADCConversion(void);
+
+/**
+ * @brief Sets the status returned by buttonGetButtonStatus()
+ *
+ * @param button Button
+ * @param status Button status
+ */
+void hostSetButton(Button_t button, Button_Status_t status);
+
+/**
+ * @brief Enables printing the log output to stdout
+ *
+ * @param echo true to print the log output
+ */
+void hostSetLogEcho(bool echo);
+
+/**
+ * @brief Returns the number of log outputs since the start
+ *
+ * @return Number of calls of outputLog() and outputLogf()
+ */
+uint32_t hostGetLogCount(void);
+
+#endif
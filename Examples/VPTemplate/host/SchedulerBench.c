@@ -0,0 +1,165 @@
+/******************************************************************************
+ * @file SchedulerBench.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Host benchmark for the dispatch cost of the scheduler
+ *
+ * @details Compares the release queue based schedCycle() against the former
+ * linear scan over all tasks for 6, 32 and 128 tasks. The scheduler runs
+ * against a virtual tick counter, every tick schedCycle() is called several
+ * times to model the super loop polling between two releases.
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "Scheduler.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+static const uint32_t BENCH_TASK_COUNTS[] = {6, 32, 128};        //!< Number of tasks per benchmark run
+static const uint32_t BENCH_PERIODS[] = {1, 2, 5, 10, 20, 25, 50, 100, 250, 500, 1000};   //!< Periods used for the tasks
+
+static const uint32_t BENCH_TICKS = 100000;                     //!< Simulated ticks per benchmark run
+static const uint32_t BENCH_CALLS_PER_TICK = 20;                //!< Super loop iterations per tick
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define ARRAY_SIZE(x)       (sizeof(x) / sizeof((x)[0]))
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+/**
+ * @brief Function pointer for the cycle function under test
+ */
+typedef int32_t (*CycleFunction)(Scheduler* pScheduler);
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static uint32_t getVirtualTick(void);
+static void benchTask(void);
+static int32_t linearScanCycle(Scheduler* pScheduler);
+static double runBenchmark(uint32_t taskCount, CycleFunction cycleFunction, uint32_t* pReleases);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static uint32_t s_virtualTick = 0;              //!< Virtual HAL tick
+static volatile uint32_t s_releaseCount = 0;    //!< Number of task executions
+static Scheduler s_scheduler;                   //!< Scheduler instance under test
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int main(void)
+{
+    printf("Scheduler dispatch benchmark (%u ticks, %u calls per tick)\n", BENCH_TICKS, BENCH_CALLS_PER_TICK);
+    printf("%8s %18s %18s %10s\n", "tasks", "linear [ns/call]", "queue [ns/call]", "speedup");
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(BENCH_TASK_COUNTS); i++)
+    {
+        uint32_t linearReleases = 0;
+        uint32_t queueReleases = 0;
+
+        double linearTime = runBenchmark(BENCH_TASK_COUNTS[i], linearScanCycle, &linearReleases);
+        double queueTime = runBenchmark(BENCH_TASK_COUNTS[i], schedCycle, &queueReleases);
+
+        printf("%8u %18.1f %18.1f %9.2fx\n", BENCH_TASK_COUNTS[i], linearTime, queueTime, linearTime / queueTime);
+
+        if (linearReleases != queueReleases)
+        {
+            printf("ERROR: release count differs (linear %u, queue %u)\n", linearReleases, queueReleases);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+static uint32_t getVirtualTick(void)
+{
+    return s_virtualTick;
+}
+
+static void benchTask(void)
+{
+    s_releaseCount++;
+}
+
+/**
+ * @brief Former implementation of schedCycle() which polls every task
+ */
+static int32_t linearScanCycle(Scheduler* pScheduler)
+{
+    for (uint32_t i = 0; i < pScheduler->registeredTaskCount; i++)
+    {
+        uint32_t nowTickTime = pScheduler->pGetHALTick();
+        if (nowTickTime - pScheduler->tasks[i].lastExecution >= pScheduler->tasks[i].period)
+        {
+            pScheduler->tasks[i].lastExecution += pScheduler->tasks[i].period;
+            if (pScheduler->tasks[i].pTask != 0)
+            {
+                pScheduler->tasks[i].pTask();
+            }
+        }
+    }
+
+    return SCHED_ERR_OK;
+}
+
+/**
+ * @brief Runs one benchmark configuration
+ *
+ * @param taskCount Number of tasks to register
+ * @param cycleFunction Cycle function under test
+ * @param pReleases Receives the number of task releases
+ *
+ * @return Average time per call of the cycle function in nanoseconds
+ */
+static double runBenchmark(uint32_t taskCount, CycleFunction cycleFunction, uint32_t* pReleases)
+{
+    memset(&s_scheduler, 0, sizeof(s_scheduler));
+    s_virtualTick = 0;
+    s_releaseCount = 0;
+
+    registerHALTickFunction(&s_scheduler, getVirtualTick);
+    for (uint32_t i = 0; i < taskCount; i++)
+    {
+        registerTask(&s_scheduler, BENCH_PERIODS[i % ARRAY_SIZE(BENCH_PERIODS)], benchTask);
+    }
+    schedInitialize(&s_scheduler);
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (uint32_t tick = 1; tick <= BENCH_TICKS; tick++)
+    {
+        s_virtualTick = tick;
+        for (uint32_t call = 0; call < BENCH_CALLS_PER_TICK; call++)
+        {
+            cycleFunction(&s_scheduler);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    *pReleases = s_releaseCount;
+
+    double elapsedNs = (double) (end.tv_sec - start.tv_sec) * 1e9 + (double) (end.tv_nsec - start.tv_nsec);
+    return elapsedNs / ((double) BENCH_TICKS * BENCH_CALLS_PER_TICK);
+}
@@ -0,0 +1,477 @@
+/******************************************************************************
+ * @file SchedulerSim.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Host simulator for the scheduler with virtual time
+ *
+ * @details The scheduler, the state table, the services and the application
+ * run against a virtual microsecond clock. Every task execution advances
+ * the clock by a simulated execution time (base, jitter and rare long
+ * stalls drawn from a seeded random generator), the idle function jumps to
+ * the next release or ADC interrupt. Hours of scheduled time are therefore
+ * replayed in well below a second and the results are deterministic for a
+ * given seed.
+ *
+ * Reported per task: releases, missed releases, deadline misses (the end of
+ * the execution lies behind the next release), the start jitter
+ * distribution and the worst case response time. Additionally the deferred
+ * work latency and the dispatch overhead of schedCycle() (host time without
+ * the task bodies) are reported.
+ *
+ * Usage: SchedulerSim [hours] [seed]
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Scheduler.h"
+#include "HostStubs.h"
+#include "Application.h"
+#include "AppTasks.h"
+#include "ADCService.h"
+#include "ButtonService.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+static const double SIM_DEFAULT_HOURS = 1.0;                //!< Simulated time if not given on the command line
+static const uint32_t SIM_DEFAULT_SEED = 12345;             //!< Seed if not given on the command line
+
+static const uint64_t SIM_US_PER_TICK = 1000;               //!< One HAL tick is one millisecond
+static const uint64_t SIM_ISR_COST_US = 3;                  //!< Execution time of the ADC DMA interrupt
+static const uint64_t SIM_ADC_WORK_COST_US = 30;            //!< Execution time of the ADC deferred work
+static const uint64_t SIM_CYCLE_COST_US = 2;                //!< Execution time of one schedCycle() without any release
+
+static const uint64_t SIM_POT_SWEEP_US = 60000000;          //!< Period of the potentiometer sweep
+static const uint64_t SIM_BUTTON_PERIOD_US = 30000000;      //!< Period of the simulated button presses
+static const uint64_t SIM_BUTTON_PRESS_US = 200000;         //!< Duration of a button press
+
+static const int32_t SIM_TEMPERATURE_SENSOR_UV = 760000;    //!< Voltage of the temperature sensor (25 °C)
+static const int32_t SIM_VBAT_UV = 3000000;                 //!< Backup battery voltage, measured through the VBAT/3 bridge
+static const int32_t SIM_VREFINT_UV = 1212000;              //!< Voltage of the internal reference
+
+static const uint32_t SIM_JITTER_LIMITS_US[] = {100, 500, 1000, 2000, 5000, 10000};    //!< Upper limits of the jitter histogram bins
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define ARRAY_SIZE(x)           (sizeof(x) / sizeof((x)[0]))
+#define SIM_TASK_COUNT          3       //!< Number of simulated tasks
+#define SIM_JITTER_BINS         7       //!< Number of jitter histogram bins (last bin is open)
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+/**
+ * @brief Simulated task: application task and its execution time model
+ */
+typedef struct _SimTask
+{
+    const char* pName;                  //!< Name for the report
+    uint32_t period;                    //!< Period in ticks
+    CyclicFunction pFunction;           //!< Application task function
+    CyclicFunction pSimFunction;        //!< Function registered at the scheduler (calls simRunTask())
+    SchedOverrunPolicy overrunPolicy;   //!< Overrun policy used in the tuned scenario
+    uint32_t costUs;                    //!< Mean execution time
+    uint32_t costJitterUs;              //!< Maximum deviation from the mean execution time
+    uint32_t stallPermille;             //!< Probability of a long stall
+    uint32_t stallCostUs;               //!< Execution time of a stall
+
+    uint32_t schedulerIndex;            //!< Index of the task in the scheduler
+    uint32_t runCount;                  //!< Number of executions
+    uint32_t deadlineMisses;            //!< Executions which ended after the next release
+    uint64_t totalJitterUs;             //!< Sum of the start jitter
+    uint32_t maxJitterUs;               //!< Maximum start jitter
+    uint32_t maxResponseUs;             //!< Maximum time from release to end of execution
+    uint32_t jitterHistogram[SIM_JITTER_BINS];  //!< Start jitter distribution
+} SimTask;
+
+/**
+ * @brief Simulation scenario
+ */
+typedef struct _SimScenario
+{
+    const char* pName;                  //!< Name for the report
+    bool tuned;                         //!< Use the phases and overrun policies of main.c
+} SimScenario;
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static uint32_t simRandom(void);
+static uint32_t simGetTick(void);
+static uint32_t simGetTimestamp(void);
+static void simIdle(uint32_t ticks);
+static void simHandleInterrupts(void);
+static uint64_t simADCPeriodUs(void);
+static void simUpdateInputs(void);
+static void simOnADCConversion(void);
+static void simADCWork(uint32_t argument);
+static void simRunTask(SimTask* pSimTask);
+static void simTask10ms(void);
+static void simTask50ms(void);
+static void simTask250ms(void);
+static uint64_t hostNanoseconds(void);
+static void runScenario(const SimScenario* pScenario, double hours, uint32_t seed);
+static void printReport(const SimScenario* pScenario, double hours, double hostSeconds);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static const SimScenario SIM_SCENARIOS[] = {
+    { "cooperative, all tasks in phase, catch-up", false },
+    { "cooperative, auto phase, main.c overrun policies", true },
+};
+
+static SimTask s_tasks[SIM_TASK_COUNT] = {
+    { "10ms",  10,  taskApp10ms,  simTask10ms,  SCHED_OVERRUN_SKIP_TO_NOW, 150, 50,  0,  0     },
+    { "50ms",  50,  taskApp50ms,  simTask50ms,  SCHED_OVERRUN_CATCH_UP,    400, 200, 0,  0     },
+    { "250ms", 250, taskApp250ms, simTask250ms, SCHED_OVERRUN_SKIP_TO_NOW, 800, 200, 10, 25000 },
+};
+
+static Scheduler s_scheduler;                   //!< Scheduler under test
+static DeferredWorkQueue s_adcWorkQueue;        //!< Deferred work of the ADC interrupt
+static uint64_t s_nowUs = 0;                    //!< Virtual time
+static uint64_t s_nextADCUs = 0;                //!< Time of the next ADC conversion interrupt
+static uint64_t s_idleUs = 0;                   //!< Virtual time spent in idle
+static uint32_t s_randomState = 1;              //!< State of the random generator
+static uint64_t s_cycleCount = 0;               //!< Number of schedCycle() calls
+static uint64_t s_bodyHostNs = 0;               //!< Host time spent in task and work bodies
+static uint64_t s_cycleHostNs = 0;              //!< Host time spent in schedCycle()
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int main(int argc, char** argv)
+{
+    double hours = (argc > 1) ? atof(argv[1]) : SIM_DEFAULT_HOURS;
+    uint32_t seed = (argc > 2) ? (uint32_t) strtoul(argv[2], 0, 0) : SIM_DEFAULT_SEED;
+
+    if (hours <= 0.0 || seed == 0)
+    {
+        printf("Usage: %s [hours > 0] [seed != 0]\n", argv[0]);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(SIM_SCENARIOS); i++)
+    {
+        runScenario(&SIM_SCENARIOS[i], hours, seed);
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief HAL tick of the firmware, e.g. the time source of the state timers
+ */
+uint32_t HAL_GetTick(void)
+{
+    return simGetTick();
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief xorshift32 random generator, deterministic for a given seed
+ */
+static uint32_t simRandom(void)
+{
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 17;
+    s_randomState ^= s_randomState << 5;
+
+    return s_randomState;
+}
+
+static uint32_t simGetTick(void)
+{
+    return (uint32_t) (s_nowUs / SIM_US_PER_TICK);
+}
+
+static uint32_t simGetTimestamp(void)
+{
+    return (uint32_t) s_nowUs;
+}
+
+/**
+ * @brief Idle function: sleeps until the next release or ADC interrupt
+ */
+static void simIdle(uint32_t ticks)
+{
+    uint64_t wakeUs = ((uint64_t) simGetTick() + ticks) * SIM_US_PER_TICK;
+
+    if (s_nextADCUs < wakeUs)
+    {
+        wakeUs = s_nextADCUs;
+    }
+    if (wakeUs > s_nowUs)
+    {
+        s_idleUs += wakeUs - s_nowUs;
+        s_nowUs = wakeUs;
+    }
+}
+
+/**
+ * @brief Executes the interrupts which became due, interrupts are only
+ * taken between two steps of the super loop
+ */
+static void simHandleInterrupts(void)
+{
+    while (s_nowUs >= s_nextADCUs)
+    {
+        s_nextADCUs += simADCPeriodUs();
+        simUpdateInputs();
+        hostTriggerADCConversion();
+        s_nowUs += SIM_ISR_COST_US;
+    }
+}
+
+/**
+ * @brief Returns the period of the ADC blocks, the trigger frequency is
+ * set by the profile the application selected
+ */
+static uint64_t simADCPeriodUs(void)
+{
+    return (1000000ULL * ADC_BLOCK_SEQUENCES) / adcGetProfile()->triggerFrequency;
+}
+
+/**
+ * @brief Updates the simulated sensor voltages and buttons
+ */
+static void simUpdateInputs(void)
+{
+    // Triangle sweep of the potentiometers between 0.5 V and 2.5 V
+    uint64_t position = s_nowUs % SIM_POT_SWEEP_US;
+    uint64_t half = SIM_POT_SWEEP_US / 2;
+    uint64_t ramp = (position < half) ? position : SIM_POT_SWEEP_US - position;
+    int32_t microvolt = 500000 + (int32_t) ((ramp * 2000000) / half);
+
+    hostSetADCVoltage(ADC_INPUT0, microvolt);
+    hostSetADCVoltage(ADC_INPUT1, 3000000 - microvolt);
+
+    // SW1 toggles the system on/off, B1 switches to maintenance in between
+    uint64_t buttonPosition = s_nowUs % SIM_BUTTON_PERIOD_US;
+    hostSetButton(BTN_SW1, (buttonPosition < SIM_BUTTON_PRESS_US) ? BUTTON_PRESSED : BUTTON_RELEASED);
+    hostSetButton(BTN_B1, (buttonPosition >= SIM_BUTTON_PERIOD_US / 2 && buttonPosition < SIM_BUTTON_PERIOD_US / 2 + SIM_BUTTON_PRESS_US)
+        ? BUTTON_PRESSED : BUTTON_RELEASED);
+}
+
+static void simOnADCConversion(void)
+{
+    deferredWorkPost(&s_adcWorkQueue, simADCWork, 0);
+}
+
+static void simADCWork(uint32_t argument)
+{
+    uint64_t startNs = hostNanoseconds();
+    workADCSequence(argument);
+    s_bodyHostNs += hostNanoseconds() - startNs;
+
+    s_nowUs += SIM_ADC_WORK_COST_US;
+}
+
+/**
+ * @brief Executes the application task and advances the virtual time by
+ * the simulated execution time
+ */
+static void simRunTask(SimTask* pSimTask)
+{
+    const SchedulerTask* pTask = &s_scheduler.tasks[pSimTask->schedulerIndex];
+
+    // lastExecution holds the ideal release of this execution
+    uint64_t releaseUs = (uint64_t) pTask->lastExecution * SIM_US_PER_TICK;
+    uint32_t jitterUs = (uint32_t) (s_nowUs - releaseUs);
+
+    uint64_t startNs = hostNanoseconds();
+    pSimTask->pFunction();
+    s_bodyHostNs += hostNanoseconds() - startNs;
+
+    uint32_t costUs = pSimTask->costUs - pSimTask->costJitterUs + simRandom() % (2 * pSimTask->costJitterUs + 1);
+    if (pSimTask->stallPermille > 0 && simRandom() % 1000 < pSimTask->stallPermille)
+    {
+        costUs = pSimTask->stallCostUs;
+    }
+    s_nowUs += costUs;
+
+    uint32_t responseUs = (uint32_t) (s_nowUs - releaseUs);
+    if (responseUs > pSimTask->period * SIM_US_PER_TICK)
+    {
+        pSimTask->deadlineMisses++;
+    }
+    if (responseUs > pSimTask->maxResponseUs)
+    {
+        pSimTask->maxResponseUs = responseUs;
+    }
+
+    uint32_t bin = 0;
+    while (bin < ARRAY_SIZE(SIM_JITTER_LIMITS_US) && jitterUs >= SIM_JITTER_LIMITS_US[bin])
+    {
+        bin++;
+    }
+    pSimTask->jitterHistogram[bin]++;
+    pSimTask->totalJitterUs += jitterUs;
+    if (jitterUs > pSimTask->maxJitterUs)
+    {
+        pSimTask->maxJitterUs = jitterUs;
+    }
+    pSimTask->runCount++;
+}
+
+static void simTask10ms(void)
+{
+    simRunTask(&s_tasks[0]);
+}
+
+static void simTask50ms(void)
+{
+    simRunTask(&s_tasks[1]);
+}
+
+static void simTask250ms(void)
+{
+    simRunTask(&s_tasks[2]);
+}
+
+static uint64_t hostNanoseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * @brief Runs one scenario from reset for the given simulated time
+ */
+static void runScenario(const SimScenario* pScenario, double hours, uint32_t seed)
+{
+    uint64_t endUs = (uint64_t) (hours * 3600.0 * 1e6);
+
+    memset(&s_scheduler, 0, sizeof(s_scheduler));
+    s_nowUs = 0;
+    adcInitialize();
+    s_nextADCUs = simADCPeriodUs();
+    s_idleUs = 0;
+    s_randomState = seed;
+    s_cycleCount = 0;
+    s_bodyHostNs = 0;
+    s_cycleHostNs = 0;
+
+    hostSetADCVoltage(ADC_TEMP, SIM_TEMPERATURE_SENSOR_UV);
+    hostSetADCVoltage(ADC_VBAT, SIM_VBAT_UV / 3);
+    hostSetADCVoltage(ADC_VREF, SIM_VREFINT_UV);
+    simUpdateInputs();
+    appInitialize();
+    adcRegisterConversionCallback(simOnADCConversion);
+
+    registerHALTickFunction(&s_scheduler, simGetTick);
+    registerIdleFunction(&s_scheduler, simIdle);
+    deferredWorkInitQueue(&s_adcWorkQueue, 0, simGetTimestamp);
+    registerDeferredWorkQueue(&s_scheduler, &s_adcWorkQueue);
+
+    for (uint32_t i = 0; i < SIM_TASK_COUNT; i++)
+    {
+        SimTask* pSimTask = &s_tasks[i];
+        SchedulerTaskConfig config = {
+            .period = pSimTask->period,
+            .pTask = pSimTask->pSimFunction,
+            .overrunPolicy = pScenario->tuned ? pSimTask->overrunPolicy : SCHED_OVERRUN_CATCH_UP,
+            .phase = pScenario->tuned ? SCHED_PHASE_AUTO : 0,
+            .budgetMicroseconds = pSimTask->costUs,
+        };
+
+        pSimTask->schedulerIndex = s_scheduler.registeredTaskCount;
+        pSimTask->runCount = 0;
+        pSimTask->deadlineMisses = 0;
+        pSimTask->totalJitterUs = 0;
+        pSimTask->maxJitterUs = 0;
+        pSimTask->maxResponseUs = 0;
+        memset(pSimTask->jitterHistogram, 0, sizeof(pSimTask->jitterHistogram));
+
+        registerTaskConfig(&s_scheduler, &config);
+    }
+    schedInitialize(&s_scheduler);
+
+    uint64_t startNs = hostNanoseconds();
+
+    while (s_nowUs < endUs)
+    {
+        simHandleInterrupts();
+
+        uint64_t cycleStartNs = hostNanoseconds();
+        schedCycle(&s_scheduler);
+        s_cycleHostNs += hostNanoseconds() - cycleStartNs;
+        s_cycleCount++;
+
+        s_nowUs += SIM_CYCLE_COST_US;
+    }
+
+    double hostSeconds = (double) (hostNanoseconds() - startNs) / 1e9;
+    printReport(pScenario, hours, hostSeconds);
+}
+
+static void printReport(const SimScenario* pScenario, double hours, double hostSeconds)
+{
+    DeferredWorkStatistics workStatistics;
+    deferredWorkGetStatistics(&s_adcWorkQueue, &workStatistics);
+
+    printf("Scenario: %s\n", pScenario->pName);
+    printf("  simulated %.2f h in %.3f s, idle %.1f %%, %llu schedCycle() calls, dispatch overhead %.1f ns/call\n",
+        hours, hostSeconds, 100.0 * (double) s_idleUs / (double) s_nowUs, (unsigned long long) s_cycleCount,
+        (double) (s_cycleHostNs - s_bodyHostNs) / (double) s_cycleCount);
+    printf("  ADC deferred work: %u posted, %u dropped, depth max %u, latency mean %u us, max %u us\n",
+        workStatistics.postCount, workStatistics.droppedCount, workStatistics.maxDepth,
+        workStatistics.meanLatency, workStatistics.maxLatency);
+    printf("  ADC profile at the end: %s, temperature sensor %d uV, VBAT %d uV, VREFINT %d uV\n",
+        adcGetProfile()->pName, getTemperatureSensorVoltage(), getVbatVoltage(), getVrefintVoltage());
+
+    printf("  %-6s %10s %8s %8s %10s %10s %12s\n", "task", "runs", "missed", "deadline", "jitter avg", "jitter max", "response max");
+    for (uint32_t i = 0; i < SIM_TASK_COUNT; i++)
+    {
+        const SimTask* pSimTask = &s_tasks[i];
+        uint32_t missedReleases = 0;
+        schedGetMissedReleases(&s_scheduler, pSimTask->schedulerIndex, &missedReleases);
+
+        printf("  %-6s %10u %8u %8u %8.0fus %8uus %10uus\n", pSimTask->pName, pSimTask->runCount, missedReleases,
+            pSimTask->deadlineMisses, pSimTask->runCount ? (double) pSimTask->totalJitterUs / pSimTask->runCount : 0.0,
+            pSimTask->maxJitterUs, pSimTask->maxResponseUs);
+    }
+
+    printf("  start jitter distribution [%% of runs]\n  %-6s", "task");
+    for (uint32_t bin = 0; bin < SIM_JITTER_BINS; bin++)
+    {
+        char label[16];
+        if (bin < ARRAY_SIZE(SIM_JITTER_LIMITS_US))
+        {
+            snprintf(label, sizeof(label), "<%uus", SIM_JITTER_LIMITS_US[bin]);
+        }
+        else
+        {
+            snprintf(label, sizeof(label), ">=%uus", SIM_JITTER_LIMITS_US[bin - 1]);
+        }
+        printf(" %9s", label);
+    }
+    printf("\n");
+
+    for (uint32_t i = 0; i < SIM_TASK_COUNT; i++)
+    {
+        const SimTask* pSimTask = &s_tasks[i];
+        printf("  %-6s", pSimTask->pName);
+        for (uint32_t bin = 0; bin < SIM_JITTER_BINS; bin++)
+        {
+            printf(" %9.3f", pSimTask->runCount ? 100.0 * pSimTask->jitterHistogram[bin] / pSimTask->runCount : 0.0);
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
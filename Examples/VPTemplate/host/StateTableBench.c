@@ -0,0 +1,243 @@
+/******************************************************************************
+ * @file StateTableBench.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Host benchmark for the event dispatch cost of the state table
+ *
+ * @details A state machine with 64 states and 32 events (every state handles
+ * 8 of the events, 512 transitions) is fed with a seeded random event
+ * sequence. The dispatch matrix of stateTableRunCyclic() is compared against
+ * the former linear scan over all transitions. Both variants have to end up
+ * with the same number of transitions and the same final state.
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "StateTable/StateTable.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+static const uint32_t BENCH_SEED = 12345;               //!< Seed of the event sequence
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define BENCH_STATES                64      //!< Number of states
+#define BENCH_EVENTS                32      //!< Number of events (IDs 1..32)
+#define BENCH_EVENT_IDS             (BENCH_EVENTS + 1)  //!< Columns of the dispatch matrix including STT_NONE_EVENT
+#define BENCH_EVENTS_PER_STATE      8       //!< Number of handled events per state
+#define BENCH_EVENT_COUNT           1000000 //!< Number of dispatched events per run
+#define BENCH_ENTRIES               (BENCH_STATES * BENCH_EVENTS_PER_STATE)
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+/**
+ * @brief Function pointer for the dispatch function under test
+ */
+typedef int32_t (*RunFunction)(StateTable_t* pStateTable, int32_t event);
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static void buildStateMachine(void);
+static int32_t matrixRunCyclic(StateTable_t* pStateTable, int32_t event);
+static int32_t linearScanRunCyclic(StateTable_t* pStateTable, int32_t event);
+static double runBenchmark(RunFunction runFunction, uint32_t* pTransitions, int32_t* pFinalState);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static State_t s_states[BENCH_STATES];                  //!< States of the benchmark machine
+static StateTableEntry_t s_entries[BENCH_ENTRIES];      //!< Transitions of the benchmark machine
+static const StateTableEntry_t* s_dispatch[BENCH_STATES][BENCH_EVENT_IDS];  //!< Dispatch matrix of the benchmark machine
+static StateTableDefinition_t s_definition;             //!< Definition of the benchmark machine
+static StateTable_t s_stateTable;                       //!< State table instance under test
+static int32_t s_events[BENCH_EVENT_COUNT];             //!< Random event sequence
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int main(void)
+{
+    buildStateMachine();
+
+    uint32_t scanTransitions = 0;
+    uint32_t matrixTransitions = 0;
+    int32_t scanFinalState = 0;
+    int32_t matrixFinalState = 0;
+
+    double scanTime = runBenchmark(linearScanRunCyclic, &scanTransitions, &scanFinalState);
+    double matrixTime = runBenchmark(matrixRunCyclic, &matrixTransitions, &matrixFinalState);
+
+    printf("State table dispatch benchmark (%u states, %u events, %u transitions, %u events dispatched)\n",
+           BENCH_STATES, BENCH_EVENTS, BENCH_ENTRIES, BENCH_EVENT_COUNT);
+    printf("%18s %18s %10s\n", "scan [ns/event]", "matrix [ns/event]", "speedup");
+    printf("%18.1f %18.1f %9.2fx\n", scanTime, matrixTime, scanTime / matrixTime);
+
+    if (scanTransitions != matrixTransitions || scanFinalState != matrixFinalState)
+    {
+        printf("ERROR: results differ (scan %u transitions to state %d, matrix %u transitions to state %d)\n",
+               scanTransitions, scanFinalState, matrixTransitions, matrixFinalState);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief The state table logs the transitions, the benchmark drops the output
+ */
+void outputLog(const char* msg)
+{
+    (void) msg;
+}
+
+int outputLogf(const char* format, ...)
+{
+    (void) format;
+    return 0;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief Builds the states, the transitions (sorted by the from state like a
+ * hand written table), the dispatch matrix and the random event sequence
+ */
+static void buildStateMachine(void)
+{
+    for (int32_t i = 0; i < BENCH_STATES; i++)
+    {
+        s_states[i].parentIndex = STT_NO_PARENT;
+    }
+
+    for (int32_t i = 0; i < BENCH_STATES; i++)
+    {
+        for (int32_t j = 0; j < BENCH_EVENTS_PER_STATE; j++)
+        {
+            StateTableEntry_t* pEntry = &s_entries[i * BENCH_EVENTS_PER_STATE + j];
+            pEntry->stateIndexFrom = (uint8_t) i;
+            pEntry->stateIndexTo = (uint8_t) ((i * 13 + j * 7 + 1) % BENCH_STATES);
+            pEntry->eventID = (uint8_t) (1 + (i * 5 + j * 4) % BENCH_EVENTS);
+            s_dispatch[i][pEntry->eventID] = pEntry;
+        }
+    }
+
+    s_definition.pStates = s_states;
+    s_definition.stateCount = BENCH_STATES;
+    s_definition.eventCount = BENCH_EVENT_IDS;
+    s_definition.initialState = 0;
+    s_definition.pDispatch = &s_dispatch[0][0];
+
+    uint32_t random = BENCH_SEED;
+    for (uint32_t i = 0; i < BENCH_EVENT_COUNT; i++)
+    {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        s_events[i] = 1 + (int32_t) (random % BENCH_EVENTS);
+    }
+}
+
+/**
+ * @brief Sends the event and dispatches it with stateTableRunCyclic()
+ */
+static int32_t matrixRunCyclic(StateTable_t* pStateTable, int32_t event)
+{
+    stateTableSendEvent(pStateTable, event);
+    return stateTableRunCyclic(pStateTable);
+}
+
+/**
+ * @brief Former implementation of the event dispatch in stateTableRunCyclic()
+ * which scans all transitions
+ */
+static int32_t linearScanRunCyclic(StateTable_t* pStateTable, int32_t currentEvent)
+{
+    int32_t result = STATETBL_ERR_EVENT_UNHANDLED;
+
+    for (int32_t i = 0; i < BENCH_ENTRIES; i++)
+    {
+        const StateTableEntry_t* pEntry = &s_entries[i];
+        if (pEntry->stateIndexFrom == pStateTable->currentState && pEntry->eventID == currentEvent)
+        {
+            bool transitionAllowed = true;
+            if (pEntry->pGuard != 0)
+            {
+                transitionAllowed = pEntry->pGuard(pStateTable, pEntry, currentEvent);
+            }
+
+            if (transitionAllowed == true)
+            {
+                const State_t* pFromState = &(s_states[pEntry->stateIndexFrom]);
+                if (pFromState->pOnExit != 0)
+                {
+                    pFromState->pOnExit(pStateTable, currentEvent);
+                }
+
+                outputLogf("State Transition from %d to %d with event %d\n\r", pStateTable->currentState, pEntry->stateIndexTo, currentEvent);
+
+                pStateTable->previousState      = pStateTable->currentState;
+                pStateTable->currentState       = pEntry->stateIndexTo;
+                pStateTable->lastHandledEvent   = (uint8_t) currentEvent;
+
+                result = STATETBL_ERR_OK;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Dispatches the event sequence with one run function
+ *
+ * @param runFunction Dispatch function under test
+ * @param pTransitions Receives the number of performed transitions
+ * @param pFinalState Receives the index of the final state
+ *
+ * @return Average time per dispatched event in nanoseconds
+ */
+static double runBenchmark(RunFunction runFunction, uint32_t* pTransitions, int32_t* pFinalState)
+{
+    if (stateTableValidate(&s_definition) != STATETBL_ERR_OK ||
+        stateTableInitialize(&s_stateTable, &s_definition, 0) != STATETBL_ERR_OK)
+    {
+        printf("ERROR: state table initialization failed\n");
+        return 0.0;
+    }
+
+    uint32_t transitions = 0;
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (uint32_t i = 0; i < BENCH_EVENT_COUNT; i++)
+    {
+        if (runFunction(&s_stateTable, s_events[i]) == STATETBL_ERR_OK)
+        {
+            transitions++;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    *pTransitions = transitions;
+    *pFinalState = s_stateTable.currentState;
+
+    double elapsedNs = (double) (end.tv_sec - start.tv_sec) * 1e9 + (double) (end.tv_nsec - start.tv_nsec);
+    return elapsedNs / (double) BENCH_EVENT_COUNT;
+}
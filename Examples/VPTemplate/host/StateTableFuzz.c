@@ -0,0 +1,491 @@
+/******************************************************************************
+ * @file StateTableFuzz.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Host fuzzer and throughput benchmark for the state table
+ *
+ * @details For every seed a random hierarchical state machine is generated
+ * (up to STATETBL_MAX_DEPTH levels, chained transitions with random guards,
+ * state timeouts) and driven with a random sequence of events, run cycles
+ * and time steps, alternately with and without the run to completion mode.
+ * The entry, state and exit functions check the invariants:
+ *  - the current state is always a valid state index
+ *  - a state is entered exactly once per visit and only below an entered
+ *    parent, it is exited only once and after all of its children
+ *  - the entered states are always the top part of the path to the current
+ *    state, the state function only runs for a completely entered state
+ *  - without the run to completion mode, a state reached by a transition is
+ *    entered in the next cycle, even if further events are already queued
+ * Built with the sanitizers (make host-fuzz), invalid memory accesses are
+ * reported as well.
+ *
+ * Afterwards the dispatch throughput (events per second, stateTableSendEvent()
+ * and stateTableRunCyclic()) is measured for a generated machine.
+ *
+ * Usage: StateTableFuzz [seeds] [steps per seed]
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "StateTable/StateTable.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+static const uint32_t FUZZ_DEFAULT_SEEDS = 200;             //!< Number of generated state machines
+static const uint32_t FUZZ_DEFAULT_STEPS = 5000;            //!< Random actions per state machine
+static const uint32_t BENCH_EVENT_COUNT = 2000000;          //!< Events of the throughput benchmark
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define FUZZ_STATES             50      //!< Number of states (see FUZZ_STATE_FUNCTIONS)
+#define FUZZ_EVENTS             12      //!< Number of event IDs including STT_NONE_EVENT
+#define FUZZ_MAX_TRANSITIONS    (FUZZ_STATES * 4)   //!< Maximum number of transitions
+#define FUZZ_NO_STATE           0xFF    //!< No state awaits its entry function
+
+/**
+ * @brief The callbacks don't get the index of their state, so every state has
+ * its own entry, state and exit function (states 10..59 map to index 0..49)
+ */
+#define FUZZ_STATE_FUNCTIONS(n) \
+    static int32_t onEntry##n(StateTable_t* pStateTable, int32_t eventID) { return fuzzOnEntry(pStateTable, (n) - 10); } \
+    static int32_t onState##n(StateTable_t* pStateTable, int32_t eventID) { return fuzzOnState(pStateTable, (n) - 10); } \
+    static int32_t onExit##n(StateTable_t* pStateTable, int32_t eventID) { return fuzzOnExit(pStateTable, (n) - 10); }
+
+#define FUZZ_FOR_TEN(macro, d) \
+    macro(d##0) macro(d##1) macro(d##2) macro(d##3) macro(d##4) \
+    macro(d##5) macro(d##6) macro(d##7) macro(d##8) macro(d##9)
+
+#define FUZZ_FOR_ALL(macro) \
+    FUZZ_FOR_TEN(macro, 1) FUZZ_FOR_TEN(macro, 2) FUZZ_FOR_TEN(macro, 3) \
+    FUZZ_FOR_TEN(macro, 4) FUZZ_FOR_TEN(macro, 5)
+
+#define FUZZ_ENTRY_POINTER(n)   onEntry##n,
+#define FUZZ_STATE_POINTER(n)   onState##n,
+#define FUZZ_EXIT_POINTER(n)    onExit##n,
+
+/**
+ * @brief Reports a violated invariant and stops the fuzzer
+ */
+#define FUZZ_CHECK(condition, message) \
+    do { if (!(condition)) { fuzzFail(message); } } while (0)
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static uint32_t fuzzRandom(void);
+static uint32_t fuzzGetTick(void);
+static void fuzzFail(const char* message);
+static bool fuzzIsAncestor(uint8_t ancestor, uint8_t state);
+static int32_t fuzzOnEntry(StateTable_t* pStateTable, int32_t stateIndex);
+static int32_t fuzzOnState(StateTable_t* pStateTable, int32_t stateIndex);
+static int32_t fuzzOnExit(StateTable_t* pStateTable, int32_t stateIndex);
+static bool fuzzGuard(StateTable_t* pStateTable, const StateTableEntry_t* pEntry, int32_t eventID);
+static void buildStateMachine(uint32_t seed);
+static void checkInstance(bool quiescent);
+static void runCycle(bool runToCompletion);
+static void fuzzStateMachine(uint32_t seed, uint32_t steps);
+static double benchmarkThroughput(bool runToCompletion);
+
+FUZZ_FOR_ALL(FUZZ_STATE_FUNCTIONS)
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static const StateFunction s_onEntry[FUZZ_STATES] = { FUZZ_FOR_ALL(FUZZ_ENTRY_POINTER) };  //!< Entry functions per state
+static const StateFunction s_onState[FUZZ_STATES] = { FUZZ_FOR_ALL(FUZZ_STATE_POINTER) };  //!< State functions per state
+static const StateFunction s_onExit[FUZZ_STATES] = { FUZZ_FOR_ALL(FUZZ_EXIT_POINTER) };    //!< Exit functions per state
+
+static State_t s_states[FUZZ_STATES];                   //!< States of the generated machine
+static StateTableEntry_t s_entries[FUZZ_MAX_TRANSITIONS];   //!< Transitions of the generated machine
+static const StateTableEntry_t* s_dispatch[FUZZ_STATES][FUZZ_EVENTS];  //!< Dispatch matrix of the generated machine
+static StateTableDefinition_t s_definition;             //!< Definition of the generated machine
+static StateTable_t s_stateTable;                       //!< Instance under test
+static StateTimerWheel_t s_timerWheel;                  //!< Timer wheel of the instance
+
+static bool s_entered[FUZZ_STATES];                     //!< Model: state is entered
+static uint32_t s_entryCount = 0;                       //!< Number of entry calls
+static uint32_t s_exitCount = 0;                        //!< Number of exit calls
+static uint32_t s_randomState = 1;                      //!< State of the random generator
+static uint32_t s_tick = 0;                             //!< Virtual HAL tick
+static uint32_t s_seed = 0;                             //!< Seed of the current machine
+static uint32_t s_step = 0;                             //!< Step of the current machine
+static uint8_t s_awaitedEntry = FUZZ_NO_STATE;          //!< State reached by a transition, not entered yet
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int main(int argc, char** argv)
+{
+    uint32_t seeds = (argc > 1) ? (uint32_t) strtoul(argv[1], 0, 10) : FUZZ_DEFAULT_SEEDS;
+    uint32_t steps = (argc > 2) ? (uint32_t) strtoul(argv[2], 0, 10) : FUZZ_DEFAULT_STEPS;
+
+    uint32_t entries = 0;
+    uint32_t exits = 0;
+    for (uint32_t seed = 1; seed <= seeds; seed++)
+    {
+        fuzzStateMachine(seed, steps);
+        entries += s_entryCount;
+        exits += s_exitCount;
+    }
+
+    printf("State table fuzzer: %u machines (%u states, %u events), %u steps each, %u entries, %u exits, no violation\n",
+           seeds, FUZZ_STATES, FUZZ_EVENTS - 1, steps, entries, exits);
+
+    double cyclic = benchmarkThroughput(false);
+    double completion = benchmarkThroughput(true);
+    printf("%20s %30s\n", "cyclic [events/s]", "run to completion [events/s]");
+    printf("%20.0f %30.0f\n", cyclic, completion);
+
+    return 0;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief xorshift32 random generator
+ */
+static uint32_t fuzzRandom(void)
+{
+    s_randomState ^= s_randomState << 13;
+    s_randomState ^= s_randomState >> 17;
+    s_randomState ^= s_randomState << 5;
+
+    return s_randomState;
+}
+
+static uint32_t fuzzGetTick(void)
+{
+    return s_tick;
+}
+
+static void fuzzFail(const char* message)
+{
+    printf("ERROR: seed %u, step %u, state %u: %s\n", s_seed, s_step, s_stateTable.currentState, message);
+    exit(1);
+}
+
+/**
+ * @brief Checks whether a state is the given state or one of its descendants
+ */
+static bool fuzzIsAncestor(uint8_t ancestor, uint8_t state)
+{
+    for (; state != STT_NO_PARENT; state = s_states[state].parentIndex)
+    {
+        if (state == ancestor)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int32_t fuzzOnEntry(StateTable_t* pStateTable, int32_t stateIndex)
+{
+    uint8_t parent = s_states[stateIndex].parentIndex;
+
+    FUZZ_CHECK(s_entered[stateIndex] == false, "state entered twice");
+    FUZZ_CHECK(parent == STT_NO_PARENT || s_entered[parent] == true, "state entered before its parent");
+    FUZZ_CHECK(fuzzIsAncestor((uint8_t) stateIndex, pStateTable->currentState), "entered state isn't on the path to the current state");
+
+    s_entered[stateIndex] = true;
+    s_entryCount++;
+
+    if (stateIndex == s_awaitedEntry)
+    {
+        s_awaitedEntry = FUZZ_NO_STATE;
+    }
+
+    // Some entry actions send events, like the application does
+    if (fuzzRandom() % 8 == 0)
+    {
+        stateTableSendEvent(pStateTable, 1 + (int32_t) (fuzzRandom() % (FUZZ_EVENTS - 1)));
+    }
+
+    return STATETBL_ERR_OK;
+}
+
+static int32_t fuzzOnState(StateTable_t* pStateTable, int32_t stateIndex)
+{
+    FUZZ_CHECK(stateIndex == pStateTable->currentState, "state function of another state called");
+    for (uint8_t state = (uint8_t) stateIndex; state != STT_NO_PARENT; state = s_states[state].parentIndex)
+    {
+        FUZZ_CHECK(s_entered[state] == true, "state function called before the entry functions");
+    }
+
+    return STATETBL_ERR_OK;
+}
+
+static int32_t fuzzOnExit(StateTable_t* pStateTable, int32_t stateIndex)
+{
+    FUZZ_CHECK(s_entered[stateIndex] == true, "state exited without an entry");
+    for (int32_t i = 0; i < FUZZ_STATES; i++)
+    {
+        FUZZ_CHECK(s_entered[i] == false || s_states[i].parentIndex != stateIndex, "state exited before its child");
+    }
+
+    s_entered[stateIndex] = false;
+    s_exitCount++;
+
+    return STATETBL_ERR_OK;
+}
+
+static bool fuzzGuard(StateTable_t* pStateTable, const StateTableEntry_t* pEntry, int32_t eventID)
+{
+    FUZZ_CHECK(pEntry->eventID == eventID, "guard called for another event");
+    FUZZ_CHECK(fuzzIsAncestor(pEntry->stateIndexFrom, pStateTable->currentState), "guard of a state which isn't active");
+
+    return (fuzzRandom() % 3) != 0;
+}
+
+/**
+ * @brief Generates a random state machine, the parents have a lower index
+ * than their children
+ */
+static void buildStateMachine(uint32_t seed)
+{
+    s_randomState = seed * 2654435761u + 1;
+
+    memset(s_entries, 0, sizeof(s_entries));
+    memset(s_dispatch, 0, sizeof(s_dispatch));
+
+    uint8_t depth[FUZZ_STATES];
+    for (int32_t i = 0; i < FUZZ_STATES; i++)
+    {
+        State_t* pState = &s_states[i];
+        memset(pState, 0, sizeof(State_t));
+        pState->parentIndex = STT_NO_PARENT;
+        depth[i] = 0;
+
+        if (i > 0 && fuzzRandom() % 3 != 0)
+        {
+            uint8_t parent = (uint8_t) (fuzzRandom() % i);
+            if (depth[parent] + 1 < STATETBL_MAX_DEPTH)
+            {
+                pState->parentIndex = parent;
+                depth[i] = depth[parent] + 1;
+            }
+        }
+
+        // Entry and exit are tracked by the model, so only the state function is optional
+        pState->pOnEntry = s_onEntry[i];
+        pState->pOnState = (fuzzRandom() % 4 != 0) ? s_onState[i] : 0;
+        pState->pOnExit = s_onExit[i];
+
+        if (fuzzRandom() % 5 == 0)
+        {
+            pState->timeoutEvent = (uint8_t) (1 + fuzzRandom() % (FUZZ_EVENTS - 1));
+            pState->timeout = 10 + fuzzRandom() % 400;
+        }
+    }
+
+    int32_t entryCount = 0;
+    for (int32_t i = 0; i < FUZZ_STATES; i++)
+    {
+        // Every state can be left, otherwise the walk gets stuck in the first sink
+        int32_t transitions = 1 + (int32_t) (fuzzRandom() % 4);
+        for (int32_t j = 0; j < transitions && entryCount < FUZZ_MAX_TRANSITIONS; j++)
+        {
+            StateTableEntry_t* pEntry = &s_entries[entryCount++];
+            pEntry->stateIndexFrom = (uint8_t) i;
+            pEntry->stateIndexTo = (uint8_t) (fuzzRandom() % FUZZ_STATES);
+            pEntry->eventID = (uint8_t) (1 + fuzzRandom() % (FUZZ_EVENTS - 1));
+            pEntry->pGuard = (fuzzRandom() % 3 == 0) ? fuzzGuard : 0;
+
+            // Append to the chain of the state/event combination
+            const StateTableEntry_t** ppCell = &s_dispatch[i][pEntry->eventID];
+            while (*ppCell != 0)
+            {
+                ppCell = (const StateTableEntry_t**) &((*ppCell)->pNext);
+            }
+            *ppCell = pEntry;
+        }
+    }
+
+    s_definition.pStates = s_states;
+    s_definition.stateCount = FUZZ_STATES;
+    s_definition.eventCount = FUZZ_EVENTS;
+    s_definition.initialState = (uint8_t) (fuzzRandom() % FUZZ_STATES);
+    s_definition.pDispatch = &s_dispatch[0][0];
+    s_definition.pEventPriority = 0;
+}
+
+/**
+ * @brief Checks the instance against the model after a cycle
+ *
+ * @param quiescent     true if all entry functions have to be called
+ */
+static void checkInstance(bool quiescent)
+{
+    uint8_t current = s_stateTable.currentState;
+    FUZZ_CHECK(current < FUZZ_STATES, "invalid current state");
+
+    int32_t enteredCount = 0;
+    for (int32_t i = 0; i < FUZZ_STATES; i++)
+    {
+        if (s_entered[i] == true)
+        {
+            FUZZ_CHECK(fuzzIsAncestor((uint8_t) i, current), "entered state isn't on the path to the current state");
+            enteredCount++;
+        }
+    }
+    FUZZ_CHECK(enteredCount == s_stateTable.enteredDepth, "entered depth differs from the entered states");
+
+    if (quiescent == true)
+    {
+        int32_t pathLength = 0;
+        for (uint8_t state = current; state != STT_NO_PARENT; state = s_states[state].parentIndex)
+        {
+            pathLength++;
+        }
+        FUZZ_CHECK(enteredCount == pathLength, "state not completely entered");
+    }
+}
+
+/**
+ * @brief Drives one generated state machine with random actions
+ */
+static void fuzzStateMachine(uint32_t seed, uint32_t steps)
+{
+    buildStateMachine(seed);
+    s_seed = seed;
+    s_step = 0;
+
+    FUZZ_CHECK(stateTableValidate(&s_definition) == STATETBL_ERR_OK, "generated definition is invalid");
+
+    memset(s_entered, 0, sizeof(s_entered));
+    s_entryCount = 0;
+    s_exitCount = 0;
+    s_tick = fuzzRandom();
+
+    stateTableInitialize(&s_stateTable, &s_definition, 0);
+    s_awaitedEntry = s_definition.initialState;
+    stateTimerWheelInitialize(&s_timerWheel, fuzzGetTick);
+    stateTableAttachTimerWheel(&s_stateTable, &s_timerWheel);
+
+    bool runToCompletion = (seed % 2) == 0;
+    stateTableSetRunToCompletion(&s_stateTable, runToCompletion);
+
+    for (s_step = 0; s_step < steps; s_step++)
+    {
+        uint32_t action = fuzzRandom() % 8;
+        if (action < 3)
+        {
+            // Bursts of events, also events which fill the queue
+            uint32_t burst = 1 + fuzzRandom() % (STATETBL_EVENT_QUEUE_SIZE + 2);
+            for (uint32_t i = 0; i < burst; i++)
+            {
+                stateTableSendEvent(&s_stateTable, 1 + (int32_t) (fuzzRandom() % (FUZZ_EVENTS - 1)));
+            }
+        }
+        else if (action == 3)
+        {
+            s_tick += fuzzRandom() % 100;
+        }
+        else
+        {
+            runCycle(runToCompletion);
+        }
+    }
+
+    // Without new events the machine has to come to rest
+    for (int32_t i = 0; i < 4 * STATETBL_EVENT_QUEUE_SIZE && s_stateTable.eventCount != 0; i++)
+    {
+        runCycle(runToCompletion);
+    }
+    runCycle(runToCompletion);
+}
+
+/**
+ * @brief Advances the timers, runs one cycle and checks the instance
+ *
+ * @param runToCompletion   Mode of the instance
+ */
+static void runCycle(bool runToCompletion)
+{
+    stateTimerWheelAdvance(&s_timerWheel);
+
+    bool eventPending = (s_stateTable.eventCount != 0);
+    uint32_t stepLimitCount = s_stateTable.eventStatistics.stepLimitCount;
+
+    stateTableRunCyclic(&s_stateTable);
+
+    if (runToCompletion == false)
+    {
+        // The first cycle after a transition enters the new state before it takes an event
+        FUZZ_CHECK(s_awaitedEntry == FUZZ_NO_STATE, "state reached by a transition was never entered");
+
+        uint8_t current = s_stateTable.currentState;
+        int32_t pathLength = 0;
+        for (uint8_t state = current; state != STT_NO_PARENT; state = s_states[state].parentIndex)
+        {
+            pathLength++;
+        }
+        if (s_stateTable.enteredDepth < pathLength)
+        {
+            s_awaitedEntry = current;
+        }
+    }
+
+    // A cyclic run without a pending event enters the current state completely,
+    // a run to completion cycle always unless it hit the step limit
+    bool quiescent = runToCompletion ?
+        (s_stateTable.eventCount == 0 && stepLimitCount == s_stateTable.eventStatistics.stepLimitCount) :
+        (eventPending == false);
+    checkInstance(quiescent);
+}
+
+/**
+ * @brief Measures the dispatch throughput for the machine of the first seed
+ *
+ * @param runToCompletion   Mode of the instance
+ *
+ * @return Dispatched events per second
+ */
+static double benchmarkThroughput(bool runToCompletion)
+{
+    buildStateMachine(1);
+    for (int32_t i = 0; i < FUZZ_STATES; i++)
+    {
+        // The invariant checks aren't part of the measurement
+        s_states[i].pOnEntry = 0;
+        s_states[i].pOnState = 0;
+        s_states[i].pOnExit = 0;
+    }
+    for (int32_t i = 0; i < FUZZ_MAX_TRANSITIONS; i++)
+    {
+        s_entries[i].pGuard = 0;
+    }
+
+    stateTableInitialize(&s_stateTable, &s_definition, 0);
+    stateTableSetRunToCompletion(&s_stateTable, runToCompletion);
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (uint32_t i = 0; i < BENCH_EVENT_COUNT; i++)
+    {
+        stateTableSendEvent(&s_stateTable, 1 + (int32_t) (fuzzRandom() % (FUZZ_EVENTS - 1)));
+        stateTableRunCyclic(&s_stateTable);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+    return (double) BENCH_EVENT_COUNT / elapsed;
+}
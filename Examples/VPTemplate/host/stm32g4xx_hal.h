@@ -0,0 +1,47 @@
+/******************************************************************************
+ * @file stm32g4xx_hal.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Minimal replacement of the STM32 HAL header for the host builds
+ *
+ * @details Only provides the definitions which are used by the module
+ * headers of the firmware (e.g. the GPIO pin states in LEDModule.h). The
+ * host directory is searched before the HAL include directories.
+ *
+ *
+ *****************************************************************************/
+#ifndef _HOST_STM32G4XX_HAL_H_
+#define _HOST_STM32G4XX_HAL_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#define GPIO_PIN_RESET      0           //!< Pin state low
+#define GPIO_PIN_SET        1           //!< Pin state high
+
+#define UNUSED(X)           (void)X     //!< Suppresses unused variable warnings (stm32g4xx_hal_def.h)
+
+
+/***** TYPES *****************************************************************/
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Returns the HAL tick in milliseconds (simulated time of the host build)
+ */
+uint32_t HAL_GetTick(void);
+
+
+#endif
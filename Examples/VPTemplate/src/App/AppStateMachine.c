@@ -0,0 +1,84 @@
+/******************************************************************************
+ * @file AppStateMachine.c
+ *
+ * @brief Constant definition of the App state machine
+ *
+ * @details Generated by tools/StateTableGen.py, do not edit. Change the
+ * description (.sm) instead, the firmware build regenerates this file.
+ *
+ *
+ *****************************************************************************/
+/***** INCLUDES **************************************************************/
+#include "AppStateMachine.h"
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+
+/**
+ * @brief List of the states, the position in the list is the state ID
+ *
+ */
+static const State_t s_states[STATE_ID_COUNT] =
+{
+    [STATE_ID_BOOTUP] = {onEntryBootup, 0, 0, STT_NO_PARENT},
+    [STATE_ID_FAILURE] = {onEntryFailure, 0, 0, STT_NO_PARENT},
+    [STATE_ID_ACTIVE] = {0, 0, 0, STT_NO_PARENT},
+    [STATE_ID_MAINTENANCE] = {onEntryMaintenance, onStateMaintenance, 0, STATE_ID_ACTIVE},
+    [STATE_ID_OPERATIONAL] = {onEntryOperational, 0, 0, STATE_ID_ACTIVE},
+    [STATE_ID_MOTOR_STARTUP] = {0, onStateOperational, 0, STATE_ID_OPERATIONAL, EVT_ID_MOTOR_START, 5000},
+    [STATE_ID_MOTOR_RUNNING] = {onEntryMotorRunning, onStateOperational, 0, STATE_ID_OPERATIONAL},
+};
+
+/**
+ * @brief Transitions: FROM_STATE_ID, TO_STATE_ID, EVENT_ID, guard and the
+ * next transition for the same state and event (0 if none)
+ *
+ */
+static const StateTableEntry_t s_transitions[7] =
+{
+    [0] = {STATE_ID_BOOTUP, STATE_ID_MOTOR_STARTUP, EVT_ID_SYSTEM_OK, 0, 0},
+    [1] = {STATE_ID_BOOTUP, STATE_ID_FAILURE, EVT_ID_SENSOR_FAILURE, 0, 0},
+    [2] = {STATE_ID_OPERATIONAL, STATE_ID_MAINTENANCE, EVT_ID_EVENT_MAINTENANCE, 0, 0},
+    [3] = {STATE_ID_MAINTENANCE, STATE_ID_MOTOR_STARTUP, EVT_ID_EVENT_MAINTENANCE, 0, 0},
+    [4] = {STATE_ID_MOTOR_STARTUP, STATE_ID_MOTOR_RUNNING, EVT_ID_MOTOR_START, 0, 0},
+    [5] = {STATE_ID_ACTIVE, STATE_ID_FAILURE, EVT_ID_STACK_OVERFLOW, 0, 0},
+    [6] = {STATE_ID_ACTIVE, STATE_ID_FAILURE, EVT_ID_SENSOR_FAILURE, 0, 0},
+};
+
+/**
+ * @brief Dispatch matrix [STATE_ID][EVT_ID] with the first transition for
+ * each combination, all other combinations aren't handled
+ *
+ */
+static const StateTableEntry_t* const s_dispatch[STATE_ID_COUNT][EVT_ID_COUNT] =
+{
+    [STATE_ID_BOOTUP][EVT_ID_SYSTEM_OK] = &s_transitions[0],
+    [STATE_ID_BOOTUP][EVT_ID_SENSOR_FAILURE] = &s_transitions[1],
+    [STATE_ID_OPERATIONAL][EVT_ID_EVENT_MAINTENANCE] = &s_transitions[2],
+    [STATE_ID_MAINTENANCE][EVT_ID_EVENT_MAINTENANCE] = &s_transitions[3],
+    [STATE_ID_MOTOR_STARTUP][EVT_ID_MOTOR_START] = &s_transitions[4],
+    [STATE_ID_ACTIVE][EVT_ID_STACK_OVERFLOW] = &s_transitions[5],
+    [STATE_ID_ACTIVE][EVT_ID_SENSOR_FAILURE] = &s_transitions[6],
+};
+
+/**
+ * @brief Priorities of the events
+ *
+ */
+static const uint8_t s_eventPriority[EVT_ID_COUNT] =
+{
+    [STT_NONE_EVENT] = STATETBL_EVENT_PRIORITY_DEFAULT,
+    [EVT_ID_SYSTEM_OK] = STATETBL_EVENT_PRIORITY_DEFAULT,
+    [EVT_ID_SENSOR_FAILURE] = STATETBL_EVENT_PRIORITY_HIGHEST,
+    [EVT_ID_STACK_OVERFLOW] = STATETBL_EVENT_PRIORITY_HIGHEST,
+    [EVT_ID_EVENT_MAINTENANCE] = STATETBL_EVENT_PRIORITY_DEFAULT,
+    [EVT_ID_MOTOR_START] = STATETBL_EVENT_PRIORITY_DEFAULT,
+};
+
+
+/***** PUBLIC VARIABLES ******************************************************/
+
+const StateTableDefinition_t gAppStateMachine =
+{
+    s_states, STATE_ID_COUNT, EVT_ID_COUNT, STATE_ID_BOOTUP, &s_dispatch[0][0], s_eventPriority
+};
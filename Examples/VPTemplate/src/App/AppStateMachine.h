@@ -0,0 +1,74 @@
+/******************************************************************************
+ * @file AppStateMachine.h
+ *
+ * @brief IDs and definition of the App state machine
+ *
+ * @details Generated by tools/StateTableGen.py, do not edit. Change the
+ * description (.sm) instead, the firmware build regenerates this file.
+ *
+ *
+ *****************************************************************************/
+#ifndef _APP_STATE_MACHINE_H_
+#define _APP_STATE_MACHINE_H_
+
+/***** INCLUDES **************************************************************/
+#include "Util/StateTable/StateTable.h"
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+
+
+/***** TYPES *****************************************************************/
+
+/**
+ * @brief State IDs, the ID is the index in the state list
+ *
+ */
+typedef enum _AppStateID
+{
+    STATE_ID_BOOTUP = 0,                //!< Initial State
+    STATE_ID_FAILURE = 1,               //!< Failure State, can be reached by sensor failure or stack overflow
+    STATE_ID_ACTIVE = 2,                //!< Parent State of Operational and Maintenance, handles the faults
+    STATE_ID_MAINTENANCE = 3,           //!< Maintenance State, can be toggled by user by Button B1
+    STATE_ID_OPERATIONAL = 4,           //!< Operational State, reached after successful bootup, parent of the motor states
+    STATE_ID_MOTOR_STARTUP = 5,         //!< Motor is off until the start delay expired
+    STATE_ID_MOTOR_RUNNING = 6,         //!< Motor is running
+    STATE_ID_COUNT = 7,                 //!< Number of states
+} AppStateID_t;
+
+/**
+ * @brief Event IDs, 0 is STT_NONE_EVENT
+ *
+ */
+typedef enum _AppEventID
+{
+    EVT_ID_SYSTEM_OK = 1,               //!< Event ID for Successful Bootup
+    EVT_ID_SENSOR_FAILURE = 2,          //!< Event ID for Sensor Failure
+    EVT_ID_STACK_OVERFLOW = 3,          //!< Event ID for Stack Overflow
+    EVT_ID_EVENT_MAINTENANCE = 4,       //!< Event ID for Maintenance Mode
+    EVT_ID_MOTOR_START = 5,             //!< Event ID for the expired motor start delay (state timer)
+    EVT_ID_COUNT = 6,                   //!< Number of event IDs including STT_NONE_EVENT
+} AppEventID_t;
+
+
+/***** PROTOTYPES ************************************************************/
+
+// Actions of the states, implemented by the application
+int32_t onEntryBootup(StateTable_t* pStateTable, int32_t eventID);
+int32_t onEntryFailure(StateTable_t* pStateTable, int32_t eventID);
+int32_t onEntryMaintenance(StateTable_t* pStateTable, int32_t eventID);
+int32_t onStateMaintenance(StateTable_t* pStateTable, int32_t eventID);
+int32_t onEntryOperational(StateTable_t* pStateTable, int32_t eventID);
+int32_t onStateOperational(StateTable_t* pStateTable, int32_t eventID);
+int32_t onEntryMotorRunning(StateTable_t* pStateTable, int32_t eventID);
+
+/**
+ * @brief Definition of the App state machine (constant, in flash)
+ *
+ */
+extern const StateTableDefinition_t gAppStateMachine;
+
+#endif
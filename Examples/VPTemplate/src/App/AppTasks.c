@@ -47,8 +47,6 @@
 
 void taskApp10ms()
 {
-    readPot1();
-    readPot2();
     readButtonB1();
     readButtonSW1();
     readButtonSW2();
@@ -66,6 +64,15 @@ void taskApp50ms()
 void taskApp250ms()
 {
     cyclic250ms_StackMonitoring();
+    appDrainTransitionTrace();
+}
+
+void workADCSequence(uint32_t argument)
+{
+    // Every block is filtered exactly once, right after the conversion. The
+    // decimated internal channels get a new value at most once per block.
+    readPotentiometers();
+    readInternalChannels();
 }
 
 
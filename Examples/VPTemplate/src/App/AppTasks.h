@@ -32,9 +32,7 @@
 
 /**
  * @brief Task for the 10ms cyclic event
- *        Does:           
- *           - read Potentiometer 1
- *           - read Potentiometer 2
+ *        Does:
  *           - read Button B1
  *           - read Button SW1
  *           - read Button SW2
@@ -54,7 +52,17 @@ void taskApp50ms();
  * @brief Task for the 100ms cyclic event
  *        Does:
  *          - Stack Monitoring
+ *          - print the state transition trace
  */
 void taskApp250ms();
 
+/**
+ * @brief Deferred work after every block of ADC conversion sequences
+ *        Does:
+ *          - filter Potentiometer 1 and 2 with the block
+ *
+ * @param argument Unused
+ */
+void workADCSequence(uint32_t argument);
+
 #endif /* SRC_APP_APPTASKS_H_ */
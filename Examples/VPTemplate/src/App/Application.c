@@ -19,6 +19,8 @@
 #include <string.h>
 #include <stdint.h>
 
+#include "stm32g4xx_hal.h"
+
 #include "Application.h"
 #include "Util/Global.h"
 #include "Util/printf.h"
@@ -87,7 +89,6 @@ static const int32_t TICKS_FOR_1_SECOND = 20;
 static const int32_t TICKS_FOR_3_SECONDS = 3 * TICKS_FOR_1_SECOND;
 static const int32_t TICKS_FOR_5_SECONDS = 5 * TICKS_FOR_1_SECOND;
 
-static const int32_t TICKS_UNTIL_MOTOR_START = TICKS_FOR_5_SECONDS;
 static const int32_t TICKS_UNTIL_VIOLATION_DISPLAY = TICKS_FOR_3_SECONDS;
 
 static const int32_t TICKS_UNTIL_LIMIT_1_WARNING = TICKS_FOR_5_SECONDS;
@@ -122,6 +123,8 @@ static const int32_t MOTOR_SPEED_LIMIT_2_WARNING_RESOLVE = 800;
 
 static const int8_t INVALID_FLOW_RATE = -1;
 
+static const int32_t TRACE_RECORDS_PER_DRAIN = 4;
+
 // Function prototypes for the motor range and speed violation checks
 static uint8_t motorRange0(int32_t motorSpeed);
 static uint8_t motorRange1(int32_t motorSpeed);
@@ -144,58 +147,8 @@ static const MotorRangeViolationCheck motorRangeViolationCheck[] = {
 static const size_t motorRangeViolationCheckSize = sizeof(motorRangeViolationCheck) / sizeof(MotorRangeViolationCheck);
 
 /***** PRIVATE PROTOTYPES ****************************************************/
-// State realte functions (on-Entry, on-State and on-Exit)
-
-/**
- * @brief entry function for the Bootup state.
- * @param pState: Pointer to pass on the current state of the State machine
- * @param enventID: variable to notify the function from which state it was called.
- * @return STATETBL_ERR_OK: If everything went fine.
- */
-static int32_t onEntryBootup(State_t* pState, int32_t eventID);
-
-/**
- * @brief entry function for the Failure state. Turns on the LEDs depending on the eventID
- * @param pState: Pointer to pass on the current state of the State machine
- * @param enventID: variable to notify the function from which state it was called.
- * @return STATETBL_ERR_OK: If everything went fine.
- */
-static int32_t onEntryFailure(State_t* pState, int32_t eventID);
-
-/**
- * @brief entry function for the Operational state. Turns on the LED0 and sets the motor state to off
- * @param pState: Pointer to pass on the current state of the State machine
- * @param enventID: variable to notify the function from which state it was called.
- * @return STATETBL_ERR_OK: If everything went fine.
- */
-static int32_t onEntryOperational(State_t* pState, int32_t eventID);
-
-/**
- * @brief function for the Operational state. Checks the motor speed and flow rate and sets the LEDs accordingly
- * @param pState: Pointer to pass on the current state of the State machine
- * @param enventID: variable to notify the function from which state it was called.
- * @return STATETBL_ERR_OK: If everything went fine.
- */
-static int32_t onStateOperational(State_t* pState, int32_t eventID);
-
-/**
- * @brief entry function for the Maintenance state.
- * @param pState: Pointer to pass on the current state of the State machine
- * @param enventID: variable to notify the function from which state it was called.
- * @return STATETBL_ERR_OK: If everything went fine.
- **/
-static int32_t onEntryMaintenance(State_t* pState, int32_t eventID);
-
-/**
- * @brief function to set and show the flow rate
- * @details This function can set the flow rate using the SW1 and SW2 buttons
- * It can also show the selected value and initiate the switch to the Operation Mode
- * @param pState: Pointer to pass on the current state of the State machine
- * @param enventID: variable to notify the function from which state it was called.
- * 
-**/
-static int32_t onStateMaintenance(State_t* pState, int32_t eventID);
-
+// The state functions (on-Entry, on-State) are declared by the generated
+// AppStateMachine.h, see AppStateMachine.sm
 
 /**
  * @brief Checks the motor speed for violations, implements a hysteresis according to requirements on page 13
@@ -238,7 +191,6 @@ static void clutterStack();
 /***** PRIVATE VARIABLES *****************************************************/
 static int8_t s_setFlowRate = INVALID_FLOW_RATE;
 static uint8_t s_manualMotorOverride = 0;
-static int32_t s_ticksSinceOperationModeEntered = 0;
 static int32_t s_ticksSinceViolation = 0;
 
 static MotorState s_motorState = MOTOR_OFF;
@@ -249,58 +201,49 @@ static MotorState s_motorState = MOTOR_OFF;
 
 
 /**
- * @brief List of State for the State Machine
- *
- * This list only constructs the state objects for each possible state
- * in the state machine. There are no transistions or events defined
+ * @brief Global State Table instance
  *
  */
-static State_t gStateList[] =
-{
-    {STATE_ID_BOOTUP,       onEntryBootup,  	0,                  0,  false},
-    {STATE_ID_FAILURE,      onEntryFailure, 	0,                  0,  false},
-    {STATE_ID_MAINTENANCE,  onEntryMaintenance, onStateMaintenance, 0,  false},
-    {STATE_ID_OPERATIONAL,  onEntryOperational, onStateOperational, 0,  false},
-};
+static StateTable_t gStateTable;
 
 /**
- * @brief Definition of the transistion table of the state machine. Each row
- * contains FROM_STATE_ID, TO_STATE_ID, EVENT_ID, Function Pointer Guard Function
+ * @brief Timer wheel for the state timers, advanced by appRunCyclic()
  *
- * The last two members of a transistion row are only the initialization of dynamic
- * members used durin runtim
  */
-static StateTableEntry_t s_stateTableEntries[] =
-{
-    {STATE_ID_BOOTUP,          STATE_ID_OPERATIONAL,           EVT_ID_SYSTEM_OK,          0,      0,      0},
-    {STATE_ID_BOOTUP,          STATE_ID_FAILURE,               EVT_ID_SENSOR_FAILURE,     0,      0,      0},
-    {STATE_ID_OPERATIONAL,     STATE_ID_MAINTENANCE,           EVT_ID_EVENT_MAINTENANCE,  0,      0,      0},
-    {STATE_ID_OPERATIONAL,     STATE_ID_FAILURE,               EVT_ID_STACK_OVERFLOW,     0,      0,      0},
-    {STATE_ID_OPERATIONAL,     STATE_ID_FAILURE,               EVT_ID_SENSOR_FAILURE,     0,      0,      0},
-    {STATE_ID_MAINTENANCE,     STATE_ID_OPERATIONAL,           EVT_ID_EVENT_MAINTENANCE,  0,      0,      0},
-    {STATE_ID_MAINTENANCE,     STATE_ID_FAILURE,               EVT_ID_STACK_OVERFLOW,     0,      0,      0},
-};
+static StateTimerWheel_t s_timerWheel;
 
 /**
- * @brief Global State Table instance
+ * @brief Binary trace of the state transitions, drained by appDrainTransitionTrace()
  *
  */
-static StateTable_t gStateTable;
+static StateTrace_t s_transitionTrace;
 
 
 /***** PUBLIC FUNCTIONS ******************************************************/
 
 int32_t appInitialize()
 {
-    gStateTable.pStateList = gStateList;
-    gStateTable.stateCount = sizeof(gStateList) / sizeof(State_t);
-    int32_t result = stateTableInitialize(&gStateTable, s_stateTableEntries, sizeof(s_stateTableEntries) / sizeof(StateTableEntry_t), STATE_ID_BOOTUP);
+    int32_t result = stateTableInitialize(&gStateTable, &gAppStateMachine, 0);
+
+    if (result == STATETBL_ERR_OK)
+    {
+        stateTimerWheelInitialize(&s_timerWheel, HAL_GetTick);
+        stateTableAttachTimerWheel(&gStateTable, &s_timerWheel);
+        stateTraceInitialize(&s_transitionTrace, HAL_GetTick);
+        stateTableAttachTrace(&gStateTable, &s_transitionTrace);
+
+        // Bootup, its result and a fault reaction complete within one cycle of taskApp50ms
+        stateTableSetRunToCompletion(&gStateTable, true);
+    }
 
     return result;
 }
 
 int32_t appRunCyclic()
 {
+    // Expired state timers are queued as events before the state machine runs
+    stateTimerWheelAdvance(&s_timerWheel);
+
     int32_t result = stateTableRunCyclic(&gStateTable);
     return result;
 }
@@ -311,10 +254,40 @@ int32_t appSendEvent(int32_t eventID)
     return result;
 }
 
+int32_t appDrainTransitionTrace()
+{
+    // The records are formatted here, off the path of the state machine
+    StateTraceRecord_t record;
+    int32_t count = 0;
+
+    while (count < TRACE_RECORDS_PER_DRAIN && stateTraceRead(&s_transitionTrace, &record) == STATE_TRACE_ERR_OK)
+    {
+        if (record.guardResult == STATE_TRACE_GUARD_REJECTED)
+        {
+            DEBUG_LOGF("[%u] Guard rejected transition from %d to %d with event %d\n\r",
+                record.timestamp, record.stateIndexFrom, record.stateIndexTo, record.eventID);
+        }
+        else
+        {
+            DEBUG_LOGF("[%u] State Transition from %d to %d with event %d\n\r",
+                record.timestamp, record.stateIndexFrom, record.stateIndexTo, record.eventID);
+        }
+        count++;
+    }
+
+    return count;
+}
+
 
 /***** PRIVATE FUNCTIONS *****************************************************/
 
-static int32_t onEntryBootup(State_t* pState, int32_t eventID)
+/**
+ * @brief entry function for the Bootup state.
+ * @param pStateTable: Pointer to the state machine instance
+ * @param enventID: variable to notify the function from which state it was called.
+ * @return STATETBL_ERR_OK: If everything went fine.
+ */
+int32_t onEntryBootup(StateTable_t* pStateTable, int32_t eventID)
 {
 
 	initADCService();
@@ -328,7 +301,13 @@ static int32_t onEntryBootup(State_t* pState, int32_t eventID)
     return appSendEvent(EVT_ID_SYSTEM_OK);
 }
 
-static int32_t onEntryFailure(State_t* pState, int32_t eventID)
+/**
+ * @brief entry function for the Failure state. Turns on the LEDs depending on the eventID
+ * @param pStateTable: Pointer to the state machine instance
+ * @param enventID: variable to notify the function from which state it was called.
+ * @return STATETBL_ERR_OK: If everything went fine.
+ */
+int32_t onEntryFailure(StateTable_t* pStateTable, int32_t eventID)
 {
     if(eventID == EVT_ID_SENSOR_FAILURE)
     {
@@ -356,11 +335,21 @@ static int32_t onEntryFailure(State_t* pState, int32_t eventID)
     return STATETBL_ERR_OK;
 }
 
-int32_t onEntryOperational(State_t *pState, int32_t eventID)
+/**
+ * @brief entry function for the Operational state. Turns on the LED0, sets the motor state to off
+ * and switches the ADC to the oversampling for the motor monitoring
+ * @param pStateTable: Pointer to the state machine instance
+ * @param enventID: variable to notify the function from which state it was called.
+ * @return STATETBL_ERR_OK: If everything went fine.
+ */
+int32_t onEntryOperational(StateTable_t* pStateTable, int32_t eventID)
 {
-	s_ticksSinceOperationModeEntered = 0;
 	s_manualMotorOverride = 0;
 	s_motorState = 0;
+	if (setADCMode(ADC_MODE_HIGH_RESOLUTION) != 0)
+	{
+		DEBUG_LOGF("ADC high resolution mode failed\n\r");
+	}
 	setLEDValue(LED0, LED_TURNED_ON);
 	setLEDValue(LED1, LED_TURNED_OFF);
 	setLEDValue(LED2, LED_TURNED_OFF);
@@ -369,6 +358,18 @@ int32_t onEntryOperational(State_t *pState, int32_t eventID)
 	return STATETBL_ERR_OK;
 }
 
+/**
+ * @brief entry function for the MotorRunning state. Turns on the motor after the start delay
+ * @param pStateTable: Pointer to the state machine instance
+ * @param enventID: variable to notify the function from which state it was called.
+ * @return STATETBL_ERR_OK: If everything went fine.
+ */
+int32_t onEntryMotorRunning(StateTable_t* pStateTable, int32_t eventID)
+{
+	s_motorState = MOTOR_ON;
+	return STATETBL_ERR_OK;
+}
+
 
 
 static MonitoringViolation checkMotorSpeedFlowRateRelation(int32_t motorSpeed, int32_t flowRate)
@@ -485,9 +486,14 @@ static MonitoringViolation checkMotorSpeed(int32_t motorSpeed)
 }
 
 
-static int32_t onStateOperational(State_t* pState, int32_t eventID)
+/**
+ * @brief function for the Operational state. Checks the motor speed and flow rate and sets the LEDs accordingly
+ * @param pStateTable: Pointer to the state machine instance
+ * @param enventID: variable to notify the function from which state it was called.
+ * @return STATETBL_ERR_OK: If everything went fine.
+ */
+int32_t onStateOperational(StateTable_t* pStateTable, int32_t eventID)
 {
-	s_ticksSinceOperationModeEntered++;
 	int32_t motorSpeed = getMotorSpeed();
 	int32_t flowRate = getFlowRate();
 	if(motorSpeed < 0 || flowRate < 0)
@@ -527,11 +533,6 @@ static int32_t onStateOperational(State_t* pState, int32_t eventID)
 		s_manualMotorOverride = false;
 	}
 
-	if(s_ticksSinceOperationModeEntered >= TICKS_UNTIL_MOTOR_START)
-	{
-		s_motorState = MOTOR_ON;
-	}
-
 	if(s_motorState != MOTOR_OFF && !s_manualMotorOverride)
 	{
 		
@@ -584,8 +585,19 @@ static void clutterStack()
 	UNUSED(stack);
 }
 
-static int32_t onEntryMaintenance(State_t* pState, int32_t eventID)
+/**
+ * @brief entry function for the Maintenance state. The motor is stopped, so the ADC
+ * only samples the sensors at the low power rate for the range check.
+ * @param pStateTable: Pointer to the state machine instance
+ * @param enventID: variable to notify the function from which state it was called.
+ * @return STATETBL_ERR_OK: If everything went fine.
+ **/
+int32_t onEntryMaintenance(StateTable_t* pStateTable, int32_t eventID)
 {
+	if (setADCMode(ADC_MODE_LOW_POWER) != 0)
+	{
+		DEBUG_LOGF("ADC low power mode failed\n\r");
+	}
 	setLEDValue(LED0, LED_BLINKING);
 	setLEDValue(LED1, LED_TURNED_OFF);
 	setLEDValue(LED2, LED_TURNED_OFF);
@@ -594,7 +606,15 @@ static int32_t onEntryMaintenance(State_t* pState, int32_t eventID)
 }
 
 
-static int32_t onStateMaintenance(State_t* pState, int32_t eventID)
+/**
+ * @brief function to set and show the flow rate
+ * @details This function can set the flow rate using the SW1 and SW2 buttons
+ * It can also show the selected value and initiate the switch to the Operation Mode
+ * @param pStateTable: Pointer to the state machine instance
+ * @param enventID: variable to notify the function from which state it was called.
+ * 
+**/
+int32_t onStateMaintenance(StateTable_t* pStateTable, int32_t eventID)
 {
 	DisplayValues DispValues;
 	DispValues.RightDisplay = DIGIT_OFF;
@@ -19,19 +19,14 @@
 /***** INCLUDES **************************************************************/
 #include <stdint.h>
 
+// State and event IDs (generated from AppStateMachine.sm)
+#include "AppStateMachine.h"
+
 /***** CONSTANTS *************************************************************/
 
 
 /***** MACROS ****************************************************************/
-#define STATE_ID_BOOTUP             1       //!< Initial State
-#define STATE_ID_FAILURE            2       //!< Failure State, can be reached by sensor failure or stack overflow
-#define STATE_ID_MAINTENANCE        3       //!< Maintenance State, can be toggled by user by Button B1
-#define STATE_ID_OPERATIONAL        4       //!< Operational State, reached after successful bootup
 
-#define EVT_ID_SYSTEM_OK            1       //!< Event ID for Successful Bootup
-#define EVT_ID_SENSOR_FAILURE       2       //!< Event ID for Sensor Failure
-#define EVT_ID_STACK_OVERFLOW       3       //!< Event ID for Stack Overflow
-#define EVT_ID_EVENT_MAINTENANCE    4       //!< Event ID for Maintenance Mode
 
 /***** TYPES *****************************************************************/
 
@@ -44,4 +39,6 @@ int32_t appRunCyclic();
 
 int32_t appSendEvent(int32_t eventID);
 
+int32_t appDrainTransitionTrace();
+
 #endif
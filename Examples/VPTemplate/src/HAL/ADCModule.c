@@ -21,15 +21,67 @@
 #include "System.h"
 #include "HardwareConfig.h"
 #include "ADCModule.h"
+#include "TimerModule.h"
+#include "Critical.h"
 
+#include <stdbool.h>
 #include <string.h>
 
 /***** PRIVATE CONSTANTS *****************************************************/
-static const int32_t MICROVOLTS_PER_DIGIT = 805;    //!< 805 µV / digit
+static const int32_t MICROVOLTS_PER_DIGIT_NUM = 825;    //!< 3.3 V / 65536 digits = 825 / 16384 µV / digit
+static const int32_t MICROVOLTS_PER_DIGIT_SHIFT = 14;   //!< Division by 16384 of MICROVOLTS_PER_DIGIT_NUM
+static const uint32_t CONVERSION_HALF_CYCLES = 25;      //!< 12.5 ADC clock cycles of the successive approximation
+
+//! Sampling times of the HAL and their duration, indexed by ADC_SampleTime_t
+static const struct
+{
+    uint32_t samplingTime;                  //!< ADC_SAMPLETIME_xxx of the HAL
+    uint32_t halfCycles;                    //!< Duration in half ADC clock cycles
+} SAMPLE_TIMES[ADC_SAMPLE_COUNT] = {
+    { ADC_SAMPLETIME_2CYCLES_5,     5 },
+    { ADC_SAMPLETIME_6CYCLES_5,     13 },
+    { ADC_SAMPLETIME_12CYCLES_5,    25 },
+    { ADC_SAMPLETIME_24CYCLES_5,    49 },
+    { ADC_SAMPLETIME_47CYCLES_5,    95 },
+    { ADC_SAMPLETIME_92CYCLES_5,    185 },
+    { ADC_SAMPLETIME_247CYCLES_5,   495 },
+    { ADC_SAMPLETIME_640CYCLES_5,   1281 },
+};
+
+//! Input and rank of the channels, indexed by ADC_Channel_t
+static const struct
+{
+    uint32_t channel;                       //!< ADC_CHANNEL_xxx of the HAL
+    uint32_t rank;                          //!< Rank within the regular sequence
+} CHANNELS[ADC_CHANNEL_COUNT] = {
+    { ADC_CHANNEL_1,                ADC_REGULAR_RANK_1 },
+    { ADC_CHANNEL_2,                ADC_REGULAR_RANK_2 },
+    { ADC_CHANNEL_TEMPSENSOR_ADC1,  ADC_REGULAR_RANK_3 },
+    { ADC_CHANNEL_VBAT,             ADC_REGULAR_RANK_4 },
+    { ADC_CHANNEL_VREFINT,          ADC_REGULAR_RANK_5 },
+};
+
+//! Oversampling ratios 2^1 to 2^8 of the HAL
+static const uint32_t OVERSAMPLING_RATIOS[] = {
+    ADC_OVERSAMPLING_RATIO_2, ADC_OVERSAMPLING_RATIO_4, ADC_OVERSAMPLING_RATIO_8, ADC_OVERSAMPLING_RATIO_16,
+    ADC_OVERSAMPLING_RATIO_32, ADC_OVERSAMPLING_RATIO_64, ADC_OVERSAMPLING_RATIO_128, ADC_OVERSAMPLING_RATIO_256,
+};
+
+//! Right shifts 0 to 4 of the HAL, reduce the oversampling sum of 2^4 to 2^8 conversions to 16 bit
+static const uint32_t RIGHT_BIT_SHIFTS[] = {
+    ADC_RIGHTBITSHIFT_NONE, ADC_RIGHTBITSHIFT_1, ADC_RIGHTBITSHIFT_2, ADC_RIGHTBITSHIFT_3, ADC_RIGHTBITSHIFT_4,
+};
+
+static const int32_t SNAPSHOT_MAX_RETRIES = 4;      //!< Attempts of adcGetSnapshot() and adcGetBlock() before ADC_ERR_BUSY
 
 
 /***** PRIVATE MACROS ********************************************************/
-#define ADC_CHANNEL_COUNT       5                   //!< Total number of used ADC channels
+#define ADC_BUFFER_HALVES       2                   //!< The DMA fills one half (block) while the other one is read
+#define ADC_LATEST_SEQUENCE     (ADC_BLOCK_SEQUENCES - 1)   //!< Index of the latest sequence within a block
+#define ADC_CLOCK_DIVIDER       4                   //!< ADC clock is HCLK / 4 (ADC_CLOCK_SYNC_PCLK_DIV4)
+#define ADC_OVERSAMPLING_MIN_EXPONENT   4           //!< Oversampling below 16 would not reach 16 bit
+#define ADC_OVERSAMPLING_MAX_EXPONENT   8           //!< Oversampling ratio 256
+#define ADC_MAX_DECIMATED_SEQUENCES     65536       //!< Limit of the decimation, keeps the sum within 32 bit
 
 #define IDX_ADC_INPUT0          0                   //!< Array index for ADC channel 0 (Pot 1) in global ADC value array
 #define IDX_ADC_INPUT1          1                   //!< Array index for ADC channel 1 (Pot 2) in global ADC value array
@@ -40,17 +92,49 @@ static const int32_t MICROVOLTS_PER_DIGIT = 805;    //!< 805 µV / digit
 
 /***** PRIVATE TYPES *********************************************************/
 
+/**
+ * @brief Boxcar decimator of a channel
+ *
+ */
+typedef struct _ADCDecimator
+{
+    uint32_t sum;                           //!< Sum of the values of the current decimation period
+    uint32_t blocks;                        //!< Number of blocks in the sum
+    uint16_t count;                         //!< Number of the last published value
+} ADCDecimator_t;
+
 
 /***** PRIVATE PROTOTYPES ****************************************************/
 
 static void adcInitializeDMA(void);
+static bool adcIsProfileValid(const ADCProfile_t* pProfile);
+static void adcConfigure(const ADCProfile_t* pProfile);
+static void adcDecimate(uint32_t half);
+static void adcPublishHalf(uint32_t half);
+static int32_t adcCopyPublishedHalf(uint32_t firstSequence, void* pValues, uint32_t size,
+                                    uint32_t* pLastSequence, uint32_t* pTimestamp);
 
 
 /***** PRIVATE VARIABLES *****************************************************/
 static ADC_HandleTypeDef gADCHandle;                //!< Global handle for ADC peripheral
 static DMA_HandleTypeDef gDMA_ADC_Handle;           //!< Global handle for DMA peripheral used for ADC data transfer
 
-static uint32_t gADCValues[ADC_CHANNEL_COUNT];      //!< Global array for ADC values used by the DMA transfer
+//! Global ping-pong buffer for the ADC values used by the DMA transfer, one block per half
+static uint16_t gADCValues[ADC_BUFFER_HALVES][ADC_BLOCK_SEQUENCES][ADC_CHANNEL_COUNT];
+
+/**
+ * Seqlock of the published half: odd while the interrupt updates the
+ * published half and the time stamp, incremented twice per block
+ */
+static volatile uint32_t gPublishSequence = 0;
+static volatile uint32_t gPublishedHalf = 0;        //!< Index of the latest complete half
+static volatile uint32_t gPublishedTimestamp = 0;   //!< HAL tick of the latest complete half
+static volatile uint32_t gPublishedLastSequence = 0;    //!< Number of the latest conversion sequence, wraps around
+static ADCConversionCallback gConversionCallback = 0;   //!< Callback at the end of every block
+
+static const ADCProfile_t* gpProfile = 0;           //!< Active acquisition profile
+static ADCDecimator_t gDecimators[ADC_CHANNEL_COUNT];   //!< Decimators of the channels, only used by the interrupt
+static volatile uint32_t gChannelValues[ADC_CHANNEL_COUNT]; //!< Decimated values, count in the upper and value in the lower half word
 
 
 /***** PUBLIC FUNCTIONS ******************************************************/
@@ -60,101 +144,117 @@ int32_t adcInitialize()
     /* Initialize DMA block for use with ADC */
     adcInitializeDMA();
 
-    memset(gADCValues, 0, ADC_CHANNEL_COUNT * sizeof(uint32_t));
+    memset(gADCValues, 0, sizeof(gADCValues));
+    gPublishSequence = 0;
+    gPublishedLastSequence = 0;
 
-    /**
-     * Common config
-     */
-    ADC_MultiModeTypeDef multimode = {0};
-    ADC_ChannelConfTypeDef sConfig = {0};
+    gADCHandle.Instance = ADC1;
 
-    gADCHandle.Instance 					= ADC1;
-    gADCHandle.Init.ClockPrescaler 			= ADC_CLOCK_SYNC_PCLK_DIV4;
-    gADCHandle.Init.Resolution 				= ADC_RESOLUTION_12B;
-    gADCHandle.Init.DataAlign 				= ADC_DATAALIGN_RIGHT;
-    gADCHandle.Init.GainCompensation 		= 0;
-    gADCHandle.Init.ScanConvMode 			= ADC_SCAN_ENABLE;
-    gADCHandle.Init.EOCSelection 			= ADC_EOC_SINGLE_CONV;
-    gADCHandle.Init.LowPowerAutoWait 		= DISABLE;
-    gADCHandle.Init.ContinuousConvMode 		= DISABLE;
-    gADCHandle.Init.NbrOfConversion 		= 5;
-    gADCHandle.Init.DiscontinuousConvMode 	= DISABLE;
-    gADCHandle.Init.ExternalTrigConv 		= ADC_EXTERNALTRIG_T3_TRGO;
-    gADCHandle.Init.ExternalTrigConvEdge 	= ADC_EXTERNALTRIGCONVEDGE_RISING;
-    gADCHandle.Init.DMAContinuousRequests 	= ENABLE;
-    gADCHandle.Init.Overrun 				= ADC_OVR_DATA_PRESERVED;
-    gADCHandle.Init.OversamplingMode 		= DISABLE;
+    return adcSetProfile(&gADCProfileStandard);
+}
 
-    if (HAL_ADC_Init(&gADCHandle) != HAL_OK)
+int32_t adcSetProfile(const ADCProfile_t* pProfile)
+{
+    if (!adcIsProfileValid(pProfile))
     {
-    	Error_Handler();
+        return ADC_ERR_INVALID_PARAM;
     }
 
-	/** Configure the ADC multi-mode
-	*/
-	multimode.Mode = ADC_MODE_INDEPENDENT;
-	if (HAL_ADCEx_MultiModeConfigChannel(&gADCHandle, &multimode) != HAL_OK)
-	{
-		Error_Handler();
-	}
+    if (gpProfile != 0)
+    {
+        HAL_ADC_Stop_DMA(&gADCHandle);
+    }
 
-	/** Configure Regular Channel
-	*/
-	sConfig.Channel 		= ADC_CHANNEL_1;
-	sConfig.Rank 			= ADC_REGULAR_RANK_1;
-	sConfig.SamplingTime 	= ADC_SAMPLETIME_92CYCLES_5;
-	sConfig.SingleDiff 		= ADC_SINGLE_ENDED;
-	sConfig.OffsetNumber 	= ADC_OFFSET_NONE;
-	sConfig.Offset 			= 0;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
-	{
-		Error_Handler();
-	}
+    gpProfile = pProfile;
+    memset(gDecimators, 0, sizeof(gDecimators));
 
-	/** Configure Regular Channel
-	*/
-	sConfig.Channel 		= ADC_CHANNEL_2;
-	sConfig.Rank 			= ADC_REGULAR_RANK_2;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
-	{
-		Error_Handler();
-	}
+    // Values of the previous profile stay readable until the new one published a value
+    for (int32_t i = 0; i < ADC_CHANNEL_COUNT; i++)
+    {
+        gDecimators[i].count = (uint16_t) (gChannelValues[i] >> 16);
+    }
 
-	/** Configure Regular Channel
-	*/
-	sConfig.Channel 		= ADC_CHANNEL_TEMPSENSOR_ADC1;
-	sConfig.Rank 			= ADC_REGULAR_RANK_3;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
-	{
-		Error_Handler();
-	}
+    adcConfigure(pProfile);
 
-	/** Configure Regular Channel
-	*/
-	sConfig.Channel 		= ADC_CHANNEL_VBAT;
-	sConfig.Rank 			= ADC_REGULAR_RANK_4;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
-	{
-		Error_Handler();
-	}
+    if (timerSetTriggerFrequency(pProfile->triggerFrequency) != TIMER_ERR_OK)
+    {
+        return ADC_ERR_INIT_FAILURE;
+    }
 
-	/** Configure Regular Channel
-	*/
-	sConfig.Channel 		= ADC_CHANNEL_VREFINT;
-	sConfig.Rank 			= ADC_REGULAR_RANK_5;
-	if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
-	{
-		Error_Handler();
-	}
+    return ADC_ERR_OK;
+}
 
-	/* Calibrate the ADC */
-    HAL_ADCEx_Calibration_Start(&gADCHandle, ADC_SINGLE_ENDED);
+const ADCProfile_t* adcGetProfile()
+{
+    return gpProfile;
+}
 
-    // Start ADC in DMA mode
-    // This assumes, that DMA peripheral has been already configured
-    HAL_ADC_Start_DMA(&gADCHandle, gADCValues, ADC_CHANNEL_COUNT);
+int32_t adcGetChannelValue(ADC_Channel_t adcChannel, ADCChannelValue_t* pValue)
+{
+    // Value and count are packed into one word, so a single read is consistent
+    uint32_t channelValue = ((uint32_t) adcChannel < ADC_CHANNEL_COUNT) ? gChannelValues[adcChannel] : 0;
+
+    pValue->value = (uint16_t) channelValue;
+    pValue->count = (uint16_t) (channelValue >> 16);
 
-	return ADC_ERR_OK;
+    return (pValue->count != 0) ? ADC_ERR_OK : ADC_ERR_NO_DATA;
+}
+
+int32_t adcRegisterConversionCallback(ADCConversionCallback callback)
+{
+    gConversionCallback = callback;
+
+    return ADC_ERR_OK;
+}
+
+int32_t adcGetSnapshot(ADCSnapshot_t* pSnapshot)
+{
+    return adcCopyPublishedHalf(ADC_LATEST_SEQUENCE, pSnapshot->values, sizeof(pSnapshot->values),
+                                &pSnapshot->sequence, &pSnapshot->timestamp);
+}
+
+int32_t adcGetBlock(ADCBlock_t* pBlock)
+{
+    uint32_t lastSequence = 0;
+    int32_t result = adcCopyPublishedHalf(0, pBlock->values, sizeof(pBlock->values),
+                                          &lastSequence, &pBlock->timestamp);
+
+    pBlock->sequence = (result != ADC_ERR_NO_DATA) ? lastSequence - (ADC_BLOCK_SEQUENCES - 1) : 0;
+
+    return result;
+}
+
+int32_t adcConvertToMicrovolt(int32_t rawValue)
+{
+    return (rawValue * MICROVOLTS_PER_DIGIT_NUM) >> MICROVOLTS_PER_DIGIT_SHIFT;
+}
+
+/**
+* @brief Conversion half complete callback, called by the HAL from the DMA
+* interrupt when the first half of the buffer has been written
+*
+* @param hadc: ADC handle pointer
+*/
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        adcPublishHalf(0);
+    }
+}
+
+/**
+* @brief Conversion complete callback, called by the HAL from the DMA
+* interrupt when the second half of the buffer has been written
+*
+* @param hadc: ADC handle pointer
+*/
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        adcPublishHalf(1);
+    }
 }
 
 /**
@@ -205,8 +305,8 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
 	gDMA_ADC_Handle.Init.Direction 				= DMA_PERIPH_TO_MEMORY;
 	gDMA_ADC_Handle.Init.PeriphInc 				= DMA_PINC_DISABLE;
 	gDMA_ADC_Handle.Init.MemInc 				= DMA_MINC_ENABLE;
-	gDMA_ADC_Handle.Init.PeriphDataAlignment 	= DMA_PDATAALIGN_WORD;
-	gDMA_ADC_Handle.Init.MemDataAlignment 		= DMA_MDATAALIGN_WORD;
+	gDMA_ADC_Handle.Init.PeriphDataAlignment 	= DMA_PDATAALIGN_HALFWORD;
+	gDMA_ADC_Handle.Init.MemDataAlignment 		= DMA_MDATAALIGN_HALFWORD;
 	gDMA_ADC_Handle.Init.Mode 					= DMA_CIRCULAR;
 	gDMA_ADC_Handle.Init.Priority 				= DMA_PRIORITY_LOW;
 
@@ -226,27 +326,28 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
 int32_t adcReadChannelRaw(ADC_Channel_t adcChannel)
 {
     int32_t adcValue = 0;
+    const uint16_t* pValues = gADCValues[gPublishedHalf][ADC_LATEST_SEQUENCE];
 
     switch(adcChannel)
     {
         case ADC_INPUT0:
-            adcValue = gADCValues[IDX_ADC_INPUT0];
+            adcValue = pValues[IDX_ADC_INPUT0];
             break;
 
         case ADC_INPUT1:
-            adcValue = gADCValues[IDX_ADC_INPUT1];
+            adcValue = pValues[IDX_ADC_INPUT1];
             break;
 
         case ADC_TEMP:
-            adcValue = gADCValues[IDX_ADC_TEMP];
+            adcValue = pValues[IDX_ADC_TEMP];
             break;
 
         case ADC_VBAT:
-            adcValue = gADCValues[IDX_ADC_VBAT];
+            adcValue = pValues[IDX_ADC_VBAT];
             break;
 
         case ADC_VREF:
-            adcValue = gADCValues[IDX_ADC_VREF];
+            adcValue = pValues[IDX_ADC_VREF];
             break;
     }
 
@@ -256,7 +357,7 @@ int32_t adcReadChannelRaw(ADC_Channel_t adcChannel)
 int32_t adcReadChannel(ADC_Channel_t adcChannel)
 {
     int32_t adcRawValue = adcReadChannelRaw(adcChannel);
-    int32_t adcMicroVoltValue = adcRawValue * MICROVOLTS_PER_DIGIT;
+    int32_t adcMicroVoltValue = adcConvertToMicrovolt(adcRawValue);
 
     return adcMicroVoltValue;
 }
@@ -265,6 +366,236 @@ int32_t adcReadChannel(ADC_Channel_t adcChannel)
 
 /***** PRIVATE FUNCTIONS *****************************************************/
 
+/**
+ * @brief Checks whether a profile can be configured and the conversion
+ * sequence fits into the trigger period
+ *
+ * @param pProfile Pointer to the profile
+ *
+ * @return Returns true if the profile is valid
+ */
+static bool adcIsProfileValid(const ADCProfile_t* pProfile)
+{
+    if (pProfile == 0 || pProfile->triggerFrequency == 0 ||
+        (pProfile->oversamplingExponent != 0 && pProfile->oversamplingExponent < ADC_OVERSAMPLING_MIN_EXPONENT) ||
+        pProfile->oversamplingExponent > ADC_OVERSAMPLING_MAX_EXPONENT)
+    {
+        return false;
+    }
+
+    uint32_t sequenceHalfCycles = 0;
+    for (int32_t i = 0; i < ADC_CHANNEL_COUNT; i++)
+    {
+        const ADCChannelConfig_t* pChannel = &(pProfile->channels[i]);
+        if (pChannel->sampleTime >= ADC_SAMPLE_COUNT ||
+            (uint32_t) pChannel->decimation * ADC_BLOCK_SEQUENCES > ADC_MAX_DECIMATED_SEQUENCES)
+        {
+            return false;
+        }
+
+        sequenceHalfCycles += SAMPLE_TIMES[pChannel->sampleTime].halfCycles + CONVERSION_HALF_CYCLES;
+    }
+
+    // The oversampling converts every channel 2^n times in a row
+    uint64_t sequenceHalfCyclesTotal = (uint64_t) sequenceHalfCycles << pProfile->oversamplingExponent;
+    uint64_t periodHalfCycles = (2ULL * (HAL_RCC_GetHCLKFreq() / ADC_CLOCK_DIVIDER)) / pProfile->triggerFrequency;
+
+    return sequenceHalfCyclesTotal < periodHalfCycles;
+}
+
+/**
+ * @brief Configures the ADC according to a profile and starts the DMA
+ * transfer. The ADC has to be stopped.
+ *
+ * @param pProfile Pointer to the (valid) profile
+ */
+static void adcConfigure(const ADCProfile_t* pProfile)
+{
+    ADC_MultiModeTypeDef multimode = {0};
+    ADC_ChannelConfTypeDef sConfig = {0};
+
+    gADCHandle.Init.ClockPrescaler 			= ADC_CLOCK_SYNC_PCLK_DIV4;
+    gADCHandle.Init.Resolution 				= ADC_RESOLUTION_12B;
+    gADCHandle.Init.GainCompensation 		= 0;
+    gADCHandle.Init.ScanConvMode 			= ADC_SCAN_ENABLE;
+    gADCHandle.Init.EOCSelection 			= ADC_EOC_SINGLE_CONV;
+    gADCHandle.Init.LowPowerAutoWait 		= DISABLE;
+    gADCHandle.Init.ContinuousConvMode 		= DISABLE;
+    gADCHandle.Init.NbrOfConversion 		= ADC_CHANNEL_COUNT;
+    gADCHandle.Init.DiscontinuousConvMode 	= DISABLE;
+    gADCHandle.Init.ExternalTrigConv 		= ADC_EXTERNALTRIG_T3_TRGO;
+    gADCHandle.Init.ExternalTrigConvEdge 	= ADC_EXTERNALTRIGCONVEDGE_RISING;
+    gADCHandle.Init.DMAContinuousRequests 	= ENABLE;
+    gADCHandle.Init.Overrun 				= ADC_OVR_DATA_PRESERVED;
+
+    if (pProfile->oversamplingExponent == 0)
+    {
+        // Left aligned, the 12 bit result is scaled to 16 bit
+        gADCHandle.Init.DataAlign 			= ADC_DATAALIGN_LEFT;
+        gADCHandle.Init.OversamplingMode 	= DISABLE;
+    }
+    else
+    {
+        // The oversampling always aligns right, the shift reduces the sum to 16 bit
+        uint32_t exponent = pProfile->oversamplingExponent;
+        gADCHandle.Init.DataAlign 							= ADC_DATAALIGN_RIGHT;
+        gADCHandle.Init.OversamplingMode 					= ENABLE;
+        gADCHandle.Init.Oversampling.Ratio 					= OVERSAMPLING_RATIOS[exponent - 1];
+        gADCHandle.Init.Oversampling.RightBitShift 			= RIGHT_BIT_SHIFTS[exponent - ADC_OVERSAMPLING_MIN_EXPONENT];
+        gADCHandle.Init.Oversampling.TriggeredMode 			= ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+        gADCHandle.Init.Oversampling.OversamplingStopReset 	= ADC_REGOVERSAMPLING_CONTINUED_MODE;
+    }
+
+    if (HAL_ADC_Init(&gADCHandle) != HAL_OK)
+    {
+    	Error_Handler();
+    }
+
+	/** Configure the ADC multi-mode
+	*/
+	multimode.Mode = ADC_MODE_INDEPENDENT;
+	if (HAL_ADCEx_MultiModeConfigChannel(&gADCHandle, &multimode) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	/** Configure Regular Channels, the rank is the index in the DMA buffer
+	*/
+	sConfig.SingleDiff 		= ADC_SINGLE_ENDED;
+	sConfig.OffsetNumber 	= ADC_OFFSET_NONE;
+	sConfig.Offset 			= 0;
+	for (int32_t i = 0; i < ADC_CHANNEL_COUNT; i++)
+	{
+		sConfig.Channel 		= CHANNELS[i].channel;
+		sConfig.Rank 			= CHANNELS[i].rank;
+		sConfig.SamplingTime 	= SAMPLE_TIMES[pProfile->channels[i].sampleTime].samplingTime;
+		if (HAL_ADC_ConfigChannel(&gADCHandle, &sConfig) != HAL_OK)
+		{
+			Error_Handler();
+		}
+	}
+
+	/* Calibrate the ADC */
+    HAL_ADCEx_Calibration_Start(&gADCHandle, ADC_SINGLE_ENDED);
+
+    // Start ADC in DMA mode
+    // This assumes, that DMA peripheral has been already configured
+    // The circular DMA covers both halves, the half and full transfer
+    // interrupts mark the end of a block
+    HAL_ADC_Start_DMA(&gADCHandle, (uint32_t*) &gADCValues[0][0][0], ADC_BUFFER_HALVES * ADC_BLOCK_SEQUENCES * ADC_CHANNEL_COUNT);
+}
+
+/**
+ * @brief Adds a published block to the decimators of the channels and
+ * publishes the average of every channel whose decimation period is over
+ *
+ * @param half Index of the complete half
+ */
+static void adcDecimate(uint32_t half)
+{
+    for (int32_t channel = 0; channel < ADC_CHANNEL_COUNT; channel++)
+    {
+        ADCDecimator_t* pDecimator = &gDecimators[channel];
+        for (int32_t i = 0; i < ADC_BLOCK_SEQUENCES; i++)
+        {
+            pDecimator->sum += gADCValues[half][i][channel];
+        }
+
+        uint32_t decimation = gpProfile->channels[channel].decimation;
+        if (++pDecimator->blocks >= decimation)
+        {
+            uint32_t sequences = pDecimator->blocks * ADC_BLOCK_SEQUENCES;
+            uint32_t value = (pDecimator->sum + sequences / 2) / sequences;
+
+            // Skip 0 on the wrap around, it marks that no value has been published yet
+            pDecimator->count = (pDecimator->count == UINT16_MAX) ? 1 : pDecimator->count + 1;
+            gChannelValues[channel] = ((uint32_t) pDecimator->count << 16) | (value > UINT16_MAX ? UINT16_MAX : value);
+
+            pDecimator->sum = 0;
+            pDecimator->blocks = 0;
+        }
+    }
+}
+
+/**
+ * @brief Publishes a complete half of the DMA buffer (seqlock writer) and
+ * notifies the registered callback
+ *
+ * @param half Index of the complete half
+ */
+static void adcPublishHalf(uint32_t half)
+{
+    gPublishSequence++;
+    MEMORY_BARRIER();
+
+    gPublishedHalf = half;
+    gPublishedTimestamp = HAL_GetTick();
+    gPublishedLastSequence += ADC_BLOCK_SEQUENCES;
+
+    MEMORY_BARRIER();
+
+    // Skip 0 on the wrap around, it marks that no block has been published yet
+    gPublishSequence += (gPublishSequence == UINT32_MAX) ? 3 : 1;
+
+    adcDecimate(half);
+
+    if (gConversionCallback != 0)
+    {
+        gConversionCallback();
+    }
+}
+
+/**
+ * @brief Copies sequences of the latest published half (seqlock reader)
+ *
+ * @param firstSequence Index of the first sequence within the block to copy
+ * @param pValues       Pointer to the destination of the raw values
+ * @param size          Number of bytes to copy
+ * @param pLastSequence Receives the number of the latest sequence of the block
+ * @param pTimestamp    Receives the time stamp of the block
+ *
+ * @return Returns ADC_ERR_OK if the copy is consistent, ADC_ERR_NO_DATA if
+ * no block completed yet (the destination is zeroed), ADC_ERR_BUSY if the
+ * half was republished during every retry
+ */
+static int32_t adcCopyPublishedHalf(uint32_t firstSequence, void* pValues, uint32_t size,
+                                    uint32_t* pLastSequence, uint32_t* pTimestamp)
+{
+    for (int32_t retry = 0; retry < SNAPSHOT_MAX_RETRIES; retry++)
+    {
+        uint32_t sequence = gPublishSequence;
+        if ((sequence & 1) != 0)
+        {
+            // Interrupted the publishing interrupt (e.g. from a higher priority), try again
+            continue;
+        }
+
+        if (sequence == 0)
+        {
+            memset(pValues, 0, size);
+            *pLastSequence = 0;
+            *pTimestamp = 0;
+            return ADC_ERR_NO_DATA;
+        }
+
+        MEMORY_BARRIER();
+
+        // The DMA writes the other half until the next block is published
+        memcpy(pValues, gADCValues[gPublishedHalf][firstSequence], size);
+        *pTimestamp = gPublishedTimestamp;
+        *pLastSequence = gPublishedLastSequence;
+
+        MEMORY_BARRIER();
+
+        if (sequence == gPublishSequence)
+        {
+            return ADC_ERR_OK;
+        }
+    }
+
+    return ADC_ERR_BUSY;
+}
+
 /**
  * @brief Initializes the DMA peripheral (DMA1) for use with the ADC block
  *
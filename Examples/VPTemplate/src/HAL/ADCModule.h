@@ -10,6 +10,24 @@
  *
  * @brief Header File for the ADC Service Layer Module
  *
+ * @details TIM3 triggers a conversion sequence of all channels at
+ * ADC_TRIGGER_FREQUENCY. The DMA writes the sequences into two halves of a
+ * buffer, each half holds a block of ADC_BLOCK_SEQUENCES sequences. When a
+ * block is complete, it is published together with a sequence number and
+ * a time stamp (seqlock) and the conversion callback is called once per
+ * block: adcGetBlock() returns all sequences of the block for filtering,
+ * adcGetSnapshot() only the latest sequence. The sequence numbers tell the
+ * consumer whether the data is new or sequences have been skipped.
+ *
+ * The consumer has to copy a block within one block period.
+ *
+ * The sampling times, the hardware oversampling, the trigger rate and the
+ * decimation of each channel are defined by a profile (ADCProfile_t),
+ * which can be switched at runtime. The raw values are always scaled to
+ * 16 bit (65536 digits = 3.3 V), independent of the oversampling. Channels
+ * which change slowly (temperature, VBAT) are averaged over many blocks by
+ * the decimation and read with adcGetChannelValue().
+ *
  *
  *****************************************************************************/
 #ifndef _ADC_MODULE_H
@@ -25,6 +43,19 @@
 /***** MACROS ****************************************************************/
 #define ADC_ERR_OK                  0               //!< No error occured
 #define ADC_ERR_INIT_FAILURE        -1              //!< Error during ADC initialization
+#define ADC_ERR_NO_DATA             -2              //!< No conversion sequence completed yet
+#define ADC_ERR_BUSY                -3              //!< Snapshot overwritten while copying, retry limit reached
+#define ADC_ERR_INVALID_PARAM       -4              //!< Invalid profile (e.g. the sequence doesn't fit into the trigger period)
+
+#define ADC_CHANNEL_COUNT           5               //!< Total number of used ADC channels
+
+#ifndef ADC_TRIGGER_FREQUENCY
+#define ADC_TRIGGER_FREQUENCY       1000            //!< Conversion sequences per second of the standard profile [Hz]
+#endif
+
+#ifndef ADC_BLOCK_SEQUENCES
+#define ADC_BLOCK_SEQUENCES         10              //!< Conversion sequences per block (half of the DMA buffer)
+#endif
 
 /***** TYPES *****************************************************************/
 
@@ -41,16 +72,178 @@ typedef enum _ADC_Channel_
     ADC_VREF                //!< ADC Channel 4 used for internal reference voltage
 } ADC_Channel_t;
 
+/**
+ * @brief Sampling time of a channel in ADC clock cycles, the conversion
+ * adds 12.5 cycles
+ *
+ */
+typedef enum _ADC_SampleTime_
+{
+    ADC_SAMPLE_2_5,         //!< 2.5 cycles
+    ADC_SAMPLE_6_5,         //!< 6.5 cycles
+    ADC_SAMPLE_12_5,        //!< 12.5 cycles
+    ADC_SAMPLE_24_5,        //!< 24.5 cycles
+    ADC_SAMPLE_47_5,        //!< 47.5 cycles
+    ADC_SAMPLE_92_5,        //!< 92.5 cycles
+    ADC_SAMPLE_247_5,       //!< 247.5 cycles, minimum for the internal channels (5 µs)
+    ADC_SAMPLE_640_5,       //!< 640.5 cycles
+    ADC_SAMPLE_COUNT        //!< Number of sampling times
+} ADC_SampleTime_t;
+
+/**
+ * @brief Configuration of a channel within a profile
+ *
+ */
+typedef struct _ADCChannelConfig
+{
+    ADC_SampleTime_t sampleTime;            //!< Sampling time of the channel
+    uint16_t decimation;                    //!< Number of blocks averaged into one value of adcGetChannelValue() (0 or 1: every block)
+} ADCChannelConfig_t;
+
+/**
+ * @brief Acquisition profile of the ADC
+ *
+ */
+typedef struct _ADCProfile
+{
+    const char* pName;                      //!< Name of the profile for the log output
+    uint32_t triggerFrequency;              //!< Conversion sequences per second [Hz]
+    uint8_t oversamplingExponent;           //!< Hardware oversampling ratio 2^n: 0 (off) or 4 to 8 (16 to 256)
+    ADCChannelConfig_t channels[ADC_CHANNEL_COUNT];     //!< Configuration of the channels, indexed by ADC_Channel_t
+} ADCProfile_t;
+
+/**
+ * @brief Decimated value of a channel
+ *
+ */
+typedef struct _ADCChannelValue
+{
+    uint16_t value;                         //!< Average over the decimation period in digits
+    uint16_t count;                         //!< Number of the value, changes with every new value (wraps around, never 0)
+} ADCChannelValue_t;
+
+/**
+ * @brief Function pointer for the callback at the end of every conversion
+ * sequence
+ *
+ * @remark: The callback is called from the DMA interrupt
+ *
+ */
+typedef void (*ADCConversionCallback)(void);
+
+/**
+ * @brief Consistent set of all channels of one conversion sequence
+ *
+ */
+typedef struct _ADCSnapshot
+{
+    uint32_t sequence;                      //!< Number of the conversion sequence, 1 for the first one
+    uint32_t timestamp;                     //!< HAL tick when the sequence was complete [ms]
+    uint16_t values[ADC_CHANNEL_COUNT];     //!< Raw values in digits, indexed by ADC_Channel_t
+} ADCSnapshot_t;
+
+/**
+ * @brief Consistent copy of all conversion sequences of one block
+ *
+ */
+typedef struct _ADCBlock
+{
+    uint32_t sequence;                      //!< Number of the first conversion sequence of the block, 1 for the first one
+    uint32_t timestamp;                     //!< HAL tick when the block was complete [ms]
+    uint16_t values[ADC_BLOCK_SEQUENCES][ADC_CHANNEL_COUNT];    //!< Raw values in digits, [sequence][ADC_Channel_t]
+} ADCBlock_t;
+
 
 /***** PROTOTYPES ************************************************************/
 
+extern const ADCProfile_t gADCProfileStandard;          //!< Sensors at ADC_TRIGGER_FREQUENCY, internal channels at 1 Hz (used by adcInitialize())
+extern const ADCProfile_t gADCProfileLowPower;          //!< Sensors at 100 Hz with short sampling times
+extern const ADCProfile_t gADCProfileHighResolution;    //!< Sensors with 16 times hardware oversampling
+
 /**
- * @brief Initialize the ADC peripheral block
+ * @brief Initialize the ADC peripheral block with the standard profile
  *
  * @return Returns ADC_ERR_OK if no error occured
  */
 int32_t adcInitialize();
 
+/**
+ * @brief Switches to another acquisition profile. The acquisition is
+ * stopped, reconfigured and restarted, the block being converted is lost
+ * and the decimation restarts. The sequence numbers continue.
+ *
+ * @param pProfile Pointer to the profile, has to stay valid while active
+ *
+ * @return Returns ADC_ERR_OK if no error occured, ADC_ERR_INVALID_PARAM if
+ * the profile is invalid (the active profile stays unchanged)
+ */
+int32_t adcSetProfile(const ADCProfile_t* pProfile);
+
+/**
+ * @brief Returns the active acquisition profile
+ *
+ * @return Pointer to the active profile
+ */
+const ADCProfile_t* adcGetProfile();
+
+/**
+ * @brief Reads the decimated value of a channel, the average over the
+ * decimation period of the channel in the active profile
+ *
+ * @param adcChannel ADC channel
+ * @param pValue     Pointer to the struct which receives the value
+ *
+ * @return Returns ADC_ERR_OK if a value was read, ADC_ERR_NO_DATA if the
+ * first decimation period hasn't completed yet
+ */
+int32_t adcGetChannelValue(ADC_Channel_t adcChannel, ADCChannelValue_t* pValue);
+
+/**
+ * @brief Registers the callback which is called from the DMA interrupt
+ * after every complete block (ADC_BLOCK_SEQUENCES conversion sequences)
+ *
+ * @param callback Callback function (0 to unregister)
+ *
+ * @return Returns ADC_ERR_OK if no error occured
+ */
+int32_t adcRegisterConversionCallback(ADCConversionCallback callback);
+
+/**
+ * @brief Copies the channels of the latest complete conversion sequence.
+ * A frame is new if its sequence number differs from the last one read,
+ * a difference of more than one means skipped frames.
+ *
+ * @param pSnapshot Pointer to the snapshot which receives the values
+ *
+ * @return Returns ADC_ERR_OK if a snapshot was copied, ADC_ERR_NO_DATA if no
+ * sequence completed yet (the snapshot is zeroed), ADC_ERR_BUSY if the
+ * snapshot was overwritten during every retry
+ */
+int32_t adcGetSnapshot(ADCSnapshot_t* pSnapshot);
+
+/**
+ * @brief Copies all conversion sequences of the latest complete block.
+ * The block is new if its sequence number differs from the last one read,
+ * sequences have been skipped if it is not the successor of the last
+ * sequence of the previous block.
+ *
+ * @param pBlock Pointer to the block which receives the values
+ *
+ * @return Returns ADC_ERR_OK if a block was copied, ADC_ERR_NO_DATA if no
+ * block completed yet (the block is zeroed), ADC_ERR_BUSY if the block was
+ * overwritten during every retry
+ */
+int32_t adcGetBlock(ADCBlock_t* pBlock);
+
+/**
+ * @brief Converts a raw value to microvolt
+ *
+ * @param rawValue Raw value in digits
+ *
+ * @return Returns the voltage in microvolt [µV]
+ */
+int32_t adcConvertToMicrovolt(int32_t rawValue);
+
 /**
  * @brief Reads an ADC channel by returning the global ADC value read via
  * interrupt and DMA and converts it to millivolt
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * @file ADCProfiles.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Acquisition profiles of the ADC
+ *
+ * @details The profiles only depend on ADCModule.h, so the host simulator
+ * links the same profiles as the firmware.
+ *
+ *
+ *****************************************************************************/
+
+/***** INCLUDES **************************************************************/
+#include "ADCModule.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+
+
+/***** PUBLIC VARIABLES ******************************************************/
+
+const ADCProfile_t gADCProfileStandard = {
+    .pName = "standard",
+    .triggerFrequency = ADC_TRIGGER_FREQUENCY,
+    .oversamplingExponent = 0,
+    .channels = {
+        [ADC_INPUT0]    = { ADC_SAMPLE_92_5,    1 },
+        [ADC_INPUT1]    = { ADC_SAMPLE_92_5,    1 },
+        [ADC_TEMP]      = { ADC_SAMPLE_247_5,   ADC_TRIGGER_FREQUENCY / ADC_BLOCK_SEQUENCES },
+        [ADC_VBAT]      = { ADC_SAMPLE_247_5,   ADC_TRIGGER_FREQUENCY / ADC_BLOCK_SEQUENCES },
+        [ADC_VREF]      = { ADC_SAMPLE_247_5,   10 },
+    },
+};
+
+const ADCProfile_t gADCProfileLowPower = {
+    .pName = "low power",
+    .triggerFrequency = 100,
+    .oversamplingExponent = 0,
+    .channels = {
+        [ADC_INPUT0]    = { ADC_SAMPLE_24_5,    1 },
+        [ADC_INPUT1]    = { ADC_SAMPLE_24_5,    1 },
+        [ADC_TEMP]      = { ADC_SAMPLE_247_5,   100 / ADC_BLOCK_SEQUENCES },
+        [ADC_VBAT]      = { ADC_SAMPLE_247_5,   100 / ADC_BLOCK_SEQUENCES },
+        [ADC_VREF]      = { ADC_SAMPLE_247_5,   1 },
+    },
+};
+
+const ADCProfile_t gADCProfileHighResolution = {
+    .pName = "high resolution",
+    .triggerFrequency = ADC_TRIGGER_FREQUENCY,
+    .oversamplingExponent = 4,
+    .channels = {
+        [ADC_INPUT0]    = { ADC_SAMPLE_92_5,    1 },
+        [ADC_INPUT1]    = { ADC_SAMPLE_92_5,    1 },
+        [ADC_TEMP]      = { ADC_SAMPLE_247_5,   ADC_TRIGGER_FREQUENCY / ADC_BLOCK_SEQUENCES },
+        [ADC_VBAT]      = { ADC_SAMPLE_247_5,   ADC_TRIGGER_FREQUENCY / ADC_BLOCK_SEQUENCES },
+        [ADC_VREF]      = { ADC_SAMPLE_247_5,   10 },
+    },
+};
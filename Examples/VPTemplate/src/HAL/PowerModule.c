@@ -0,0 +1,253 @@
+/******************************************************************************
+ * @file PowerModule.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Implementation of the Power Module (tickless idle)
+ *
+ * @details Sleep mode is used instead of Stop mode, because TIM3 and the
+ * ADC/DMA chain keep sampling the sensors while the core sleeps. The
+ * SysTick counter keeps running while its interrupt is suspended, so the
+ * number of ticks which passed during sleep can be derived exactly from
+ * the SysTick counter value and the TIM2 microsecond counter.
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include "stm32g4xx_hal.h"
+
+#include "System.h"
+#include "PowerModule.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define POWER_TIMER_FREQUENCY       1000000     //!< TIM2 runs with 1 MHz (1 µs resolution)
+#define POWER_MIN_SLEEP_US          20          //!< Sleep periods below this value are skipped
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+
+/**
+ * @brief Adds the time since the last call to the total time of the statistics
+ *
+ * @remark: Must be called with interrupts disabled
+ */
+static void powerUpdateTotalTime(void);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static TIM_HandleTypeDef gTimer2Handle;         //!< Global handle for Timer 2 (TIM2) used as wake-up timer
+static uint32_t gCyclesPerMicrosecond = 1;      //!< Core clock cycles per microsecond
+static uint32_t gLastTimerCount = 0;            //!< TIM2 counter value of the last statistics update
+static PowerIdleStatistics_t gIdleStatistics;   //!< Idle statistics
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int32_t powerInitialize()
+{
+    TIM_OC_InitTypeDef sConfigOC = {0};
+
+    /* TIM2 is a 32 bit timer, running with 1 MHz it overflows every ~71 minutes */
+    gTimer2Handle.Instance                  = TIM2;
+    gTimer2Handle.Init.Prescaler            = (HAL_RCC_GetPCLK1Freq() / POWER_TIMER_FREQUENCY) - 1;
+    gTimer2Handle.Init.CounterMode          = TIM_COUNTERMODE_UP;
+    gTimer2Handle.Init.Period               = 0xFFFFFFFF;
+    gTimer2Handle.Init.ClockDivision        = TIM_CLOCKDIVISION_DIV1;
+    gTimer2Handle.Init.AutoReloadPreload    = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+    if (HAL_TIM_OC_Init(&gTimer2Handle) != HAL_OK)
+    {
+        return POWER_ERR_INIT_FAILURE;
+    }
+
+    sConfigOC.OCMode        = TIM_OCMODE_TIMING;
+    sConfigOC.Pulse         = 0;
+    sConfigOC.OCPolarity    = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCFastMode    = TIM_OCFAST_DISABLE;
+
+    if (HAL_TIM_OC_ConfigChannel(&gTimer2Handle, &sConfigOC, TIM_CHANNEL_1) != HAL_OK)
+    {
+        return POWER_ERR_INIT_FAILURE;
+    }
+
+    // The compare interrupt is only enabled while sleeping
+    if (HAL_TIM_OC_Start(&gTimer2Handle, TIM_CHANNEL_1) != HAL_OK)
+    {
+        return POWER_ERR_INIT_FAILURE;
+    }
+
+    gCyclesPerMicrosecond = SystemCoreClock / POWER_TIMER_FREQUENCY;
+
+    powerResetIdleStatistics();
+
+    return POWER_ERR_OK;
+}
+
+void powerEnterIdle(uint32_t ticks)
+{
+    if (ticks == 0)
+    {
+        return;
+    }
+    if (ticks > POWER_MAX_IDLE_TICKS)
+    {
+        ticks = POWER_MAX_IDLE_TICKS;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t cyclesPerTick = SysTick->LOAD + 1;
+    uint32_t startCount = TIM2->CNT;
+    uint32_t startValue = SysTick->VAL;
+
+    // The release is due with the SysTick underflow after (ticks - 1) further full periods
+    uint32_t sleepMicroseconds = (startValue + (ticks - 1) * cyclesPerTick) / gCyclesPerMicrosecond;
+
+    if (sleepMicroseconds < POWER_MIN_SLEEP_US)
+    {
+        __set_PRIMASK(primask);
+        return;
+    }
+
+    HAL_SuspendTick();
+
+    TIM2->CCR1 = startCount + sleepMicroseconds;
+    TIM2->SR = (uint32_t) ~TIM_SR_CC1IF;
+    TIM2->DIER |= TIM_DIER_CC1IE;
+
+    // WFI also returns with PRIMASK set, the pending interrupt is handled
+    // after the tick has been corrected
+    HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+
+    TIM2->DIER &= ~TIM_DIER_CC1IE;
+    TIM2->SR = (uint32_t) ~TIM_SR_CC1IF;
+    NVIC_ClearPendingIRQ(TIM2_IRQn);
+
+    uint32_t endValue = SysTick->VAL;
+    uint32_t elapsedMicroseconds = TIM2->CNT - startCount;
+
+    // The SysTick counter gives the elapsed cycles modulo one tick exactly,
+    // TIM2 resolves the number of full tick periods
+    uint32_t fraction = (startValue >= endValue) ? (startValue - endValue) : (startValue + cyclesPerTick - endValue);
+    int32_t fullPeriods = ((int32_t) (elapsedMicroseconds * gCyclesPerMicrosecond) - (int32_t) fraction + (int32_t) (cyclesPerTick / 2)) / (int32_t) cyclesPerTick;
+    if (fullPeriods < 0)
+    {
+        fullPeriods = 0;
+    }
+
+    // Every reload of the SysTick counter is a missed tick
+    uint32_t missedTicks = (uint32_t) fullPeriods + ((endValue > startValue) ? 1 : 0);
+    uwTick += missedTicks * uwTickFreq;
+
+    HAL_ResumeTick();
+
+    // A reload between reading the counter and resuming the interrupt would be lost
+    if (SysTick->VAL > endValue && (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) == 0)
+    {
+        uwTick += uwTickFreq;
+    }
+
+    gIdleStatistics.idleMicroseconds += elapsedMicroseconds;
+    gIdleStatistics.sleepCount++;
+    powerUpdateTotalTime();
+
+    __set_PRIMASK(primask);
+}
+
+int32_t powerGetIdleStatistics(PowerIdleStatistics_t* pStatistics)
+{
+    if (pStatistics == 0)
+    {
+        return POWER_ERR_INVALID_PTR;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    powerUpdateTotalTime();
+    *pStatistics = gIdleStatistics;
+
+    __set_PRIMASK(primask);
+
+    pStatistics->idleRatioPermille = 0;
+    if (pStatistics->totalMicroseconds > 0)
+    {
+        pStatistics->idleRatioPermille = (uint32_t) ((pStatistics->idleMicroseconds * 1000) / pStatistics->totalMicroseconds);
+    }
+
+    return POWER_ERR_OK;
+}
+
+void powerResetIdleStatistics()
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    gIdleStatistics.idleMicroseconds = 0;
+    gIdleStatistics.totalMicroseconds = 0;
+    gIdleStatistics.sleepCount = 0;
+    gIdleStatistics.idleRatioPermille = 0;
+    gLastTimerCount = TIM2->CNT;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+* @brief TIM_OC MSP Initialization
+* This function configures the hardware resources used for the wake-up timer
+*
+* @param htim: TIM_OC handle pointer
+*
+* @remark: this HAL_TIM_OC_MspInit function is called automatically by the
+* STM32 HAL library
+*/
+void HAL_TIM_OC_MspInit(TIM_HandleTypeDef* htim)
+{
+    if(htim->Instance==TIM2)
+    {
+        /* Peripheral clock enable */
+        __HAL_RCC_TIM2_CLK_ENABLE();
+
+        /* TIM2 interrupt Init */
+        HAL_NVIC_SetPriority(TIM2_IRQn, 2, 0);
+        HAL_NVIC_EnableIRQ(TIM2_IRQn);
+    }
+}
+
+/**
+  * @brief This function handles TIM2 global interrupt (wake-up timer).
+  */
+void TIM2_IRQHandler(void)
+{
+    if ((TIM2->SR & TIM_SR_CC1IF) != 0)
+    {
+        TIM2->SR = (uint32_t) ~TIM_SR_CC1IF;
+        TIM2->DIER &= ~TIM_DIER_CC1IE;
+    }
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+static void powerUpdateTotalTime(void)
+{
+    uint32_t timerCount = TIM2->CNT;
+
+    gIdleStatistics.totalMicroseconds += timerCount - gLastTimerCount;
+    gLastTimerCount = timerCount;
+}
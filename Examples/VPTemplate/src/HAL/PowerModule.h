@@ -0,0 +1,88 @@
+/******************************************************************************
+ * @file PowerModule.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Header file for the Power Module (tickless idle)
+ *
+ * @details The module puts the core into Sleep mode until the next task
+ * release of the scheduler. TIM2 is used as wake-up timer and as time base
+ * to correct the HAL tick for the time spent asleep.
+ *
+ *
+ *****************************************************************************/
+#ifndef _POWER_MODULE_H_
+#define _POWER_MODULE_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#define POWER_ERR_OK                  0         //!< No error occured
+#define POWER_ERR_INIT_FAILURE        -1        //!< Error during initialization
+#define POWER_ERR_INVALID_PTR         -2        //!< Invalid pointer
+
+#define POWER_MAX_IDLE_TICKS          1000      //!< Maximum number of ticks the core sleeps in one go
+
+
+/***** TYPES *****************************************************************/
+
+/**
+ * @brief Statistics about the time spent in idle (Sleep mode)
+ *
+ */
+typedef struct _PowerIdleStatistics
+{
+    uint64_t idleMicroseconds;      //!< Time spent in Sleep mode
+    uint64_t totalMicroseconds;     //!< Total time since the statistics were (re)started
+    uint32_t sleepCount;            //!< Number of times the core entered Sleep mode
+    uint32_t idleRatioPermille;     //!< Ratio idle / total time in per mille
+} PowerIdleStatistics_t;
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Initializes the wake-up timer (TIM2) used for the tickless idle
+ *
+ * @return Returns POWER_ERR_OK if no error occured, otherwise POWER_ERR_INIT_FAILURE
+ */
+int32_t powerInitialize();
+
+/**
+ * @brief Puts the core into Sleep mode for the given number of HAL ticks
+ *
+ * The SysTick interrupt is suspended while sleeping and the HAL tick is
+ * corrected afterwards for the ticks which passed. Any enabled interrupt
+ * (ADC, DMA, UART, TIM3, ...) wakes the core up earlier, the function then
+ * returns after the interrupt has been handled.
+ *
+ * @remark: The signature matches the IdleFunction of the scheduler
+ *
+ * @param ticks Number of ticks until the next task release
+ */
+void powerEnterIdle(uint32_t ticks);
+
+/**
+ * @brief Returns the idle statistics
+ *
+ * @param pStatistics Pointer to the struct which receives the statistics
+ *
+ * @return Returns POWER_ERR_OK if no error occured
+ */
+int32_t powerGetIdleStatistics(PowerIdleStatistics_t* pStatistics);
+
+/**
+ * @brief Restarts the idle statistics
+ */
+void powerResetIdleStatistics();
+
+#endif
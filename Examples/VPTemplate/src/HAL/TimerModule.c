@@ -27,6 +27,7 @@
 
 
 /***** PRIVATE MACROS ********************************************************/
+#define TIMER3_MAX_PERIOD           65536       //!< TIM3 is a 16 bit timer
 
 
 /***** PRIVATE TYPES *********************************************************/
@@ -78,11 +79,57 @@ int32_t timerInitialize()
         return TIMER_ERR_INIT_FAILURE;
     }
 
-    HAL_TIM_Base_Start_IT(&gTimer3Handle);
+    // Only the trigger output (TRGO) is used, the update interrupt would
+    // cost a context switch per ADC conversion sequence
+    HAL_TIM_Base_Start(&gTimer3Handle);
 
     return TIMER_ERR_OK;
 }
 
+int32_t timerSetTriggerFrequency(uint32_t frequency)
+{
+    uint32_t timerClock = HAL_RCC_GetPCLK1Freq();
+    if (frequency == 0 || frequency > timerClock / 2)
+    {
+        return TIMER_ERR_INVALID_PARAM;
+    }
+
+    // Smallest prescaler which fits the period into 16 bit, this keeps the
+    // resolution of the period as high as possible
+    uint32_t ticks = timerClock / frequency;
+    uint32_t prescaler = (ticks - 1) / TIMER3_MAX_PERIOD + 1;
+    uint32_t period = ticks / prescaler;
+
+    gTimer3Handle.Init.Prescaler    = prescaler - 1;
+    gTimer3Handle.Init.Period       = period - 1;
+
+    __HAL_TIM_SET_PRESCALER(&gTimer3Handle, gTimer3Handle.Init.Prescaler);
+    __HAL_TIM_SET_AUTORELOAD(&gTimer3Handle, gTimer3Handle.Init.Period);
+
+    return TIMER_ERR_OK;
+}
+
+int32_t timerInitializeCycleCounter()
+{
+    // The DWT unit is only accessible when the trace is enabled
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    if ((DWT->CTRL & DWT_CTRL_NOCYCCNT_Msk) != 0)
+    {
+        return TIMER_ERR_INIT_FAILURE;
+    }
+
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return TIMER_ERR_OK;
+}
+
+uint32_t timerGetCycleCount()
+{
+    return DWT->CYCCNT;
+}
+
 /**
 * @brief TIM_Base MSP Initialization
 * This function configures the hardware resources used in this example
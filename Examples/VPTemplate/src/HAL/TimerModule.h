@@ -26,6 +26,7 @@
 /***** MACROS ****************************************************************/
 #define TIMER_ERR_OK                  0         //!< No error occured
 #define TIMER_ERR_INIT_FAILURE        -1        //!< Error during timer initialization
+#define TIMER_ERR_INVALID_PARAM       -2        //!< Invalid parameter (e.g. frequency out of range)
 
 
 /***** TYPES *****************************************************************/
@@ -40,4 +41,32 @@
  */
 int32_t timerInitialize();
 
+/**
+ * @brief Sets the rate of the ADC trigger (TIM3 update event). The new
+ * rate applies from the next trigger on.
+ *
+ * @param frequency Trigger frequency [Hz], the timer resolution limits
+ * the accuracy at high rates
+ *
+ * @return Returns TIMER_ERR_OK if no error occured, otherwise
+ * TIMER_ERR_INVALID_PARAM if the frequency is 0 or above half the timer clock
+ */
+int32_t timerSetTriggerFrequency(uint32_t frequency);
+
+/**
+ * @brief Enables the DWT cycle counter of the core, which is used
+ * for execution time measurements
+ *
+ * @return Returns TIMER_ERR_OK if no error occured, otherwiese TIMER_ERR_INIT_FAILURE
+ * if the core does not implement the cycle counter
+ */
+int32_t timerInitializeCycleCounter();
+
+/**
+ * @brief Returns the current value of the DWT cycle counter (core clock cycles)
+ *
+ * @return Current cycle count, wraps around after 2^32 cycles
+ */
+uint32_t timerGetCycleCount();
+
 #endif
@@ -21,10 +21,19 @@
 #include "HardwareConfig.h"
 #include "UARTModule.h"
 
+#include <stdbool.h>
+#include <string.h>
+
 /***** PRIVATE CONSTANTS *****************************************************/
 
 
 /***** PRIVATE MACROS ********************************************************/
+#define UART_TX_BUFFER_MASK         (UART_TX_BUFFER_SIZE - 1)       //!< Mask to map the free running indices into the ring buffer
+#define UART_MAX_DMA_CHUNK          0xFFFF                          //!< Maximum number of bytes per DMA transfer
+
+#if (UART_TX_BUFFER_SIZE & UART_TX_BUFFER_MASK) != 0
+#error "UART_TX_BUFFER_SIZE must be a power of 2"
+#endif
 
 
 /***** PRIVATE TYPES *********************************************************/
@@ -32,9 +41,58 @@
 
 /***** PRIVATE PROTOTYPES ****************************************************/
 
+/**
+ * @brief Initializes the DMA channel (DMA1 Channel 2) used for the TX path
+ *
+ */
+static void uartInitializeDMA(void);
+
+/**
+ * @brief Starts the next DMA transfer if the DMA is idle and data is pending
+ *
+ * @remark: Must be called with interrupts disabled
+ */
+static void uartStartNextTransfer(void);
+
+/**
+ * @brief Removes the oldest bytes which are not yet handed over to the DMA
+ *
+ * @param byteCount Number of bytes to drop
+ *
+ * @return Number of bytes which were actually dropped
+ *
+ * @remark: Must be called with interrupts disabled
+ */
+static uint32_t uartDropOldest(uint32_t byteCount);
+
+/**
+ * @brief Copies data into the ring buffer, the caller has to make sure
+ * that there is enough free space
+ *
+ * @remark: Must be called with interrupts disabled
+ */
+static void uartCopyToRing(const uint8_t* pData, uint32_t length);
+
 
 /***** PRIVATE VARIABLES *****************************************************/
 static UART_HandleTypeDef gUARTHandle;     //!< Global handle for UART 2
+static DMA_HandleTypeDef gDMA_UART_TX_Handle;   //!< Global handle for DMA channel used for the UART TX path
+
+static uint8_t gTxBuffer[UART_TX_BUFFER_SIZE];  //!< TX ring buffer drained by DMA
+
+/*
+ * The indices are free running and only mapped into the buffer with
+ * UART_TX_BUFFER_MASK. Bytes in [tail, dmaEnd) are owned by the DMA,
+ * bytes in [dmaEnd, head) are queued but not yet handed to the DMA.
+ */
+static volatile uint32_t gTxHead = 0;           //!< Write index (next free byte)
+static volatile uint32_t gTxTail = 0;           //!< Read index (oldest byte which is not released yet)
+static volatile uint32_t gTxDmaStart = 0;       //!< Start index of the DMA transfer in flight
+static volatile uint32_t gTxDmaEnd = 0;         //!< End index of the DMA transfer in flight
+static volatile bool gTxDmaActive = false;      //!< Flag whether a DMA transfer is in flight
+
+static UART_OverflowPolicy_t gOverflowPolicy = UART_OVERFLOW_DROP_NEWEST;  //!< Active overflow policy
+static UART_TxStatistics_t gTxStatistics;       //!< Statistics of the TX path
 
 /***** PUBLIC FUNCTIONS ******************************************************/
 
@@ -59,6 +117,9 @@ int32_t uartInitialize(uint32_t baudrate)
 
     __HAL_RCC_GPIOA_CLK_ENABLE();
 
+    /* Initialize DMA block for the TX path */
+    uartInitializeDMA();
+
     /**LPUART1 GPIO Configuration
      PA2     ------> LPUART1_TX
      PA3     ------> LPUART1_RX
@@ -75,7 +136,7 @@ int32_t uartInitialize(uint32_t baudrate)
      PA3     ------> USART2_RX
      */
     gUARTHandle.Instance = LPUART1;
-    gUARTHandle.Init.BaudRate = 115200;
+    gUARTHandle.Init.BaudRate = baudrate;
     gUARTHandle.Init.WordLength = UART_WORDLENGTH_8B;
     gUARTHandle.Init.StopBits = UART_STOPBITS_1;
     gUARTHandle.Init.Parity = UART_PARITY_NONE;
@@ -105,6 +166,12 @@ int32_t uartInitialize(uint32_t baudrate)
         Error_Handler();
     }
 
+    __HAL_LINKDMA(&gUARTHandle, hdmatx, gDMA_UART_TX_Handle);
+
+    /* LPUART1 interrupt is needed to signal the end of a DMA transmission */
+    HAL_NVIC_SetPriority(LPUART1_IRQn, 3, 0);
+    HAL_NVIC_EnableIRQ(LPUART1_IRQn);
+
     return result;
 }
 
@@ -112,14 +179,291 @@ int32_t uartSendData(uint8_t* pDataBuffer, int32_t bufferLength)
 {
     int32_t result = UART_ERR_OK;
 
-    HAL_StatusTypeDef halStatus = HAL_UART_Transmit(&gUARTHandle, pDataBuffer, bufferLength, HAL_MAX_DELAY);
+    if (pDataBuffer == 0 || bufferLength < 0)
+    {
+        return UART_ERR_INVALID_PARAM;
+    }
+
+    uint32_t remaining = (uint32_t) bufferLength;
+    uint32_t dropped = 0;
+
+    // Blocking is only possible if the DMA interrupts can still preempt the caller
+    bool mayBlock = (gOverflowPolicy == UART_OVERFLOW_BLOCK) && (__get_PRIMASK() == 0) && (__get_IPSR() == 0);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t freeBytes = UART_TX_BUFFER_SIZE - (gTxHead - gTxTail);
+
+    if (remaining > freeBytes)
+    {
+        if (gOverflowPolicy == UART_OVERFLOW_DROP_OLDEST)
+        {
+            dropped = uartDropOldest(remaining - freeBytes);
+            freeBytes += dropped;
+
+            // If the message is still too big, only the newest part of it is kept
+            if (remaining > freeBytes)
+            {
+                dropped += remaining - freeBytes;
+                pDataBuffer += remaining - freeBytes;
+                remaining = freeBytes;
+            }
+        }
+        else if (mayBlock == false)
+        {
+            dropped = remaining;
+            remaining = 0;
+        }
+    }
+
+    while (remaining > 0)
+    {
+        uint32_t chunk = UART_TX_BUFFER_SIZE - (gTxHead - gTxTail);
+        if (chunk > remaining)
+        {
+            chunk = remaining;
+        }
+
+        uartCopyToRing(pDataBuffer, chunk);
+        pDataBuffer += chunk;
+        remaining -= chunk;
+
+        uartStartNextTransfer();
+
+        if (remaining > 0)
+        {
+            // Let the DMA interrupts free some space before continuing
+            __set_PRIMASK(primask);
+            while ((gTxHead - gTxTail) == UART_TX_BUFFER_SIZE)
+            {
+            }
+            __disable_irq();
+        }
+    }
 
-    if (halStatus != HAL_OK )
+    if (dropped > 0)
     {
-        result = UART_ERR_TRANSMIT;
+        gTxStatistics.droppedBytes += dropped;
+        gTxStatistics.droppedMessages++;
+        result = UART_ERR_OVERFLOW;
     }
 
+    __set_PRIMASK(primask);
+
     return result;
 }
 
+int32_t uartSetOverflowPolicy(UART_OverflowPolicy_t policy)
+{
+    if (policy != UART_OVERFLOW_DROP_NEWEST && policy != UART_OVERFLOW_DROP_OLDEST && policy != UART_OVERFLOW_BLOCK)
+    {
+        return UART_ERR_INVALID_PARAM;
+    }
+
+    gOverflowPolicy = policy;
+
+    return UART_ERR_OK;
+}
+
+int32_t uartGetTxStatistics(UART_TxStatistics_t* pStatistics)
+{
+    if (pStatistics == 0)
+    {
+        return UART_ERR_INVALID_PARAM;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *pStatistics = gTxStatistics;
+    __set_PRIMASK(primask);
+
+    return UART_ERR_OK;
+}
+
+int32_t uartFlush(void)
+{
+    while (gTxHead != gTxTail)
+    {
+        // Restart the DMA in case a previous start attempt failed
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uartStartNextTransfer();
+        __set_PRIMASK(primask);
+    }
+
+    return UART_ERR_OK;
+}
+
+/**
+  * @brief Tx Half Transfer completed callback, releases the first half
+  * of the running DMA transfer so that new data can be queued earlier
+  *
+  * @remark: this callback is called automatically by the STM32 HAL library
+  */
+void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == LPUART1 && gTxDmaActive == true)
+    {
+        gTxTail = gTxDmaStart + (gTxDmaEnd - gTxDmaStart) / 2;
+    }
+}
+
+/**
+  * @brief Tx Transfer completed callback, releases the transmitted data
+  * and starts the next DMA transfer if further data is queued
+  *
+  * @remark: this callback is called automatically by the STM32 HAL library
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == LPUART1)
+    {
+        gTxTail = gTxDmaEnd;
+        gTxDmaActive = false;
+
+        uartStartNextTransfer();
+    }
+}
+
+/**
+  * @brief UART error callback, a failed DMA transfer is given up
+  *
+  * @remark: this callback is called automatically by the STM32 HAL library
+  */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == LPUART1 && gTxDmaActive == true && (huart->ErrorCode & HAL_UART_ERROR_DMA) != 0)
+    {
+        gTxStatistics.transmitErrors++;
+        gTxTail = gTxDmaEnd;
+        gTxDmaActive = false;
+
+        uartStartNextTransfer();
+    }
+}
+
+/**
+  * @brief This function handles DMA1 channel2 global interrupt (LPUART1 TX).
+  */
+void DMA1_Channel2_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&gDMA_UART_TX_Handle);
+}
+
+/**
+  * @brief This function handles LPUART1 global interrupt.
+  */
+void LPUART1_IRQHandler(void)
+{
+    HAL_UART_IRQHandler(&gUARTHandle);
+}
+
 /***** PRIVATE FUNCTIONS *****************************************************/
+
+static void uartInitializeDMA(void)
+{
+    /* DMA controller clock enable */
+    __HAL_RCC_DMAMUX1_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    gDMA_UART_TX_Handle.Instance                    = DMA1_Channel2;
+    gDMA_UART_TX_Handle.Init.Request                = DMA_REQUEST_LPUART1_TX;
+    gDMA_UART_TX_Handle.Init.Direction              = DMA_MEMORY_TO_PERIPH;
+    gDMA_UART_TX_Handle.Init.PeriphInc              = DMA_PINC_DISABLE;
+    gDMA_UART_TX_Handle.Init.MemInc                 = DMA_MINC_ENABLE;
+    gDMA_UART_TX_Handle.Init.PeriphDataAlignment    = DMA_PDATAALIGN_BYTE;
+    gDMA_UART_TX_Handle.Init.MemDataAlignment       = DMA_MDATAALIGN_BYTE;
+    gDMA_UART_TX_Handle.Init.Mode                   = DMA_NORMAL;
+    gDMA_UART_TX_Handle.Init.Priority               = DMA_PRIORITY_LOW;
+
+    if (HAL_DMA_Init(&gDMA_UART_TX_Handle) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    /* DMA1_Channel2_IRQn interrupt configuration */
+    HAL_NVIC_SetPriority(DMA1_Channel2_IRQn, 3, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+}
+
+static void uartStartNextTransfer(void)
+{
+    if (gTxDmaActive == true || gTxHead == gTxTail)
+    {
+        return;
+    }
+
+    // Only send the contiguous part up to the end of the buffer, the
+    // rest follows with the next transfer
+    uint32_t start = gTxTail;
+    uint32_t length = gTxHead - start;
+    uint32_t untilWrap = UART_TX_BUFFER_SIZE - (start & UART_TX_BUFFER_MASK);
+
+    if (length > untilWrap)
+    {
+        length = untilWrap;
+    }
+    if (length > UART_MAX_DMA_CHUNK)
+    {
+        length = UART_MAX_DMA_CHUNK;
+    }
+
+    gTxDmaStart = start;
+    gTxDmaEnd = start + length;
+    gTxDmaActive = true;
+
+    if (HAL_UART_Transmit_DMA(&gUARTHandle, &gTxBuffer[start & UART_TX_BUFFER_MASK], (uint16_t) length) != HAL_OK)
+    {
+        gTxDmaActive = false;
+        gTxDmaEnd = start;
+        gTxStatistics.transmitErrors++;
+    }
+}
+
+static uint32_t uartDropOldest(uint32_t byteCount)
+{
+    // Data owned by the DMA can't be dropped anymore
+    uint32_t pendingStart = (gTxDmaActive == true) ? gTxDmaEnd : gTxTail;
+    uint32_t pendingCount = gTxHead - pendingStart;
+
+    if (byteCount > pendingCount)
+    {
+        byteCount = pendingCount;
+    }
+
+    if (gTxDmaActive == false)
+    {
+        gTxTail += byteCount;
+    }
+    else
+    {
+        // Move the kept bytes down so that they directly follow the transfer in flight
+        for (uint32_t src = pendingStart + byteCount; src != gTxHead; src++)
+        {
+            gTxBuffer[(src - byteCount) & UART_TX_BUFFER_MASK] = gTxBuffer[src & UART_TX_BUFFER_MASK];
+        }
+        gTxHead -= byteCount;
+    }
+
+    return byteCount;
+}
+
+static void uartCopyToRing(const uint8_t* pData, uint32_t length)
+{
+    uint32_t offset = gTxHead & UART_TX_BUFFER_MASK;
+    uint32_t untilWrap = UART_TX_BUFFER_SIZE - offset;
+    uint32_t firstPart = (length < untilWrap) ? length : untilWrap;
+
+    memcpy(&gTxBuffer[offset], pData, firstPart);
+    memcpy(&gTxBuffer[0], pData + firstPart, length - firstPart);
+
+    gTxHead += length;
+    gTxStatistics.queuedBytes += length;
+
+    uint32_t fillLevel = gTxHead - gTxTail;
+    if (fillLevel > gTxStatistics.highWatermark)
+    {
+        gTxStatistics.highWatermark = fillLevel;
+    }
+}
@@ -25,10 +25,40 @@
 #define UART_ERR_OK                  0          //!< No error occured
 #define UART_ERR_INIT_FAILURE        -1         //!< Error during UART initialization
 #define UART_ERR_TRANSMIT            -2         //!< Error during UART tranmission
+#define UART_ERR_OVERFLOW            -3         //!< TX ring buffer full, (parts of) the data were dropped
+#define UART_ERR_INVALID_PARAM       -4         //!< Invalid parameter
+
+#define UART_TX_BUFFER_SIZE          1024       //!< Size of the TX ring buffer in bytes (must be a power of 2)
 
 
 /***** TYPES *****************************************************************/
 
+/**
+ * @brief Policy which is applied if a message doesn't fit into the TX
+ * ring buffer anymore
+ *
+ */
+typedef enum _UART_OverflowPolicy
+{
+    UART_OVERFLOW_DROP_NEWEST,      //!< Drop the complete new message, data already queued is kept
+    UART_OVERFLOW_DROP_OLDEST,      //!< Drop the oldest queued data (not yet handed to the DMA) to make room
+    UART_OVERFLOW_BLOCK             //!< Wait until the DMA has freed enough space (falls back to drop newest in ISR context)
+} UART_OverflowPolicy_t;
+
+/**
+ * @brief Statistics of the TX path
+ *
+ */
+typedef struct _UART_TxStatistics
+{
+    uint32_t queuedBytes;           //!< Total number of bytes accepted into the ring buffer
+    uint32_t droppedBytes;          //!< Total number of bytes dropped due to overflow
+    uint32_t droppedMessages;       //!< Number of calls to uartSendData() which lost (new or old) data
+    uint32_t highWatermark;         //!< Maximum fill level of the ring buffer in bytes
+    uint32_t transmitErrors;        //!< Number of DMA transfers which failed or could not be started
+} UART_TxStatistics_t;
+
+
 
 /***** PROTOTYPES ************************************************************/
 
@@ -48,11 +78,43 @@ int32_t uartInitialize(uint32_t baudrate);
 /**
  * @brief Sends data to the UART interface
  *
+ * The data is copied into the TX ring buffer and drained in the background
+ * by DMA, so the function returns without waiting for the transmission. The
+ * caller can reuse the buffer immediately after the call.
+ *
  * @param pDataBuffer Pointer to the data buffer which should be send out
  * @param bufferLength Length of the buffer (number of bytes) to send
  *
- * @return Returns UART_ERR_OK if no error occured, otherwise UART_ERR_TRANSMIT
+ * @return Returns UART_ERR_OK if no error occured, UART_ERR_OVERFLOW if data
+ * was dropped according to the overflow policy
  */
 int32_t uartSendData(uint8_t* pDataBuffer, int32_t bufferLength);
 
+/**
+ * @brief Sets the policy which is used if the TX ring buffer is full
+ *
+ * @param policy Overflow policy to use (default: UART_OVERFLOW_DROP_NEWEST)
+ *
+ * @return Returns UART_ERR_OK if no error occured, otherwise UART_ERR_INVALID_PARAM
+ */
+int32_t uartSetOverflowPolicy(UART_OverflowPolicy_t policy);
+
+/**
+ * @brief Returns a copy of the TX statistics (drop counters, high watermark)
+ *
+ * @param pStatistics Pointer to the struct which receives the statistics
+ *
+ * @return Returns UART_ERR_OK if no error occured, otherwise UART_ERR_INVALID_PARAM
+ */
+int32_t uartGetTxStatistics(UART_TxStatistics_t* pStatistics);
+
+/**
+ * @brief Blocks until all queued data has been sent out
+ *
+ * @remark: Must not be called with interrupts disabled
+ *
+ * @return Returns UART_ERR_OK if no error occured
+ */
+int32_t uartFlush(void);
+
 #endif
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * @file Coroutine.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Stackless coroutines (protothreads) resumed by the scheduler
+ *
+ * @details A coroutine is a function which returns at a CO_YIELD,
+ * CO_WAIT_UNTIL or CO_SLEEP_FOR and continues behind it when it is resumed
+ * by the scheduler the next time. The resume point is stored as line number
+ * in the Coroutine struct and the function body is one big switch statement,
+ * therefore no extra stack is needed. Long operations can be split into
+ * steps without hand written state machines:
+ *
+ * @code
+ * static CoroutineState coExample(Coroutine* pCo)
+ * {
+ *     CO_BEGIN(pCo);
+ *     while(true){
+ *         CO_SLEEP_FOR(pCo, 1000);
+ *         for(s_line = 0; s_line < LINE_COUNT; s_line++){
+ *             outputLine(s_line);
+ *             CO_YIELD(pCo);
+ *         }
+ *     }
+ *     CO_END(pCo);
+ * }
+ * @endcode
+ *
+ * @remark: Local variables are not preserved across CO_YIELD, CO_WAIT_UNTIL
+ * and CO_SLEEP_FOR, use static variables or a context struct instead. The
+ * macros must not be used inside a switch statement of the coroutine.
+ *
+ *
+ *****************************************************************************/
+#ifndef _COROUTINE_H_
+#define _COROUTINE_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+
+/**
+ * @brief Starts the body of a coroutine, continues at the last resume point
+ */
+#define CO_BEGIN(pCo)               switch((pCo)->line){ case 0:
+
+/**
+ * @brief Returns to the scheduler, the coroutine is resumed in the next
+ * schedCycle() call
+ */
+#define CO_YIELD(pCo)               do{ (pCo)->line = __LINE__; return CO_STATE_YIELDED; case __LINE__:; } while(0)
+
+/**
+ * @brief Returns to the scheduler until the condition is true, the
+ * condition is checked on every schedCycle() call
+ */
+#define CO_WAIT_UNTIL(pCo, cond)    do{ (pCo)->line = __LINE__; case __LINE__: if(!(cond)){ return CO_STATE_WAITING; } } while(0)
+
+/**
+ * @brief Returns to the scheduler for the given number of ticks
+ */
+#define CO_SLEEP_FOR(pCo, ticks)    do{ (pCo)->wakeTick = (pCo)->now + (ticks); (pCo)->line = __LINE__; case __LINE__: \
+                                        if((int32_t) ((pCo)->now - (pCo)->wakeTick) < 0){ return CO_STATE_SLEEPING; } } while(0)
+
+/**
+ * @brief Ends the body of a coroutine, the coroutine is not resumed any
+ * more until it is restarted with CO_RESTART
+ */
+#define CO_END(pCo)                 } (pCo)->line = 0; return CO_STATE_ENDED
+
+/**
+ * @brief Restarts a coroutine from the beginning (also after CO_END)
+ */
+#define CO_RESTART(pCo)             do{ (pCo)->line = 0; (pCo)->state = CO_STATE_YIELDED; } while(0)
+
+
+/***** TYPES *****************************************************************/
+
+/**
+ * @brief State of a coroutine after it returned to the scheduler
+ *
+ */
+typedef enum _CoroutineState
+{
+    CO_STATE_YIELDED = 0,       //!< Resume in the next cycle (prevents the idle function)
+    CO_STATE_WAITING,           //!< Waits for a condition, checked every cycle
+    CO_STATE_SLEEPING,          //!< Sleeps until wakeTick
+    CO_STATE_ENDED              //!< Finished, not resumed any more
+} CoroutineState;
+
+typedef struct _Coroutine Coroutine;
+
+/**
+ * @brief Function pointer for the body of a coroutine
+ *
+ */
+typedef CoroutineState (*CoroutineFunction)(Coroutine* pCo);
+
+/**
+ * @brief Coroutine control block
+ *
+ */
+struct _Coroutine
+{
+    uint32_t line;                      //!< Resume point (line number), 0 is the beginning
+    CoroutineState state;               //!< State after the last resume
+    uint32_t now;                       //!< Tick of the current resume, set by the scheduler
+    uint32_t wakeTick;                  //!< Wake up tick of CO_SLEEP_FOR
+    CoroutineFunction pFunction;        //!< Body of the coroutine
+    Coroutine* pNext;                   //!< Next coroutine in the list of the scheduler
+};
+
+
+/***** PROTOTYPES ************************************************************/
+
+
+#endif
@@ -0,0 +1,168 @@
+/******************************************************************************
+ * @file DeferredWork.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Implementation of the deferred work queues (bottom halves)
+ *
+ * @details The head and tail indices are free running, the number of queued
+ * items is head - tail. The producer fills the item before it publishes the
+ * new head, the consumer copies the item before it releases the slot with
+ * the new tail. The memory barriers keep this order for the other side.
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include "DeferredWork.h"
+
+#include "Critical.h"
+
+#include <string.h>
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define DEFERRED_WORK_INDEX_MASK        (DEFERRED_WORK_QUEUE_SIZE - 1)   //!< Mask to get the ring index
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int32_t deferredWorkInitQueue(DeferredWorkQueue* pQueue, uint8_t priority, GetTimestamp pGetTimestamp)
+{
+    if(pQueue == 0){
+        return DEFERRED_WORK_ERR_INVALID_PTR;
+    }
+
+    memset(pQueue, 0, sizeof(DeferredWorkQueue));
+    pQueue->priority = priority;
+    pQueue->pGetTimestamp = pGetTimestamp;
+
+    return DEFERRED_WORK_ERR_OK;
+}
+
+int32_t deferredWorkPost(DeferredWorkQueue* pQueue, DeferredWorkFunction pFunction, uint32_t argument)
+{
+    if(pQueue == 0 || pFunction == 0){
+        return DEFERRED_WORK_ERR_INVALID_PTR;
+    }
+
+    uint32_t head = pQueue->head;
+    uint32_t depth = head - pQueue->tail;
+
+    if(depth >= DEFERRED_WORK_QUEUE_SIZE){
+        pQueue->statistics.droppedCount++;
+        return DEFERRED_WORK_ERR_QUEUE_FULL;
+    }
+
+    DeferredWorkItem* pItem = &pQueue->items[head & DEFERRED_WORK_INDEX_MASK];
+    pItem->pFunction = pFunction;
+    pItem->argument = argument;
+    pItem->postTimestamp = (pQueue->pGetTimestamp != 0) ? pQueue->pGetTimestamp() : 0;
+
+    // The item has to be complete before the consumer sees the new head
+    MEMORY_BARRIER();
+    pQueue->head = head + 1;
+
+    pQueue->statistics.postCount++;
+    if(depth + 1 > pQueue->statistics.maxDepth){
+        pQueue->statistics.maxDepth = depth + 1;
+    }
+
+    return DEFERRED_WORK_ERR_OK;
+}
+
+bool deferredWorkPending(const DeferredWorkQueue* pQueue)
+{
+    if(pQueue == 0){
+        return false;
+    }
+
+    return pQueue->head != pQueue->tail;
+}
+
+int32_t deferredWorkRunOne(DeferredWorkQueue* pQueue)
+{
+    if(pQueue == 0){
+        return DEFERRED_WORK_ERR_INVALID_PTR;
+    }
+
+    uint32_t tail = pQueue->tail;
+    if(pQueue->head == tail){
+        return DEFERRED_WORK_ERR_EMPTY;
+    }
+
+    // Read the item only after the head which published it
+    MEMORY_BARRIER();
+    DeferredWorkItem item = pQueue->items[tail & DEFERRED_WORK_INDEX_MASK];
+
+    // The slot may be reused by the producer as soon as the tail moved on
+    MEMORY_BARRIER();
+    pQueue->tail = tail + 1;
+
+    if(pQueue->pGetTimestamp != 0){
+        uint32_t latency = pQueue->pGetTimestamp() - item.postTimestamp;
+
+        pQueue->statistics.totalLatency += latency;
+        if(latency > pQueue->statistics.maxLatency){
+            pQueue->statistics.maxLatency = latency;
+        }
+    }
+    pQueue->statistics.runCount++;
+
+    item.pFunction(item.argument);
+
+    return DEFERRED_WORK_ERR_OK;
+}
+
+int32_t deferredWorkGetStatistics(DeferredWorkQueue* pQueue, DeferredWorkStatistics* pStatistics)
+{
+    if(pQueue == 0 || pStatistics == 0){
+        return DEFERRED_WORK_ERR_INVALID_PTR;
+    }
+
+    // The producer statistics are updated from the ISR
+    uint32_t state = criticalEnter();
+    *pStatistics = pQueue->statistics;
+    criticalExit(state);
+
+    pStatistics->meanLatency = 0;
+    if(pStatistics->runCount > 0){
+        pStatistics->meanLatency = (uint32_t) (pStatistics->totalLatency / pStatistics->runCount);
+    }
+
+    return DEFERRED_WORK_ERR_OK;
+}
+
+int32_t deferredWorkResetStatistics(DeferredWorkQueue* pQueue)
+{
+    if(pQueue == 0){
+        return DEFERRED_WORK_ERR_INVALID_PTR;
+    }
+
+    uint32_t state = criticalEnter();
+    memset(&pQueue->statistics, 0, sizeof(DeferredWorkStatistics));
+    criticalExit(state);
+
+    return DEFERRED_WORK_ERR_OK;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
@@ -0,0 +1,169 @@
+/******************************************************************************
+ * @file DeferredWork.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Header file for the deferred work queues (bottom halves)
+ *
+ * @details Interrupt handlers post small work items (function + argument)
+ * into a queue, the scheduler runs them in the super loop ahead of the
+ * periodic tasks, in kernel mode a thread above all tasks runs them. Every
+ * queue is a lock-free single-producer/single-consumer ring: only the
+ * producer (one ISR) writes the head index, only the consumer (the
+ * scheduler) writes the tail index. Several ISRs therefore need one queue
+ * each.
+ *
+ *
+ *****************************************************************************/
+#ifndef _DEFERRED_WORK_H_
+#define _DEFERRED_WORK_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#define DEFERRED_WORK_ERR_OK            0       //!< No error occured
+#define DEFERRED_WORK_ERR_INVALID_PTR   -1      //!< Invalid pointer
+#define DEFERRED_WORK_ERR_QUEUE_FULL    -2      //!< Queue is full, the work item was dropped
+#define DEFERRED_WORK_ERR_EMPTY         -3      //!< Queue is empty
+
+#ifndef DEFERRED_WORK_QUEUE_SIZE
+#define DEFERRED_WORK_QUEUE_SIZE        16      //!< Number of work items per queue (power of two)
+#endif
+
+#if (DEFERRED_WORK_QUEUE_SIZE & (DEFERRED_WORK_QUEUE_SIZE - 1)) != 0
+#error "DEFERRED_WORK_QUEUE_SIZE must be a power of two"
+#endif
+
+
+/***** TYPES *****************************************************************/
+
+/**
+ * @brief Function pointer for a deferred work function
+ *
+ */
+typedef void (*DeferredWorkFunction)(uint32_t argument);
+
+/**
+ * @brief Function pointer for a free running time stamp counter (e.g. the
+ * DWT cycle counter) used to measure the post-to-run latency
+ *
+ */
+typedef uint32_t (*GetTimestamp)(void);
+
+/**
+ * @brief A single work item
+ *
+ */
+typedef struct _DeferredWorkItem
+{
+    DeferredWorkFunction pFunction;     //!< Function to run
+    uint32_t argument;                  //!< Argument passed to the function
+    uint32_t postTimestamp;             //!< Time stamp of the post
+} DeferredWorkItem;
+
+/**
+ * @brief Statistics of a queue, the latency is given in time stamp counts
+ *
+ */
+typedef struct _DeferredWorkStatistics
+{
+    uint32_t postCount;                 //!< Number of posted work items
+    uint32_t droppedCount;              //!< Number of work items dropped because the queue was full
+    uint32_t maxDepth;                  //!< Maximum number of queued work items
+    uint32_t runCount;                  //!< Number of executed work items
+    uint32_t maxLatency;                //!< Maximum time between post and start of a work item
+    uint32_t meanLatency;               //!< Mean latency (only filled by deferredWorkGetStatistics())
+    uint64_t totalLatency;              //!< Sum of all latencies
+} DeferredWorkStatistics;
+
+/**
+ * @brief Deferred work queue (SPSC ring)
+ *
+ */
+typedef struct _DeferredWorkQueue
+{
+    DeferredWorkItem items[DEFERRED_WORK_QUEUE_SIZE];   //!< Ring buffer of the work items
+    volatile uint32_t head;             //!< Free running write index, written by the producer only
+    volatile uint32_t tail;             //!< Free running read index, written by the consumer only
+    uint8_t priority;                   //!< Priority of the queue, 0 is the highest priority
+    GetTimestamp pGetTimestamp;         //!< Optional time stamp function for the latency measurement
+    struct _DeferredWorkQueue* pNext;   //!< Next queue (lower priority) in the list of the scheduler
+    DeferredWorkStatistics statistics;  //!< Statistics of the queue
+} DeferredWorkQueue;
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Initializes a deferred work queue
+ *
+ * @param pQueue Pointer to the queue
+ * @param priority Priority of the queue, 0 is the highest priority
+ * @param pGetTimestamp Time stamp function for the latency measurement (may be 0)
+ *
+ * @return DEFERRED_WORK_ERR_OK if no error occured
+ */
+int32_t deferredWorkInitQueue(DeferredWorkQueue* pQueue, uint8_t priority, GetTimestamp pGetTimestamp);
+
+/**
+ * @brief Posts a work item into the queue (producer side, e.g. ISR)
+ *
+ * @param pQueue Pointer to the queue
+ * @param pFunction Function to run
+ * @param argument Argument passed to the function
+ *
+ * @return DEFERRED_WORK_ERR_OK if no error occured, DEFERRED_WORK_ERR_QUEUE_FULL
+ * if the item was dropped
+ */
+int32_t deferredWorkPost(DeferredWorkQueue* pQueue, DeferredWorkFunction pFunction, uint32_t argument);
+
+/**
+ * @brief Checks if work items are queued
+ *
+ * @param pQueue Pointer to the queue
+ *
+ * @return true if at least one work item is queued
+ */
+bool deferredWorkPending(const DeferredWorkQueue* pQueue);
+
+/**
+ * @brief Runs the oldest work item of the queue (consumer side)
+ *
+ * @param pQueue Pointer to the queue
+ *
+ * @return DEFERRED_WORK_ERR_OK if a work item was run, DEFERRED_WORK_ERR_EMPTY
+ * if the queue was empty
+ */
+int32_t deferredWorkRunOne(DeferredWorkQueue* pQueue);
+
+/**
+ * @brief Returns the statistics of a queue
+ *
+ * @param pQueue Pointer to the queue
+ * @param pStatistics Pointer to the struct which receives the statistics
+ *
+ * @return DEFERRED_WORK_ERR_OK if no error occured
+ */
+int32_t deferredWorkGetStatistics(DeferredWorkQueue* pQueue, DeferredWorkStatistics* pStatistics);
+
+/**
+ * @brief Resets the statistics of a queue
+ *
+ * @param pQueue Pointer to the queue
+ *
+ * @return DEFERRED_WORK_ERR_OK if no error occured
+ */
+int32_t deferredWorkResetStatistics(DeferredWorkQueue* pQueue);
+
+#endif
@@ -0,0 +1,598 @@
+/******************************************************************************
+ * @file Kernel.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Implementation of the optional preemptive fixed-priority kernel
+ *
+ * @details Every thread has one bit in the ready mask, the thread index is
+ * the priority (index 0 is the highest priority, the idle thread has the
+ * last index). The context switch only saves R4-R11 in addition to the
+ * hardware stack frame, as the firmware is built for soft float
+ * (no FPU context). All kernel data is protected by disabling the
+ * interrupts (PRIMASK).
+ *
+ *
+ *****************************************************************************/
+
+
+/***** INCLUDES **************************************************************/
+#include "Kernel.h"
+
+#if KERNEL_PREEMPTIVE_ENABLED
+
+#include "stm32g4xx_hal.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define KERNEL_MAX_THREADS          (MAX_SCHEDULER_TASKS + 2)   //!< Threads for all tasks plus the deferred work and the idle thread
+#define KERNEL_INITIAL_XPSR         0x01000000                  //!< xPSR with the Thumb bit set
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+/**
+ * @brief Thread control block
+ *
+ * @remark: pStackPointer has to be the first member, it is accessed by
+ * the context switch
+ */
+typedef struct _KernelThread
+{
+    uint32_t* pStackPointer;            //!< Saved process stack pointer
+    SchedulerTask* pTask;               //!< Task which is executed by the thread (0 for the idle thread)
+    uint32_t wakeTime;                  //!< Release time of the current period
+    uint32_t timeoutTick;               //!< Tick at which a blocking call times out
+    bool hasTimeout;                    //!< Blocking call has a timeout
+    KernelSemaphore* pWaitSemaphore;    //!< Semaphore the thread is waiting for
+    int32_t waitResult;                 //!< Result of the last blocking call
+} KernelThread;
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+
+/**
+ * @brief Thread function which releases the task of the thread periodically
+ */
+static void kernelTaskThread(void);
+
+/**
+ * @brief Thread function which runs the deferred work of the scheduler
+ * whenever an interrupt posted work
+ */
+static void kernelDeferredWorkThread(void);
+
+/**
+ * @brief Thread function of the idle thread, resumes the coroutines of the
+ * scheduler and sleeps until the next interrupt
+ */
+static void kernelIdleThread(void);
+
+/**
+ * @brief Return address of the thread functions, which must never return
+ */
+static void kernelThreadExit(void);
+
+/**
+ * @brief Prepares the stack of a thread, so that the first context switch
+ * to this thread starts the given function
+ *
+ * @param pThread Pointer to the thread
+ * @param pStack Pointer to the (lowest address of the) stack memory
+ * @param threadFunction Function which is executed by the thread
+ */
+static void kernelInitThreadStack(KernelThread* pThread, uint64_t* pStack, void (*threadFunction)(void));
+
+/**
+ * @brief Selects the highest priority ready thread and requests a context
+ * switch if needed
+ *
+ * @remark: Must be called with interrupts disabled
+ */
+static void kernelSchedule(void);
+
+/**
+ * @brief Blocks the current thread until it gets released by the semaphore,
+ * the timeout or the wake time. The context switch happens as soon as the
+ * interrupts are enabled again.
+ *
+ * @remark: Must be called with interrupts disabled
+ *
+ * @param pSemaphore Semaphore to wait for (0 for a pure delay)
+ * @param timeout Timeout in ticks or KERNEL_WAIT_FOREVER
+ */
+static void kernelWait(KernelSemaphore* pSemaphore, uint32_t timeout);
+
+/**
+ * @brief Checks if the calling context is allowed to block
+ *
+ * @param primask PRIMASK value of the caller
+ *
+ * @return true if the caller is a thread with interrupts enabled
+ */
+static bool kernelCanBlock(uint32_t primask);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static KernelThread gThreads[KERNEL_MAX_THREADS];                               //!< Thread control blocks, ordered by priority
+static uint64_t gThreadStacks[KERNEL_MAX_THREADS][KERNEL_STACK_SIZE / 8];       //!< Thread stacks (8 byte aligned)
+static uint32_t gThreadCount = 0;                                               //!< Number of threads including the idle thread
+static volatile uint32_t gReadyMask = 0;                                        //!< Bit mask of the ready threads
+static Scheduler* gpScheduler = 0;                                              //!< Scheduler with the tasks and the tick function
+static KernelSemaphore gDeferredWorkSemaphore = { .count = 0, .maxCount = 1 };  //!< Given by the interrupts which posted deferred work
+
+__attribute__((used)) static volatile uint32_t gKernelRunning = 0;              //!< Set by the SVC handler when the first thread starts
+__attribute__((used)) static KernelThread* volatile gpCurrentThread = 0;        //!< Running thread
+__attribute__((used)) static KernelThread* volatile gpNextThread = 0;           //!< Thread to switch to with the next PendSV
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int32_t kernelStart(Scheduler* pScheduler)
+{
+    if(pScheduler == 0 || pScheduler->pGetHALTick == 0){
+        return KERNEL_ERR_INVALID_PTR;
+    }
+    if(pScheduler->registeredTaskCount == 0){
+        return KERNEL_ERR_NO_TASKS;
+    }
+    for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+        if(pScheduler->tasks[i].period == 0){
+            return KERNEL_ERR_INVALID_PARAM;
+        }
+    }
+
+    // Applies the phases, lastExecution holds the start of the first period
+    schedInitialize(pScheduler);
+    gpScheduler = pScheduler;
+    gThreadCount = 0;
+
+    // The deferred work preempts all tasks, like it runs ahead of them in schedCycle()
+    uint32_t firstTaskThread = 0;
+    if(pScheduler->pDeferredWork != 0){
+        memset(&gThreads[0], 0, sizeof(KernelThread));
+        kernelInitThreadStack(&gThreads[0], gThreadStacks[0], kernelDeferredWorkThread);
+        gThreadCount++;
+        firstTaskThread = 1;
+    }
+
+    // Rate monotonic priorities: sorted by period, stable regarding the registration order
+    for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+        uint32_t position = gThreadCount;
+        while(position > firstTaskThread && gThreads[position - 1].pTask->period > pScheduler->tasks[i].period){
+            gThreads[position] = gThreads[position - 1];
+            position--;
+        }
+
+        memset(&gThreads[position], 0, sizeof(KernelThread));
+        gThreads[position].pTask = &pScheduler->tasks[i];
+        gThreads[position].wakeTime = pScheduler->tasks[i].lastExecution;
+        gThreadCount++;
+    }
+
+    for(uint32_t i = firstTaskThread; i < gThreadCount; i++){
+        kernelInitThreadStack(&gThreads[i], gThreadStacks[i], kernelTaskThread);
+    }
+
+    memset(&gThreads[gThreadCount], 0, sizeof(KernelThread));
+    kernelInitThreadStack(&gThreads[gThreadCount], gThreadStacks[gThreadCount], kernelIdleThread);
+    gThreadCount++;
+
+    // All threads start with waiting for their first release, which is
+    // done by the thread itself, therefore all are ready
+    gReadyMask = (gThreadCount == 32) ? 0xFFFFFFFF : ((1UL << gThreadCount) - 1);
+    gpCurrentThread = &gThreads[0];
+    gpNextThread = &gThreads[0];
+
+    // PendSV with the lowest priority, so context switches never interrupt an ISR
+    NVIC_SetPriority(PendSV_IRQn, (1UL << __NVIC_PRIO_BITS) - 1);
+
+    // The SVC handler starts the first thread, SVC requires enabled interrupts
+    __enable_irq();
+    __asm volatile ("svc 0");
+
+    // Never reached
+    return KERNEL_ERR_OK;
+}
+
+void kernelTick(void)
+{
+    if(gKernelRunning == 0){
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t now = gpScheduler->pGetHALTick();
+
+    for(uint32_t i = 0; i < gThreadCount; i++){
+        KernelThread* pThread = &gThreads[i];
+
+        if(pThread->hasTimeout && (int32_t) (now - pThread->timeoutTick) >= 0){
+            pThread->hasTimeout = false;
+            if(pThread->pWaitSemaphore != 0){
+                pThread->pWaitSemaphore->waitingMask &= ~(1UL << i);
+                pThread->pWaitSemaphore = 0;
+            }
+            gReadyMask |= (1UL << i);
+        }
+    }
+
+    kernelSchedule();
+
+    __set_PRIMASK(primask);
+}
+
+uint32_t kernelDelayUntil(uint32_t* pWakeTime, uint32_t period)
+{
+    if(pWakeTime == 0){
+        return 0;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    *pWakeTime += period;
+
+    uint32_t now = gpScheduler->pGetHALTick();
+    if((int32_t) (now - *pWakeTime) >= 0){
+        __set_PRIMASK(primask);
+        return (period > 0) ? (now - *pWakeTime) / period : 0;
+    }
+
+    if(kernelCanBlock(primask)){
+        kernelWait(0, *pWakeTime - now);
+    }
+
+    __set_PRIMASK(primask);
+
+    return 0;
+}
+
+void kernelNotifyDeferredWork(void)
+{
+    // The count saturates at 1, the thread drains all queues per wake up
+    kernelSemaphoreGive(&gDeferredWorkSemaphore);
+}
+
+int32_t kernelSemaphoreInit(KernelSemaphore* pSemaphore, uint32_t initialCount, uint32_t maxCount)
+{
+    if(pSemaphore == 0){
+        return KERNEL_ERR_INVALID_PTR;
+    }
+    if(maxCount == 0 || initialCount > maxCount){
+        return KERNEL_ERR_INVALID_PARAM;
+    }
+
+    pSemaphore->count = initialCount;
+    pSemaphore->maxCount = maxCount;
+    pSemaphore->waitingMask = 0;
+
+    return KERNEL_ERR_OK;
+}
+
+int32_t kernelSemaphoreTake(KernelSemaphore* pSemaphore, uint32_t timeout)
+{
+    if(pSemaphore == 0){
+        return KERNEL_ERR_INVALID_PTR;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if(pSemaphore->count > 0){
+        pSemaphore->count--;
+        __set_PRIMASK(primask);
+        return KERNEL_ERR_OK;
+    }
+    if(timeout == 0){
+        __set_PRIMASK(primask);
+        return KERNEL_ERR_TIMEOUT;
+    }
+    if(!kernelCanBlock(primask)){
+        __set_PRIMASK(primask);
+        return KERNEL_ERR_ISR;
+    }
+
+    kernelWait(pSemaphore, timeout);
+
+    // The context switch happens here, the thread continues after the
+    // semaphore has been given or the timeout expired
+    __set_PRIMASK(primask);
+
+    return gpCurrentThread->waitResult;
+}
+
+int32_t kernelSemaphoreGive(KernelSemaphore* pSemaphore)
+{
+    if(pSemaphore == 0){
+        return KERNEL_ERR_INVALID_PTR;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if(pSemaphore->waitingMask != 0){
+        // Hand the semaphore over to the highest priority waiting thread
+        uint32_t index = (uint32_t) __builtin_ctz(pSemaphore->waitingMask);
+        KernelThread* pThread = &gThreads[index];
+
+        pSemaphore->waitingMask &= ~(1UL << index);
+        pThread->pWaitSemaphore = 0;
+        pThread->hasTimeout = false;
+        pThread->waitResult = KERNEL_ERR_OK;
+        gReadyMask |= (1UL << index);
+
+        kernelSchedule();
+    }
+    else if(pSemaphore->count < pSemaphore->maxCount){
+        pSemaphore->count++;
+    }
+
+    __set_PRIMASK(primask);
+
+    return KERNEL_ERR_OK;
+}
+
+int32_t kernelQueueInit(KernelQueue* pQueue, void* pBuffer, uint32_t itemSize, uint32_t capacity)
+{
+    if(pQueue == 0 || pBuffer == 0){
+        return KERNEL_ERR_INVALID_PTR;
+    }
+    if(itemSize == 0 || capacity == 0){
+        return KERNEL_ERR_INVALID_PARAM;
+    }
+
+    pQueue->pBuffer = (uint8_t*) pBuffer;
+    pQueue->itemSize = itemSize;
+    pQueue->capacity = capacity;
+    pQueue->head = 0;
+    pQueue->tail = 0;
+    kernelSemaphoreInit(&pQueue->items, 0, capacity);
+    kernelSemaphoreInit(&pQueue->spaces, capacity, capacity);
+
+    return KERNEL_ERR_OK;
+}
+
+int32_t kernelQueueSend(KernelQueue* pQueue, const void* pItem, uint32_t timeout)
+{
+    if(pQueue == 0 || pItem == 0){
+        return KERNEL_ERR_INVALID_PTR;
+    }
+
+    // Reserve a free slot, then fill it
+    int32_t result = kernelSemaphoreTake(&pQueue->spaces, timeout);
+    if(result != KERNEL_ERR_OK){
+        return result;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    memcpy(&pQueue->pBuffer[pQueue->tail * pQueue->itemSize], pItem, pQueue->itemSize);
+    pQueue->tail = (pQueue->tail + 1) % pQueue->capacity;
+
+    __set_PRIMASK(primask);
+
+    return kernelSemaphoreGive(&pQueue->items);
+}
+
+int32_t kernelQueueReceive(KernelQueue* pQueue, void* pItem, uint32_t timeout)
+{
+    if(pQueue == 0 || pItem == 0){
+        return KERNEL_ERR_INVALID_PTR;
+    }
+
+    int32_t result = kernelSemaphoreTake(&pQueue->items, timeout);
+    if(result != KERNEL_ERR_OK){
+        return result;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    memcpy(pItem, &pQueue->pBuffer[pQueue->head * pQueue->itemSize], pQueue->itemSize);
+    pQueue->head = (pQueue->head + 1) % pQueue->capacity;
+
+    __set_PRIMASK(primask);
+
+    return kernelSemaphoreGive(&pQueue->spaces);
+}
+
+/**
+ * @brief SVC Handler, starts the first thread
+ *
+ * Restores R4-R11 from the prepared stack of the first thread and returns
+ * to thread mode using the process stack (EXC_RETURN 0xFFFFFFFD).
+ *
+ */
+__attribute__((naked)) void SVC_Handler(void)
+{
+    __asm volatile (
+        "   ldr     r0, =gKernelRunning     \n"
+        "   movs    r1, #1                  \n"
+        "   str     r1, [r0]                \n"
+        "   ldr     r1, =gpCurrentThread    \n"
+        "   ldr     r1, [r1]                \n"
+        "   ldr     r0, [r1]                \n"
+        "   ldmia   r0!, {r4-r11}           \n"
+        "   msr     psp, r0                 \n"
+        "   ldr     lr, =0xFFFFFFFD         \n"
+        "   bx      lr                      \n"
+    );
+}
+
+/**
+ * @brief PendSV Handler, switches from gpCurrentThread to gpNextThread
+ *
+ * The hardware already pushed R0-R3, R12, LR, PC and xPSR onto the process
+ * stack, the handler saves/restores the remaining registers R4-R11.
+ *
+ */
+__attribute__((naked)) void PendSV_Handler(void)
+{
+    __asm volatile (
+        "   cpsid   i                       \n"
+        "   mrs     r0, psp                 \n"
+        "   stmdb   r0!, {r4-r11}           \n"
+        "   ldr     r1, =gpCurrentThread    \n"
+        "   ldr     r2, [r1]                \n"
+        "   str     r0, [r2]                \n"
+        "   ldr     r2, =gpNextThread       \n"
+        "   ldr     r2, [r2]                \n"
+        "   str     r2, [r1]                \n"
+        "   ldr     r0, [r2]                \n"
+        "   ldmia   r0!, {r4-r11}           \n"
+        "   msr     psp, r0                 \n"
+        "   cpsie   i                       \n"
+        "   bx      lr                      \n"
+    );
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+static void kernelTaskThread(void)
+{
+    KernelThread* pThread = gpCurrentThread;
+    SchedulerTask* pTask = pThread->pTask;
+
+    while(true){
+        uint32_t lateReleases = kernelDelayUntil(&pThread->wakeTime, pTask->period);
+        uint32_t missedReleases = 0;
+
+        // Same overrun handling as in schedCycle()
+        if(pTask->overrunPolicy == SCHED_OVERRUN_CATCH_UP){
+            if(lateReleases > 0){
+                pTask->missedReleases++;
+            }
+        }
+        else{
+            missedReleases = lateReleases;
+            pThread->wakeTime += missedReleases * pTask->period;
+            pTask->missedReleases += missedReleases;
+        }
+        pTask->lastExecution = pThread->wakeTime;
+
+        if(pTask->overrunPolicy == SCHED_OVERRUN_COALESCE){
+            if(pTask->pCoalescingTask != 0){
+                pTask->pCoalescingTask(missedReleases);
+            }
+        }
+        else if(pTask->pTask != 0){
+            pTask->pTask();
+        }
+    }
+}
+
+static void kernelDeferredWorkThread(void)
+{
+    while(true){
+        kernelSemaphoreTake(&gDeferredWorkSemaphore, KERNEL_WAIT_FOREVER);
+
+        // Always the oldest item of the highest priority queue with pending work
+        DeferredWorkQueue* pQueue = gpScheduler->pDeferredWork;
+        while(pQueue != 0){
+            if(deferredWorkPending(pQueue)){
+                deferredWorkRunOne(pQueue);
+                pQueue = gpScheduler->pDeferredWork;
+            }
+            else{
+                pQueue = pQueue->pNext;
+            }
+        }
+    }
+}
+
+static void kernelIdleThread(void)
+{
+    while(true){
+        uint32_t ticksUntilResume = UINT32_MAX;
+        if(gpScheduler->pCoroutines != 0){
+            schedResumeCoroutinesOnce(gpScheduler, &ticksUntilResume);
+        }
+
+        // A yielded coroutine continues right away, otherwise any interrupt
+        // (at least the SysTick) wakes the core up again
+        if(ticksUntilResume > 0){
+            __WFI();
+        }
+    }
+}
+
+static void kernelThreadExit(void)
+{
+    while(true){
+    }
+}
+
+static void kernelInitThreadStack(KernelThread* pThread, uint64_t* pStack, void (*threadFunction)(void))
+{
+    uint32_t* pStackPointer = (uint32_t*) &pStack[KERNEL_STACK_SIZE / 8];
+
+    // Hardware stack frame, restored by the exception return
+    *(--pStackPointer) = KERNEL_INITIAL_XPSR;                               // xPSR
+    *(--pStackPointer) = (uint32_t) (uintptr_t) threadFunction & ~1UL;      // PC
+    *(--pStackPointer) = (uint32_t) (uintptr_t) kernelThreadExit;           // LR
+    for(uint32_t i = 0; i < 5; i++){
+        *(--pStackPointer) = 0;                                             // R12, R3, R2, R1, R0
+    }
+
+    // R4-R11, restored by the context switch
+    for(uint32_t i = 0; i < 8; i++){
+        *(--pStackPointer) = 0;
+    }
+
+    pThread->pStackPointer = pStackPointer;
+}
+
+static void kernelSchedule(void)
+{
+    if(gKernelRunning == 0){
+        return;
+    }
+
+    // The idle thread is always ready, so the mask is never 0
+    gpNextThread = &gThreads[__builtin_ctz(gReadyMask)];
+
+    if(gpNextThread != gpCurrentThread){
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+}
+
+static void kernelWait(KernelSemaphore* pSemaphore, uint32_t timeout)
+{
+    KernelThread* pThread = gpCurrentThread;
+    uint32_t threadMask = 1UL << (uint32_t) (pThread - gThreads);
+
+    pThread->waitResult = KERNEL_ERR_TIMEOUT;
+    pThread->pWaitSemaphore = pSemaphore;
+    pThread->hasTimeout = (timeout != KERNEL_WAIT_FOREVER);
+    pThread->timeoutTick = gpScheduler->pGetHALTick() + timeout;
+
+    if(pSemaphore != 0){
+        pSemaphore->waitingMask |= threadMask;
+    }
+
+    gReadyMask &= ~threadMask;
+    kernelSchedule();
+}
+
+static bool kernelCanBlock(uint32_t primask)
+{
+    return gKernelRunning != 0 && __get_IPSR() == 0 && primask == 0;
+}
+
+#endif // KERNEL_PREEMPTIVE_ENABLED
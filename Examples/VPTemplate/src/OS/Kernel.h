@@ -0,0 +1,217 @@
+/******************************************************************************
+ * @file Kernel.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Header file for the optional preemptive fixed-priority kernel
+ *
+ * @details The kernel runs the tasks registered at a Scheduler as threads
+ * with their own stacks. The priorities are assigned rate monotonic (the
+ * shorter the period, the higher the priority), so a slow task can no
+ * longer delay a fast one. Context switches are done in PendSV, the SysTick
+ * drives the time base. Blocking primitives (delay until, counting
+ * semaphore, message queue) can be used by the task functions. The
+ * deferred work queues of the Scheduler are drained by a thread above all
+ * tasks, which the interrupts wake up with kernelNotifyDeferredWork().
+ * The coroutines of the Scheduler are resumed by the idle thread, below all
+ * tasks; they must not call the blocking kernel functions.
+ *
+ * The kernel is only compiled with KERNEL_PREEMPTIVE_ENABLED set to 1,
+ * otherwise the cooperative schedCycle() is used.
+ *
+ *
+ *****************************************************************************/
+#ifndef _KERNEL_H_
+#define _KERNEL_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+
+#include "Scheduler.h"
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#define KERNEL_ERR_OK                 0         //!< No error occured
+#define KERNEL_ERR_INVALID_PTR        -1        //!< Invalid pointer
+#define KERNEL_ERR_TIMEOUT            -2        //!< Timeout while waiting
+#define KERNEL_ERR_ISR                -3        //!< Blocking call from an interrupt or before kernelStart()
+#define KERNEL_ERR_NO_TASKS           -4        //!< No task registered at the scheduler
+#define KERNEL_ERR_INVALID_PARAM      -5        //!< Invalid parameter
+
+#ifndef KERNEL_PREEMPTIVE_ENABLED
+#define KERNEL_PREEMPTIVE_ENABLED     0         //!< Use the preemptive kernel instead of schedCycle()
+#endif
+
+#ifndef KERNEL_STACK_SIZE
+#define KERNEL_STACK_SIZE             1024      //!< Stack size per thread in bytes (multiple of 8)
+#endif
+
+#define KERNEL_WAIT_FOREVER           0xFFFFFFFF    //!< Timeout value to wait without timeout
+
+#if KERNEL_PREEMPTIVE_ENABLED && MAX_SCHEDULER_TASKS > 30
+#error "The kernel supports at most 30 tasks (one priority bit per thread plus the deferred work and the idle thread)"
+#endif
+
+
+/***** TYPES *****************************************************************/
+
+/**
+ * @brief Counting semaphore
+ *
+ * Can be given from threads and interrupts, taken only from threads (or
+ * with timeout 0 from interrupts).
+ *
+ */
+typedef struct _KernelSemaphore
+{
+    volatile uint32_t count;            //!< Current count
+    uint32_t maxCount;                  //!< Upper limit of the count
+    volatile uint32_t waitingMask;      //!< Bit mask of the threads waiting for the semaphore
+} KernelSemaphore;
+
+/**
+ * @brief Message queue with fixed item size, the storage is provided by
+ * the caller (itemSize * capacity bytes)
+ *
+ */
+typedef struct _KernelQueue
+{
+    uint8_t* pBuffer;                   //!< Storage of the items
+    uint32_t itemSize;                  //!< Size of one item in bytes
+    uint32_t capacity;                  //!< Number of items which fit into the queue
+    uint32_t head;                      //!< Index of the next item to receive
+    uint32_t tail;                      //!< Index of the next item to send
+    KernelSemaphore items;              //!< Counts the items in the queue
+    KernelSemaphore spaces;             //!< Counts the free slots in the queue
+} KernelQueue;
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Starts the kernel with the tasks registered at the scheduler
+ *
+ * schedInitialize() is called to apply the phases, then every task gets a
+ * thread which releases the task function periodically. The overrun
+ * policies and the missed release counters of the scheduler are kept.
+ * If deferred work queues are registered, a thread with the highest
+ * priority runs their work items, highest priority queue first. The idle
+ * thread resumes the registered coroutines.
+ *
+ * @remark: The execution time profiling of the scheduler is not available
+ * in kernel mode, as measured times would include preemptions.
+ *
+ * @param pScheduler Pointer to scheduler struct with the registered tasks
+ *
+ * @return Does not return on success, otherwise KERNEL_ERR_INVALID_PTR,
+ * KERNEL_ERR_NO_TASKS or KERNEL_ERR_INVALID_PARAM if a task has no period
+ */
+int32_t kernelStart(Scheduler* pScheduler);
+
+/**
+ * @brief Time base of the kernel, has to be called from the SysTick
+ * interrupt after the HAL tick has been incremented
+ */
+void kernelTick(void);
+
+/**
+ * @brief Blocks the calling thread until the next period starts
+ *
+ * The wake time is advanced by one period. If it lies in the past, the
+ * function returns immediately.
+ *
+ * @param pWakeTime Wake time of the previous period, gets updated
+ * @param period Period in ticks
+ *
+ * @return Number of further periods which already passed (0 if the thread
+ * was on time)
+ */
+uint32_t kernelDelayUntil(uint32_t* pWakeTime, uint32_t period);
+
+/**
+ * @brief Wakes up the deferred work thread, has to be called from the
+ * interrupt after deferredWorkPost(). Before kernelStart() the call is
+ * remembered.
+ *
+ * @remark: Without a deferred work queue registered at the scheduler,
+ * kernelStart() creates no deferred work thread and the call has no effect
+ */
+void kernelNotifyDeferredWork(void);
+
+/**
+ * @brief Initializes a counting semaphore
+ *
+ * @param pSemaphore Pointer to the semaphore
+ * @param initialCount Initial count
+ * @param maxCount Upper limit of the count
+ *
+ * @return KERNEL_ERR_OK if no error occured
+ */
+int32_t kernelSemaphoreInit(KernelSemaphore* pSemaphore, uint32_t initialCount, uint32_t maxCount);
+
+/**
+ * @brief Takes the semaphore, blocks if the count is 0
+ *
+ * @param pSemaphore Pointer to the semaphore
+ * @param timeout Timeout in ticks, 0 to poll or KERNEL_WAIT_FOREVER
+ *
+ * @return KERNEL_ERR_OK if the semaphore was taken, KERNEL_ERR_TIMEOUT
+ * otherwise
+ */
+int32_t kernelSemaphoreTake(KernelSemaphore* pSemaphore, uint32_t timeout);
+
+/**
+ * @brief Gives the semaphore and wakes the highest priority waiting thread.
+ * Can be called from interrupts.
+ *
+ * @param pSemaphore Pointer to the semaphore
+ *
+ * @return KERNEL_ERR_OK if no error occured
+ */
+int32_t kernelSemaphoreGive(KernelSemaphore* pSemaphore);
+
+/**
+ * @brief Initializes a message queue
+ *
+ * @param pQueue Pointer to the queue
+ * @param pBuffer Storage with itemSize * capacity bytes
+ * @param itemSize Size of one item in bytes
+ * @param capacity Number of items
+ *
+ * @return KERNEL_ERR_OK if no error occured
+ */
+int32_t kernelQueueInit(KernelQueue* pQueue, void* pBuffer, uint32_t itemSize, uint32_t capacity);
+
+/**
+ * @brief Copies an item into the queue, blocks while the queue is full.
+ * Can be called from interrupts with timeout 0.
+ *
+ * @param pQueue Pointer to the queue
+ * @param pItem Pointer to the item
+ * @param timeout Timeout in ticks, 0 to poll or KERNEL_WAIT_FOREVER
+ *
+ * @return KERNEL_ERR_OK if the item was sent, KERNEL_ERR_TIMEOUT otherwise
+ */
+int32_t kernelQueueSend(KernelQueue* pQueue, const void* pItem, uint32_t timeout);
+
+/**
+ * @brief Copies the oldest item out of the queue, blocks while the queue
+ * is empty
+ *
+ * @param pQueue Pointer to the queue
+ * @param pItem Pointer which receives the item
+ * @param timeout Timeout in ticks, 0 to poll or KERNEL_WAIT_FOREVER
+ *
+ * @return KERNEL_ERR_OK if an item was received, KERNEL_ERR_TIMEOUT otherwise
+ */
+int32_t kernelQueueReceive(KernelQueue* pQueue, void* pItem, uint32_t timeout);
+
+#endif
@@ -17,6 +17,9 @@
 
 /***** INCLUDES **************************************************************/
 #include "Scheduler.h"
+#include "Critical.h"
+
+#include <stdbool.h>
 
 
 /***** PRIVATE CONSTANTS *****************************************************/
@@ -42,6 +45,144 @@
  */
 static uint8_t isCyclicFunctionValid(CyclicFunction toCheckFunction);
 
+/**
+ * @brief Returns the tick time stamp of the next release of a task
+ *
+ * @param pTask Pointer to the task
+ *
+ * @return Tick time stamp of the next release
+ */
+static inline uint32_t taskNextRelease(const SchedulerTask* pTask);
+
+/**
+ * @brief Compares two tasks regarding their next release time. Tasks with the
+ * same release time are ordered by their registration order
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param taskIndexA Index of the first task
+ * @param taskIndexB Index of the second task
+ *
+ * @return true if task A has to be released before task B
+ */
+static bool releasesBefore(const Scheduler* pScheduler, uint8_t taskIndexA, uint8_t taskIndexB);
+
+/**
+ * @brief Moves the release queue entry at the given position up until the
+ * heap property is restored
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param position Position in the release queue
+ */
+static void releaseQueueSiftUp(Scheduler* pScheduler, uint32_t position);
+
+/**
+ * @brief Moves the release queue entry at the given position down until the
+ * heap property is restored
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param position Position in the release queue
+ */
+static void releaseQueueSiftDown(Scheduler* pScheduler, uint32_t position);
+
+/**
+ * @brief Calls the task function according to the overrun policy of the task
+ *
+ * @param pTask Pointer to the task
+ * @param missedReleases Number of releases skipped with this execution
+ */
+static void taskExecute(const SchedulerTask* pTask, uint32_t missedReleases);
+
+/**
+ * @brief Runs queued deferred work, always the oldest item of the highest
+ * priority queue with pending work, at most SCHED_DEFERRED_WORK_BUDGET items
+ *
+ * @param pScheduler Pointer to scheduler struct
+ */
+static void schedRunDeferredWork(Scheduler* pScheduler);
+
+/**
+ * @brief Checks if any deferred work queue has pending work
+ *
+ * @param pScheduler Pointer to scheduler struct
+ *
+ * @return true if work is pending
+ */
+static bool schedDeferredWorkPending(const Scheduler* pScheduler);
+
+/**
+ * @brief Resumes all coroutines, which are not ended or sleeping
+ *
+ * @param pScheduler Pointer to scheduler struct
+ */
+static void schedResumeCoroutines(Scheduler* pScheduler);
+
+/**
+ * @brief Returns the number of ticks until a coroutine has to be resumed
+ *
+ * @param pScheduler Pointer to scheduler struct
+ *
+ * @return 0 if a coroutine yielded, UINT32_MAX if no coroutine has to be
+ * resumed at a certain time
+ */
+static uint32_t schedTicksUntilCoroutineResume(const Scheduler* pScheduler);
+
+/**
+ * @brief Returns the execution time budget of a task, the declared budget
+ * or the measured maximum execution time
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param taskIndex Index of the task
+ *
+ * @return Budget in microseconds, 0 if unknown
+ */
+static uint32_t taskBudget(const Scheduler* pScheduler, uint32_t taskIndex);
+
+/**
+ * @brief Returns the least common multiple of all task periods, limited
+ * to SCHED_MAX_HYPERPERIOD
+ *
+ * @param pScheduler Pointer to scheduler struct
+ *
+ * @return Hyperperiod in ticks
+ */
+static uint32_t schedHyperperiod(const Scheduler* pScheduler);
+
+/**
+ * @brief Checks if a task is released at the given tick offset
+ *
+ * @param pTask Pointer to the task
+ * @param tick Tick offset relative to the initialization
+ *
+ * @return true if the task is released at this tick
+ */
+static bool taskReleasedAt(const SchedulerTask* pTask, uint32_t tick);
+
+/**
+ * @brief Calculates the phases of all tasks registered with SCHED_PHASE_AUTO
+ *
+ * @param pScheduler Pointer to scheduler struct
+ */
+static void schedAutoPhase(Scheduler* pScheduler);
+
+#if SCHED_PROFILING_ENABLED
+/**
+ * @brief Adds one execution of a task to its profile
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param pTask Pointer to the executed task
+ * @param cycles Execution time in cycles
+ * @param startJitter Delay between ideal release and start in ticks
+ */
+static void profileRecordExecution(Scheduler* pScheduler, SchedulerTask* pTask, uint32_t cycles, uint32_t startJitter);
+
+/**
+ * @brief Resets a single task profile
+ *
+ * @param pProfile Pointer to the profile
+ */
+static void profileReset(SchedulerTaskProfile* pProfile);
+#endif
+
 /***** PRIVATE VARIABLES *****************************************************/
 
 
@@ -57,9 +198,19 @@ int32_t schedInitialize(Scheduler* pScheduler)
         return SCHED_ERR_INVALID_PTR;
     }
 
+    schedAutoPhase(pScheduler);
+
     uint32_t beginTickTime = pScheduler->pGetHALTick();
     for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
-        pScheduler->tasks[i].lastExecution = beginTickTime;
+        pScheduler->tasks[i].lastExecution = beginTickTime + pScheduler->tasks[i].phase;
+    }
+
+    // Rebuild the release queue, as all the release times have changed
+    for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+        pScheduler->releaseQueue[i] = (uint8_t) i;
+    }
+    for(uint32_t i = pScheduler->registeredTaskCount / 2; i > 0; i--){
+        releaseQueueSiftDown(pScheduler, i - 1);
     }
 
     return SCHED_ERR_OK;
@@ -75,12 +226,84 @@ int32_t schedCycle(Scheduler* pScheduler)
         return SCHED_ERR_INVALID_PTR;
     }
 
+    schedRunDeferredWork(pScheduler);
+
+    uint32_t nowTickTime = pScheduler->pGetHALTick();
+
     for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
-        uint32_t nowTickTime = pScheduler->pGetHALTick();
-        if(nowTickTime - pScheduler->tasks[i].lastExecution >= pScheduler->tasks[i].period){
-            pScheduler->tasks[i].lastExecution += pScheduler->tasks[i].period;
-            if(pScheduler->tasks[i].pTask != 0){
-                pScheduler->tasks[i].pTask();
+        // The head of the release queue is the task with the earliest release
+        SchedulerTask* pTask = &pScheduler->tasks[pScheduler->releaseQueue[0]];
+        uint32_t release = taskNextRelease(pTask);
+
+        // Signed difference, lastExecution lies in the future during the phase offset
+        if((int32_t) (nowTickTime - release) < 0){
+            break;
+        }
+
+        // Number of further releases which are already due as well
+        uint32_t lateReleases = (pTask->period > 0) ? (nowTickTime - release) / pTask->period : 0;
+        uint32_t missedReleases = 0;
+
+        if(pTask->overrunPolicy == SCHED_OVERRUN_CATCH_UP){
+            // The further releases are handled by the following iterations
+            pTask->lastExecution = release;
+            if(lateReleases > 0){
+                pTask->missedReleases++;
+            }
+        }
+        else{
+            missedReleases = lateReleases;
+            pTask->lastExecution = release + missedReleases * pTask->period;
+            pTask->missedReleases += missedReleases;
+        }
+        releaseQueueSiftDown(pScheduler, 0);
+
+#if SCHED_PROFILING_ENABLED
+        if(pScheduler->pGetCycleCount != 0){
+            // lastExecution now holds the ideal release time of this execution
+            uint32_t startJitter = nowTickTime - pTask->lastExecution;
+            uint32_t startCycles = pScheduler->pGetCycleCount();
+
+            taskExecute(pTask, missedReleases);
+
+            profileRecordExecution(pScheduler, pTask, pScheduler->pGetCycleCount() - startCycles, startJitter);
+        }
+        else{
+            taskExecute(pTask, missedReleases);
+        }
+#else
+        taskExecute(pTask, missedReleases);
+#endif
+
+        // Work posted meanwhile doesn't wait for the remaining releases
+        schedRunDeferredWork(pScheduler);
+
+        nowTickTime = pScheduler->pGetHALTick();
+    }
+
+    schedResumeCoroutines(pScheduler);
+
+    if(pScheduler->pIdle != 0 && pScheduler->registeredTaskCount > 0){
+        uint32_t ticksUntilNextRelease = 0;
+        schedGetTicksUntilNextRelease(pScheduler, &ticksUntilNextRelease);
+
+        uint32_t ticksUntilResume = schedTicksUntilCoroutineResume(pScheduler);
+        if(ticksUntilResume < ticksUntilNextRelease){
+            ticksUntilNextRelease = ticksUntilResume;
+        }
+
+        if(ticksUntilNextRelease > 0){
+            if(pScheduler->pDeferredWork != 0){
+                // An ISR posting work between the check and the sleep
+                // wakes the core up again, as its interrupt stays pending
+                uint32_t state = criticalEnter();
+                if(!schedDeferredWorkPending(pScheduler)){
+                    pScheduler->pIdle(ticksUntilNextRelease);
+                }
+                criticalExit(state);
+            }
+            else{
+                pScheduler->pIdle(ticksUntilNextRelease);
             }
         }
     }
@@ -88,6 +311,96 @@ int32_t schedCycle(Scheduler* pScheduler)
     return SCHED_ERR_OK;
 }
 
+int32_t schedGetTicksUntilNextRelease(Scheduler* pScheduler, uint32_t* pTicks)
+{
+    if(pScheduler == 0 || pTicks == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(pScheduler->pGetHALTick == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(pScheduler->registeredTaskCount == 0){
+        return SCHED_ERR_NO_TASKS;
+    }
+
+    const SchedulerTask* pTask = &pScheduler->tasks[pScheduler->releaseQueue[0]];
+    int32_t ticksUntilRelease = (int32_t) (taskNextRelease(pTask) - pScheduler->pGetHALTick());
+
+    *pTicks = (ticksUntilRelease <= 0) ? 0 : (uint32_t) ticksUntilRelease;
+
+    return SCHED_ERR_OK;
+}
+
+int32_t schedResumeCoroutinesOnce(Scheduler* pScheduler, uint32_t* pTicks)
+{
+    if(pScheduler == 0 || pTicks == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(pScheduler->pGetHALTick == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+
+    schedResumeCoroutines(pScheduler);
+    *pTicks = schedTicksUntilCoroutineResume(pScheduler);
+
+    return SCHED_ERR_OK;
+}
+
+int32_t schedPrintTimeline(Scheduler* pScheduler, PrintFunction printFunction)
+{
+    if(pScheduler == 0 || printFunction == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(pScheduler->registeredTaskCount == 0){
+        return SCHED_ERR_NO_TASKS;
+    }
+
+    uint32_t hyperperiod = schedHyperperiod(pScheduler);
+    uint32_t peakLoad = 0;
+    uint32_t peakTick = 0;
+
+    printFunction("Scheduler timeline (hyperperiod %u ticks)\n\r", (unsigned) hyperperiod);
+    printFunction("task  period  phase  budget[us]\n\r");
+    for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+        const SchedulerTask* pTask = &pScheduler->tasks[i];
+        printFunction("%4u  %6u  %5u  %10u%s\n\r", (unsigned) i, (unsigned) pTask->period, (unsigned) pTask->phase,
+            (unsigned) taskBudget(pScheduler, i), (pTask->configuredPhase == SCHED_PHASE_AUTO) ? " (auto)" : "");
+    }
+
+    printFunction("tick  load[us]  tasks\n\r");
+    for(uint32_t tick = 0; tick < hyperperiod; tick++){
+        uint32_t load = 0;
+        bool released = false;
+
+        for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+            if(taskReleasedAt(&pScheduler->tasks[i], tick)){
+                load += taskBudget(pScheduler, i);
+                released = true;
+            }
+        }
+        if(!released){
+            continue;
+        }
+
+        printFunction("%4u  %8u ", (unsigned) tick, (unsigned) load);
+        for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+            if(taskReleasedAt(&pScheduler->tasks[i], tick)){
+                printFunction(" %u", (unsigned) i);
+            }
+        }
+        printFunction("\n\r");
+
+        if(load > peakLoad){
+            peakLoad = load;
+            peakTick = tick;
+        }
+    }
+
+    printFunction("peak load %u us at tick %u\n\r", (unsigned) peakLoad, (unsigned) peakTick);
+
+    return SCHED_ERR_OK;
+}
+
 int32_t registerHALTickFunction(Scheduler* pScheduler, GetHALTick halTickFunction)
 {
     if(pScheduler == 0){
@@ -102,33 +415,496 @@ int32_t registerHALTickFunction(Scheduler* pScheduler, GetHALTick halTickFunctio
     return SCHED_ERR_OK;
 }
 
-int32_t registerTask(Scheduler *pScheduler, uint32_t period, CyclicFunction toRegisterFunction)
+int32_t registerIdleFunction(Scheduler* pScheduler, IdleFunction idleFunction)
 {
     if(pScheduler == 0){
         return SCHED_ERR_INVALID_PTR;
     }
-    if(isCyclicFunctionValid(toRegisterFunction) != FUNC_VALID){
+    if(idleFunction != 0 && isCyclicFunctionValid((CyclicFunction) idleFunction) != FUNC_VALID){
+        return SCHED_ERR_INVALID_FUNC_PTR;
+    }
+
+    pScheduler->pIdle = idleFunction;
+
+    return SCHED_ERR_OK;
+}
+
+int32_t registerDeferredWorkQueue(Scheduler* pScheduler, DeferredWorkQueue* pQueue)
+{
+    if(pScheduler == 0 || pQueue == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+
+    // Insert sorted by priority, behind the queues with the same priority
+    DeferredWorkQueue** ppPosition = &pScheduler->pDeferredWork;
+    while(*ppPosition != 0 && (*ppPosition)->priority <= pQueue->priority){
+        if(*ppPosition == pQueue){
+            return SCHED_ERR_INVALID_PARAM;
+        }
+        ppPosition = &(*ppPosition)->pNext;
+    }
+
+    pQueue->pNext = *ppPosition;
+    *ppPosition = pQueue;
+
+    return SCHED_ERR_OK;
+}
+
+int32_t registerCoroutine(Scheduler* pScheduler, Coroutine* pCoroutine, CoroutineFunction coroutineFunction)
+{
+    if(pScheduler == 0 || pCoroutine == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(isCyclicFunctionValid((CyclicFunction) coroutineFunction) != FUNC_VALID){
         return SCHED_ERR_INVALID_FUNC_PTR;
     }
+
+    Coroutine** ppPosition = &pScheduler->pCoroutines;
+    while(*ppPosition != 0){
+        if(*ppPosition == pCoroutine){
+            return SCHED_ERR_INVALID_PARAM;
+        }
+        ppPosition = &(*ppPosition)->pNext;
+    }
+
+    pCoroutine->pFunction = coroutineFunction;
+    pCoroutine->pNext = 0;
+    CO_RESTART(pCoroutine);
+    *ppPosition = pCoroutine;
+
+    return SCHED_ERR_OK;
+}
+
+int32_t registerTask(Scheduler *pScheduler, uint32_t period, CyclicFunction toRegisterFunction)
+{
+    SchedulerTaskConfig config = {
+        .period = period,
+        .pTask = toRegisterFunction,
+        .pCoalescingTask = 0,
+        .overrunPolicy = SCHED_OVERRUN_CATCH_UP,
+        .phase = 0,
+        .budgetMicroseconds = 0,
+    };
+
+    return registerTaskConfig(pScheduler, &config);
+}
+
+int32_t registerTaskConfig(Scheduler* pScheduler, const SchedulerTaskConfig* pConfig)
+{
+    if(pScheduler == 0 || pConfig == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(pConfig->overrunPolicy == SCHED_OVERRUN_COALESCE){
+        if(pConfig->pTask != 0){
+            return SCHED_ERR_INVALID_PARAM;
+        }
+        if(isCyclicFunctionValid((CyclicFunction) pConfig->pCoalescingTask) != FUNC_VALID){
+            return SCHED_ERR_INVALID_FUNC_PTR;
+        }
+    }
+    else if(pConfig->overrunPolicy == SCHED_OVERRUN_CATCH_UP || pConfig->overrunPolicy == SCHED_OVERRUN_SKIP_TO_NOW){
+        if(pConfig->pCoalescingTask != 0){
+            return SCHED_ERR_INVALID_PARAM;
+        }
+        if(isCyclicFunctionValid(pConfig->pTask) != FUNC_VALID){
+            return SCHED_ERR_INVALID_FUNC_PTR;
+        }
+    }
+    else{
+        return SCHED_ERR_INVALID_PARAM;
+    }
     if(pScheduler->registeredTaskCount >= MAX_SCHEDULER_TASKS){
         return SCHED_ERR_MAX_TASKS_REACHED;
     }
 
-    pScheduler->tasks[pScheduler->registeredTaskCount].period = period;
-    pScheduler->tasks[pScheduler->registeredTaskCount].pTask = toRegisterFunction;
-    pScheduler->tasks[pScheduler->registeredTaskCount].lastExecution = 0;
+    SchedulerTask* pTask = &pScheduler->tasks[pScheduler->registeredTaskCount];
+    pTask->period = pConfig->period;
+    pTask->pTask = pConfig->pTask;
+    pTask->pCoalescingTask = pConfig->pCoalescingTask;
+    pTask->overrunPolicy = pConfig->overrunPolicy;
+    pTask->lastExecution = 0;
+    pTask->configuredPhase = pConfig->phase;
+    pTask->phase = (pConfig->phase == SCHED_PHASE_AUTO) ? 0 : pConfig->phase;
+    pTask->budgetMicroseconds = pConfig->budgetMicroseconds;
+    pTask->missedReleases = 0;
+#if SCHED_PROFILING_ENABLED
+    profileReset(&pTask->profile);
+#endif
+
+    pScheduler->releaseQueue[pScheduler->registeredTaskCount] = (uint8_t) pScheduler->registeredTaskCount;
+    releaseQueueSiftUp(pScheduler, pScheduler->registeredTaskCount);
 
     pScheduler->registeredTaskCount++;
     return SCHED_ERR_OK;
 }
 
+int32_t schedGetMissedReleases(Scheduler* pScheduler, uint32_t taskIndex, uint32_t* pMissedReleases)
+{
+    if(pScheduler == 0 || pMissedReleases == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(taskIndex >= pScheduler->registeredTaskCount){
+        return SCHED_ERR_NO_TASKS;
+    }
+
+    *pMissedReleases = pScheduler->tasks[taskIndex].missedReleases;
+
+    return SCHED_ERR_OK;
+}
+
+#if SCHED_PROFILING_ENABLED
+int32_t registerCycleCounterFunction(Scheduler* pScheduler, GetCycleCount cycleCountFunction, uint32_t cyclesPerTick)
+{
+    if(pScheduler == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(cycleCountFunction != 0 && isCyclicFunctionValid((CyclicFunction) cycleCountFunction) != FUNC_VALID){
+        return SCHED_ERR_INVALID_FUNC_PTR;
+    }
+
+    pScheduler->pGetCycleCount = cycleCountFunction;
+    pScheduler->cyclesPerTick = cyclesPerTick;
+
+    return SCHED_ERR_OK;
+}
+
+int32_t schedGetTaskProfile(Scheduler* pScheduler, uint32_t taskIndex, SchedulerTaskProfile* pProfile)
+{
+    if(pScheduler == 0 || pProfile == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+    if(taskIndex >= pScheduler->registeredTaskCount){
+        return SCHED_ERR_NO_TASKS;
+    }
+
+    *pProfile = pScheduler->tasks[taskIndex].profile;
+
+    if(pProfile->runCount > 0){
+        pProfile->meanCycles = (uint32_t) (pProfile->totalCycles / pProfile->runCount);
+    }
+
+    return SCHED_ERR_OK;
+}
+
+int32_t schedResetTaskProfiles(Scheduler* pScheduler)
+{
+    if(pScheduler == 0){
+        return SCHED_ERR_INVALID_PTR;
+    }
+
+    for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+        profileReset(&pScheduler->tasks[i].profile);
+    }
+
+    return SCHED_ERR_OK;
+}
+#endif
+
 /***** PRIVATE FUNCTIONS *****************************************************/
 
 static uint8_t isCyclicFunctionValid(CyclicFunction toCheckFunction)
 {
-    if((uint32_t) &_stext <= (uint32_t) toCheckFunction && (uint32_t) toCheckFunction <= (uint32_t) &_etext){
+    if((uintptr_t) &_stext <= (uintptr_t) toCheckFunction && (uintptr_t) toCheckFunction <= (uintptr_t) &_etext){
         return FUNC_VALID;
     }
 
     return FUNC_NOT_VALID;
-}
\ No newline at end of file
+}
+
+static inline uint32_t taskNextRelease(const SchedulerTask* pTask)
+{
+    return pTask->lastExecution + pTask->period;
+}
+
+static bool releasesBefore(const Scheduler* pScheduler, uint8_t taskIndexA, uint8_t taskIndexB)
+{
+    // Signed difference to handle the overflow of the tick counter
+    int32_t difference = (int32_t) (taskNextRelease(&pScheduler->tasks[taskIndexA]) - taskNextRelease(&pScheduler->tasks[taskIndexB]));
+
+    if(difference != 0){
+        return difference < 0;
+    }
+
+    return taskIndexA < taskIndexB;
+}
+
+static void releaseQueueSiftUp(Scheduler* pScheduler, uint32_t position)
+{
+    uint8_t* pQueue = pScheduler->releaseQueue;
+
+    while(position > 0){
+        uint32_t parent = (position - 1) / 2;
+        if(!releasesBefore(pScheduler, pQueue[position], pQueue[parent])){
+            break;
+        }
+
+        uint8_t swap = pQueue[parent];
+        pQueue[parent] = pQueue[position];
+        pQueue[position] = swap;
+        position = parent;
+    }
+}
+
+static void releaseQueueSiftDown(Scheduler* pScheduler, uint32_t position)
+{
+    uint8_t* pQueue = pScheduler->releaseQueue;
+    uint32_t count = pScheduler->registeredTaskCount;
+
+    while(true){
+        uint32_t smallest = position;
+        uint32_t left = 2 * position + 1;
+        uint32_t right = left + 1;
+
+        if(left < count && releasesBefore(pScheduler, pQueue[left], pQueue[smallest])){
+            smallest = left;
+        }
+        if(right < count && releasesBefore(pScheduler, pQueue[right], pQueue[smallest])){
+            smallest = right;
+        }
+        if(smallest == position){
+            break;
+        }
+
+        uint8_t swap = pQueue[smallest];
+        pQueue[smallest] = pQueue[position];
+        pQueue[position] = swap;
+        position = smallest;
+    }
+}
+
+static void taskExecute(const SchedulerTask* pTask, uint32_t missedReleases)
+{
+    if(pTask->overrunPolicy == SCHED_OVERRUN_COALESCE){
+        if(pTask->pCoalescingTask != 0){
+            pTask->pCoalescingTask(missedReleases);
+        }
+    }
+    else if(pTask->pTask != 0){
+        pTask->pTask();
+    }
+}
+
+static void schedRunDeferredWork(Scheduler* pScheduler)
+{
+    for(uint32_t i = 0; i < SCHED_DEFERRED_WORK_BUDGET; i++){
+        DeferredWorkQueue* pQueue = pScheduler->pDeferredWork;
+        while(pQueue != 0 && !deferredWorkPending(pQueue)){
+            pQueue = pQueue->pNext;
+        }
+        if(pQueue == 0){
+            return;
+        }
+
+        deferredWorkRunOne(pQueue);
+    }
+}
+
+static bool schedDeferredWorkPending(const Scheduler* pScheduler)
+{
+    for(const DeferredWorkQueue* pQueue = pScheduler->pDeferredWork; pQueue != 0; pQueue = pQueue->pNext){
+        if(deferredWorkPending(pQueue)){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void schedResumeCoroutines(Scheduler* pScheduler)
+{
+    for(Coroutine* pCoroutine = pScheduler->pCoroutines; pCoroutine != 0; pCoroutine = pCoroutine->pNext){
+        if(pCoroutine->state == CO_STATE_ENDED){
+            continue;
+        }
+
+        pCoroutine->now = pScheduler->pGetHALTick();
+
+        // Sleeping coroutines are only resumed once their time is up
+        if(pCoroutine->state == CO_STATE_SLEEPING && (int32_t) (pCoroutine->now - pCoroutine->wakeTick) < 0){
+            continue;
+        }
+
+        pCoroutine->state = pCoroutine->pFunction(pCoroutine);
+    }
+}
+
+static uint32_t schedTicksUntilCoroutineResume(const Scheduler* pScheduler)
+{
+    uint32_t ticks = UINT32_MAX;
+    uint32_t now = pScheduler->pGetHALTick();
+
+    for(const Coroutine* pCoroutine = pScheduler->pCoroutines; pCoroutine != 0; pCoroutine = pCoroutine->pNext){
+        if(pCoroutine->state == CO_STATE_YIELDED){
+            return 0;
+        }
+        if(pCoroutine->state == CO_STATE_SLEEPING){
+            int32_t remaining = (int32_t) (pCoroutine->wakeTick - now);
+            uint32_t coroutineTicks = (remaining > 0) ? (uint32_t) remaining : 0;
+
+            if(coroutineTicks < ticks){
+                ticks = coroutineTicks;
+            }
+        }
+    }
+
+    return ticks;
+}
+
+static uint32_t taskBudget(const Scheduler* pScheduler, uint32_t taskIndex)
+{
+    const SchedulerTask* pTask = &pScheduler->tasks[taskIndex];
+
+    if(pTask->budgetMicroseconds > 0){
+        return pTask->budgetMicroseconds;
+    }
+
+#if SCHED_PROFILING_ENABLED
+    // One tick is one millisecond
+    if(pTask->profile.runCount > 0 && pScheduler->cyclesPerTick > 0){
+        return (uint32_t) (((uint64_t) pTask->profile.maxCycles * 1000) / pScheduler->cyclesPerTick);
+    }
+#endif
+
+    return 0;
+}
+
+static uint32_t schedHyperperiod(const Scheduler* pScheduler)
+{
+    uint32_t hyperperiod = 1;
+
+    for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+        uint32_t period = pScheduler->tasks[i].period;
+        if(period == 0){
+            continue;
+        }
+
+        // lcm(a, b) = a / gcd(a, b) * b
+        uint32_t a = hyperperiod;
+        uint32_t b = period;
+        while(b != 0){
+            uint32_t remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+
+        uint64_t lcm = (uint64_t) (hyperperiod / a) * period;
+        if(lcm > SCHED_MAX_HYPERPERIOD){
+            return SCHED_MAX_HYPERPERIOD;
+        }
+        hyperperiod = (uint32_t) lcm;
+    }
+
+    return hyperperiod;
+}
+
+static bool taskReleasedAt(const SchedulerTask* pTask, uint32_t tick)
+{
+    if(pTask->period == 0){
+        return true;
+    }
+
+    return (tick % pTask->period) == (pTask->phase % pTask->period);
+}
+
+static void schedAutoPhase(Scheduler* pScheduler)
+{
+    bool placed[MAX_SCHEDULER_TASKS];
+    uint32_t hyperperiod = schedHyperperiod(pScheduler);
+
+    for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+        SchedulerTask* pTask = &pScheduler->tasks[i];
+        placed[i] = (pTask->configuredPhase != SCHED_PHASE_AUTO || pTask->period == 0);
+        if(pTask->configuredPhase == SCHED_PHASE_AUTO){
+            pTask->phase = 0;
+        }
+    }
+
+    while(true){
+        // Place the task with the largest budget next, ties by shorter period
+        uint32_t next = MAX_SCHEDULER_TASKS;
+        for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+            if(placed[i]){
+                continue;
+            }
+            if(next == MAX_SCHEDULER_TASKS
+                || taskBudget(pScheduler, i) > taskBudget(pScheduler, next)
+                || (taskBudget(pScheduler, i) == taskBudget(pScheduler, next) && pScheduler->tasks[i].period < pScheduler->tasks[next].period)){
+                next = i;
+            }
+        }
+        if(next == MAX_SCHEDULER_TASKS){
+            break;
+        }
+
+        // Only the ticks at which the task is released change the peak, so
+        // the candidate with the smallest maximum load at its releases wins.
+        // Tasks without a known budget count as 1 µs to spread them as well.
+        SchedulerTask* pTask = &pScheduler->tasks[next];
+        uint32_t bestPhase = 0;
+        uint32_t bestPeak = UINT32_MAX;
+
+        for(uint32_t phase = 0; phase < pTask->period && phase < hyperperiod; phase++){
+            uint32_t peak = 0;
+
+            for(uint32_t tick = phase; tick < hyperperiod; tick += pTask->period){
+                uint32_t load = 0;
+                for(uint32_t i = 0; i < pScheduler->registeredTaskCount; i++){
+                    if(placed[i] && taskReleasedAt(&pScheduler->tasks[i], tick)){
+                        uint32_t budget = taskBudget(pScheduler, i);
+                        load += (budget > 0) ? budget : 1;
+                    }
+                }
+                if(load > peak){
+                    peak = load;
+                }
+            }
+
+            if(peak < bestPeak){
+                bestPeak = peak;
+                bestPhase = phase;
+            }
+        }
+
+        pTask->phase = bestPhase;
+        placed[next] = true;
+    }
+}
+
+#if SCHED_PROFILING_ENABLED
+static void profileRecordExecution(Scheduler* pScheduler, SchedulerTask* pTask, uint32_t cycles, uint32_t startJitter)
+{
+    SchedulerTaskProfile* pProfile = &pTask->profile;
+
+    pProfile->runCount++;
+    pProfile->totalCycles += cycles;
+    pProfile->totalStartJitter += startJitter;
+
+    if(cycles < pProfile->minCycles){
+        pProfile->minCycles = cycles;
+    }
+    if(cycles > pProfile->maxCycles){
+        pProfile->maxCycles = cycles;
+    }
+    if(startJitter > pProfile->maxStartJitter){
+        pProfile->maxStartJitter = startJitter;
+    }
+    if(pScheduler->cyclesPerTick > 0 && cycles / pScheduler->cyclesPerTick >= pTask->period){
+        pProfile->overrunCount++;
+    }
+
+    // Index of the highest set bit gives the log2 bin
+    uint32_t bin = 0;
+    uint32_t value = cycles >> (SCHED_PROFILE_HISTOGRAM_SHIFT + 1);
+    while(value != 0 && bin < SCHED_PROFILE_HISTOGRAM_BINS - 1){
+        value >>= 1;
+        bin++;
+    }
+    pProfile->histogram[bin]++;
+}
+
+static void profileReset(SchedulerTaskProfile* pProfile)
+{
+    *pProfile = (SchedulerTaskProfile) {0};
+    pProfile->minCycles = UINT32_MAX;
+}
+#endif
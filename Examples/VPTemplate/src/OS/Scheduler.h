@@ -19,6 +19,9 @@
 /***** INCLUDES **************************************************************/
 #include <stdint.h>
 
+#include "Coroutine.h"
+#include "DeferredWork.h"
+
 /***** CONSTANTS *************************************************************/
 const extern uint32_t _stext;                        //!< Symbol from linker file to detect invalid function pointers
 const extern uint32_t _etext;                        //!< Symbol from linker file to detect invalid function pointers
@@ -29,8 +32,33 @@ const extern uint32_t _etext;                        //!< Symbol from linker fil
 #define SCHED_ERR_INVALID_PTR       -1          //!< Invalid pointer (Scheduler)
 #define SCHED_ERR_INVALID_FUNC_PTR  -2          //!< Invalid function pointer
 #define SCHED_ERR_MAX_TASKS_REACHED -3          //!< Maximum number of tasks reached
+#define SCHED_ERR_NO_TASKS          -4          //!< No task registered
+#define SCHED_ERR_INVALID_PARAM     -5          //!< Invalid parameter (e.g. unknown overrun policy)
 
+#ifndef MAX_SCHEDULER_TASKS
 #define MAX_SCHEDULER_TASKS 6                   //!< Maximum number of tasks in the scheduler
+#endif
+
+#if MAX_SCHEDULER_TASKS > 255
+#error "MAX_SCHEDULER_TASKS must fit into the uint8_t release queue entries"
+#endif
+
+#ifndef SCHED_PROFILING_ENABLED
+#define SCHED_PROFILING_ENABLED     1           //!< Enable the per task execution time profiling
+#endif
+
+#ifndef SCHED_MAX_HYPERPERIOD
+#define SCHED_MAX_HYPERPERIOD       10000       //!< Upper limit (ticks) of the hyperperiod used for the auto phasing and the timeline
+#endif
+
+#ifndef SCHED_DEFERRED_WORK_BUDGET
+#define SCHED_DEFERRED_WORK_BUDGET  32          //!< Maximum number of deferred work items run before the next task release is checked
+#endif
+
+#define SCHED_PHASE_AUTO            0xFFFFFFFF  //!< Phase of the task is calculated by the auto phasing
+
+#define SCHED_PROFILE_HISTOGRAM_BINS    16      //!< Number of bins of the execution time histogram
+#define SCHED_PROFILE_HISTOGRAM_SHIFT   6       //!< Bin 0 covers [0, 2^7) cycles, bin n covers [2^(n+6), 2^(n+7)) cycles
 
 
 /***** TYPES *****************************************************************/
@@ -51,6 +79,96 @@ typedef uint32_t (*GetHALTick)(void);
  */
 typedef void (*CyclicFunction)(void);
 
+/**
+ * @brief Function pointer for the idle function of the scheduler
+ *
+ * The function is called when no task is due and may put the core into a
+ * low power mode for (at most) the given number of ticks. Like the HAL tick
+ * function, this decouples the scheduler from the HAL implementation.
+ *
+ * If deferred work queues are registered, the function is called with the
+ * interrupts disabled, so that no work item posted after the last check is
+ * slept over. The low power mode must still be left on a pending interrupt
+ * (which is the case for WFI).
+ *
+ */
+typedef void (*IdleFunction)(uint32_t ticksUntilNextRelease);
+
+/**
+ * @brief Function pointer for a cyclic function which gets the number of
+ * missed releases passed (SCHED_OVERRUN_COALESCE)
+ *
+ */
+typedef void (*CoalescingFunction)(uint32_t missedReleases);
+
+/**
+ * @brief Function pointer for a printf like output function (e.g. outputLogf)
+ *
+ */
+typedef int (*PrintFunction)(const char* format, ...);
+
+/**
+ * @brief Policy how a task is released after it missed one or more releases
+ * (e.g. after a long blocking call in another task)
+ *
+ */
+typedef enum _SchedOverrunPolicy
+{
+    SCHED_OVERRUN_CATCH_UP = 0,     //!< Every missed release is executed, back-to-back
+    SCHED_OVERRUN_SKIP_TO_NOW,      //!< Missed releases are dropped, the task is executed once
+    SCHED_OVERRUN_COALESCE,         //!< Like SKIP_TO_NOW, but the task gets the number of missed releases
+} SchedOverrunPolicy;
+
+/**
+ * @brief Configuration of a task for registerTaskConfig()
+ *
+ * Exactly one of pTask and pCoalescingTask has to be set, pCoalescingTask
+ * is only allowed (and required) with SCHED_OVERRUN_COALESCE.
+ *
+ * The first release of the task is phase + period ticks after
+ * schedInitialize(). With SCHED_PHASE_AUTO the phase is chosen by
+ * schedInitialize() so that the peak load per tick is minimal.
+ *
+ */
+typedef struct _SchedulerTaskConfig
+{
+    uint32_t period;                        //!< Period of the task in milliseconds
+    CyclicFunction pTask;                   //!< Function pointer to cyclic task function
+    CoalescingFunction pCoalescingTask;     //!< Function pointer to cyclic task function with missed count
+    SchedOverrunPolicy overrunPolicy;       //!< Policy for missed releases
+    uint32_t phase;                         //!< Release offset in ticks or SCHED_PHASE_AUTO
+    uint32_t budgetMicroseconds;            //!< Declared execution time budget (0 = unknown)
+} SchedulerTaskConfig;
+
+#if SCHED_PROFILING_ENABLED
+/**
+ * @brief Function pointer for reading a free running cycle counter
+ * (e.g. DWT CYCCNT) used for the execution time profiling
+ *
+ */
+typedef uint32_t (*GetCycleCount)(void);
+
+/**
+ * @brief Execution time profile of a task
+ *
+ * The execution time is measured in cycles of the registered cycle counter,
+ * the start jitter (delay between ideal release and start) in ticks.
+ *
+ */
+typedef struct _SchedulerTaskProfile
+{
+    uint32_t runCount;                  //!< Number of measured executions
+    uint32_t minCycles;                 //!< Minimum execution time
+    uint32_t maxCycles;                 //!< Maximum execution time
+    uint32_t meanCycles;                //!< Mean execution time (only filled by schedGetTaskProfile())
+    uint64_t totalCycles;               //!< Sum of all execution times
+    uint32_t maxStartJitter;            //!< Maximum delay between ideal release and start of the task
+    uint32_t totalStartJitter;          //!< Sum of all start delays
+    uint32_t overrunCount;              //!< Number of executions which took longer than the period
+    uint32_t histogram[SCHED_PROFILE_HISTOGRAM_BINS];   //!< log2 histogram of the execution times
+} SchedulerTaskProfile;
+#endif
+
 /**
  * @brief Struct definition for a task in the scheduler
  *
@@ -59,20 +177,43 @@ typedef struct _SchedulerTask
 {
     uint32_t period;            //!< Period of the task in milliseconds
     CyclicFunction pTask;       //!< Function pointer to cyclic task function
+    CoalescingFunction pCoalescingTask;     //!< Function pointer to cyclic task function with missed count
+    SchedOverrunPolicy overrunPolicy;       //!< Policy for missed releases
     uint32_t lastExecution;     //!< Timestamp for last execution of task
+    uint32_t configuredPhase;   //!< Phase from the task configuration (may be SCHED_PHASE_AUTO)
+    uint32_t phase;             //!< Release offset in ticks, which is applied by schedInitialize()
+    uint32_t budgetMicroseconds;    //!< Declared execution time budget (0 = unknown)
+    uint32_t missedReleases;    //!< Number of releases which were executed late by at least one period or were skipped
+#if SCHED_PROFILING_ENABLED
+    SchedulerTaskProfile profile;   //!< Execution time profile of the task
+#endif
 } SchedulerTask;
 
 /**
  * @brief Struct definition which holds the HAL tick
  * time stamps for the different tasks
  *
+ * The release queue is a binary min-heap of task indices ordered by the
+ * next release time (lastExecution + period) of the tasks. Therefore the
+ * task at releaseQueue[0] is always the next one to be released.
+ *
  */
 typedef struct _Scheduler
 {
     GetHALTick pGetHALTick;             //!< Function pointer for callback to read current HAL tick counter
+    IdleFunction pIdle;                 //!< Optional function pointer which is called if no task is due
+    DeferredWorkQueue* pDeferredWork;   //!< List of the deferred work queues, ordered by priority
+    Coroutine* pCoroutines;             //!< List of the coroutines, resumed in registration order
 
     SchedulerTask tasks[MAX_SCHEDULER_TASKS];    //!< Array of tasks
     uint32_t registeredTaskCount;               //!< Number of registered tasks
+
+    uint8_t releaseQueue[MAX_SCHEDULER_TASKS];  //!< Min-heap of task indices ordered by next release time
+
+#if SCHED_PROFILING_ENABLED
+    GetCycleCount pGetCycleCount;       //!< Function pointer to read the cycle counter for the profiling
+    uint32_t cyclesPerTick;             //!< Cycles per tick, used to detect overruns
+#endif
 } Scheduler;
 
 
@@ -83,6 +224,13 @@ typedef struct _Scheduler
  * @brief Initializes the Scheduler component
  * Initializes the internal values for the timestamps.
  *
+ * The phases of the tasks registered with SCHED_PHASE_AUTO are calculated
+ * greedily (largest budget first): every task gets the phase which
+ * minimises the peak load per tick over the hyperperiod. The budget of a
+ * task is the declared budget or, if none is declared, the measured
+ * maximum execution time (profiling). Calling schedInitialize() again after
+ * some time therefore re-phases the tasks with the measured budgets.
+ *
  * @remark: This function doesn't initialize the function
  * pointers in the Scheduler struct!
  *
@@ -98,12 +246,57 @@ int32_t schedInitialize(Scheduler* pScheduler);
  * Hereby the scheduler takes care of the different time slots for
  * the tasks
  *
+ * Only the task with the earliest release time is checked, so a call
+ * without any due task costs O(1) independent of the number of tasks.
+ * At most registeredTaskCount releases are handled per call. Afterwards
+ * the coroutines are resumed and the idle function (if registered) is
+ * called with the number of ticks until the next release or coroutine
+ * wake up. A yielded coroutine prevents the idle function.
+ *
  * @param pScheduler Pointer to scheduler struct
  *
  * @return SCHED_ERR_OK if no error occured
  */
 int32_t schedCycle(Scheduler* pScheduler);
 
+/**
+ * @brief Returns the number of ticks until the next task release
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param pTicks Pointer which receives the number of ticks until the
+ * next release (0 if a task is already due)
+ *
+ * @return SCHED_ERR_OK if no error occured, SCHED_ERR_NO_TASKS if no task
+ * is registered
+ */
+int32_t schedGetTicksUntilNextRelease(Scheduler* pScheduler, uint32_t* pTicks);
+
+/**
+ * @brief Resumes the registered coroutines once, like schedCycle() does after
+ * the task releases. Used by the idle thread of the kernel, which replaces
+ * schedCycle().
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param pTicks Pointer which receives the number of ticks until a coroutine
+ * has to be resumed again (0 if one yielded, UINT32_MAX if none is waiting
+ * for a certain time)
+ *
+ * @return SCHED_ERR_OK if no error occured
+ */
+int32_t schedResumeCoroutinesOnce(Scheduler* pScheduler, uint32_t* pTicks);
+
+/**
+ * @brief Prints the releases of all tasks during one hyperperiod together
+ * with the load (sum of the budgets) per tick
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param printFunction printf like function used for the output
+ *
+ * @return SCHED_ERR_OK if no error occured, SCHED_ERR_NO_TASKS if no task
+ * is registered
+ */
+int32_t schedPrintTimeline(Scheduler* pScheduler, PrintFunction printFunction);
+
 /**
  * @brief Registers the function, which gets called by the scheduler,
  *        to determine the time
@@ -115,6 +308,17 @@ int32_t schedCycle(Scheduler* pScheduler);
  */
 int32_t registerHALTickFunction(Scheduler* pScheduler, GetHALTick halTickFunction);
 
+/**
+ * @brief Registers the function, which gets called by the scheduler
+ *        if no task is due (e.g. to enter a low power mode)
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param idleFunction The function, which gets registered (0 to disable)
+ *
+ * @return SCHED_ERR_OK if not error eccured
+ */
+int32_t registerIdleFunction(Scheduler* pScheduler, IdleFunction idleFunction);
+
 /**
  * @brief Registers a task in the scheduler
  * 
@@ -126,5 +330,93 @@ int32_t registerHALTickFunction(Scheduler* pScheduler, GetHALTick halTickFunctio
  */
 int32_t registerTask(Scheduler* pScheduler, uint32_t period, CyclicFunction toRegisterFunction);
 
+/**
+ * @brief Registers a deferred work queue. The work items of all queues are
+ * run by schedCycle() ahead of the periodic tasks, higher priority queues
+ * first.
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param pQueue Pointer to the initialized queue
+ *
+ * @return SCHED_ERR_OK if not error eccured
+ */
+int32_t registerDeferredWorkQueue(Scheduler* pScheduler, DeferredWorkQueue* pQueue);
+
+/**
+ * @brief Registers and starts a coroutine, which is resumed by schedCycle()
+ * after the task releases (in kernel mode by the idle thread)
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param pCoroutine Pointer to the coroutine control block
+ * @param coroutineFunction Body of the coroutine
+ *
+ * @return SCHED_ERR_OK if not error eccured
+ */
+int32_t registerCoroutine(Scheduler* pScheduler, Coroutine* pCoroutine, CoroutineFunction coroutineFunction);
+
+/**
+ * @brief Registers a task with the given configuration
+ *
+ * @remark: registerTask() registers the task with SCHED_OVERRUN_CATCH_UP
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param pConfig Pointer to the task configuration
+ *
+ * @return SCHED_ERR_OK if not error eccured, SCHED_ERR_INVALID_PARAM if
+ * the overrun policy does not match the function pointers
+ */
+int32_t registerTaskConfig(Scheduler* pScheduler, const SchedulerTaskConfig* pConfig);
+
+/**
+ * @brief Returns the number of missed releases of a task
+ *
+ * With SCHED_OVERRUN_CATCH_UP a release is counted as missed, if it was
+ * executed at least one period after its release time. With the other
+ * policies every skipped release is counted.
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param taskIndex Index of the task (registration order)
+ * @param pMissedReleases Pointer which receives the number of missed releases
+ *
+ * @return SCHED_ERR_OK if not error eccured, SCHED_ERR_NO_TASKS if there
+ * is no task with that index
+ */
+int32_t schedGetMissedReleases(Scheduler* pScheduler, uint32_t taskIndex, uint32_t* pMissedReleases);
+
+#if SCHED_PROFILING_ENABLED
+/**
+ * @brief Registers the cycle counter which is used to profile the tasks.
+ *        Without a cycle counter, no profiling data is recorded.
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param cycleCountFunction The function, which reads the cycle counter
+ * @param cyclesPerTick Number of counter cycles per tick
+ *
+ * @return SCHED_ERR_OK if not error eccured
+ */
+int32_t registerCycleCounterFunction(Scheduler* pScheduler, GetCycleCount cycleCountFunction, uint32_t cyclesPerTick);
+
+/**
+ * @brief Returns the execution time profile of a task
+ *
+ * @param pScheduler Pointer to scheduler struct
+ * @param taskIndex Index of the task (registration order)
+ * @param pProfile Pointer to the struct which receives the profile
+ *
+ * @return SCHED_ERR_OK if not error eccured, SCHED_ERR_NO_TASKS if there
+ * is no task with that index
+ */
+int32_t schedGetTaskProfile(Scheduler* pScheduler, uint32_t taskIndex, SchedulerTaskProfile* pProfile);
+
+/**
+ * @brief Resets the execution time profiles of all tasks
+ *
+ * @param pScheduler Pointer to scheduler struct
+ *
+ * @return SCHED_ERR_OK if not error eccured
+ */
+int32_t schedResetTaskProfiles(Scheduler* pScheduler);
+#endif
+
 
 #endif
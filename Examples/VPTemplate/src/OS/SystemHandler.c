@@ -17,6 +17,8 @@
 /***** INCLUDES **************************************************************/
 #include "stm32g4xx_hal.h"
 
+#include "Kernel.h"
+
 /***** PRIVATE CONSTANTS *****************************************************/
 
 
@@ -51,6 +53,7 @@ void NMI_Handler(void)
 {
 }
 
+#if !KERNEL_PREEMPTIVE_ENABLED
 /**
  * @brief Default-Implementation of SVC Handler
  *
@@ -76,13 +79,15 @@ void SVC_Handler(void)
 void PendSV_Handler(void)
 {
 }
+#endif // The kernel implements SVC_Handler and PendSV_Handler for the context switch
 
 /**
  * @brief Default-Implementation of SysTick Handler
  *
  * This handler is called for every "tick" of the SysTick
- * timer. Currently, only the internal Tick-Counter for
- * the HAL is updated
+ * timer. The internal Tick-Counter for the HAL is updated
+ * and, in kernel mode, the delays and timeouts of the
+ * threads are handled
  *
  * According Programming Manual:
  * A SysTick exception is an exception the system timer generates
@@ -94,6 +99,10 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
   HAL_IncTick();
+
+#if KERNEL_PREEMPTIVE_ENABLED
+  kernelTick();
+#endif
 }
 
 /**
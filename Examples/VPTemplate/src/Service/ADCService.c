@@ -12,6 +12,9 @@
 
 #include "ADCService.h"
 #include "../HAL/ADCModule.h"
+#include "Util/Filter/Filter.h"
+
+#include <stdbool.h>
 
 /***** PRIVATE CONSTANTS *****************************************************/
 
@@ -19,48 +22,170 @@
 /***** PRIVATE MACROS ********************************************************/
 
 /**
- * @brief   Inverse of the alpha value for the exponential moving average filter of the first potentiometer
- *          Inverse is used to avoid floating point arithmetic
+ * @brief   Alpha value of the exponential moving average filter of the first potentiometer as power of two
+ *          alpha = 1 / 2^POT1_EMA_SHIFT, the filter needs only a shift instead of a division
  */
-#define POT1_EMA_ALPHA_INV 5
+#define POT1_EMA_SHIFT 2
 
 /**
- * @brief   Number of iterations to initialize the first potentiometer
- *          At a = 0.2 this guarantees that the filter output is within 5% of the input after the initialization
+ * @brief Size of the moving average filter for the second potentiometer
  */
-#define POT1_INIT_ITERATIONS 32
+#define POT2_WINDOW_SIZE    5
 
 /**
- * @brief Size of the moving average filter for the second potentiometer
+ * @brief Window of the median filters in front of both potentiometer filters
+ *        A spike in up to (POT_MEDIAN_WINDOW_SIZE - 1) / 2 consecutive blocks is rejected,
+ *        the median delays the values by that number of blocks
  */
-#define POT2_WINDOW_SIZE    5
+#define POT_MEDIAN_WINDOW_SIZE  5
+
+/**
+ * @brief VBAT is measured through the internal VBAT/3 bridge
+ */
+#define VBAT_DIVIDER            3
 
 /***** PRIVATE TYPES *********************************************************/
 
 
 /***** PRIVATE PROTOTYPES ****************************************************/
 
-
-/***** PRIVATE VARIABLES *****************************************************/
+static int32_t averageBlock(const ADCBlock_t* pBlock, ADC_Channel_t channel);
+static bool readChannelVoltage(ADC_Channel_t channel, uint16_t* pLastCount, int32_t* pMicrovolt);
 
 
-/***** PUBLIC FUNCTIONS ******************************************************/
+/***** PRIVATE VARIABLES *****************************************************/
 
 static int32_t s_pot1Value = 0;
 static int32_t s_pot2Value = 0;
+static EMAFilterData_t s_pot1Filter;                    //!< Exponential moving average filter of the first potentiometer
+static MovingAverageData_t s_pot2Filter;                //!< Moving average filter of the second potentiometer
+static int32_t s_pot2Window[POT2_WINDOW_SIZE];          //!< Window of the moving average filter of the second potentiometer
+static MedianFilterData_t s_pot1Median;                 //!< Outlier rejection of the first potentiometer
+static MedianFilterData_t s_pot2Median;                 //!< Outlier rejection of the second potentiometer
+static MedianFilterNode_t s_pot1MedianNodes[POT_MEDIAN_WINDOW_SIZE];    //!< Window of the median filter of the first potentiometer
+static MedianFilterNode_t s_pot2MedianNodes[POT_MEDIAN_WINDOW_SIZE];    //!< Window of the median filter of the second potentiometer
+static uint32_t s_lastSequence = 0;         //!< Number of the last filtered ADC conversion sequence
+static uint32_t s_skippedFrames = 0;        //!< Number of ADC conversion sequences which were never filtered
+static bool s_initialized = false;          //!< The filters are set up, ADC blocks before are ignored
+static int32_t s_temperatureSensorValue = 0;    //!< Voltage of the temperature sensor in µV
+static int32_t s_vbatValue = 0;                 //!< VBAT voltage in µV
+static int32_t s_vrefintValue = 0;              //!< VREFINT voltage in µV
+static uint16_t s_lastChannelCounts[ADC_CHANNEL_COUNT];     //!< Count of the last converted value of each channel
+
+//! Profile of each acquisition mode, indexed by ADCMode_t
+static const ADCProfile_t* const s_modeProfiles[] = {
+    [ADC_MODE_STANDARD]         = &gADCProfileStandard,
+    [ADC_MODE_LOW_POWER]        = &gADCProfileLowPower,
+    [ADC_MODE_HIGH_RESOLUTION]  = &gADCProfileHighResolution,
+};
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
 
 void initADCService()
 {
-    for(uint8_t i = 0; i < POT2_WINDOW_SIZE; i++)
+    filterInitEMA(&s_pot1Filter, 1 << POT1_EMA_SHIFT, 1, true);
+    FILTER_INIT_MOVING_AVERAGE(&s_pot2Filter, s_pot2Window);
+    FILTER_INIT_MEDIAN(&s_pot1Median, s_pot1MedianNodes);
+    FILTER_INIT_MEDIAN(&s_pot2Median, s_pot2MedianNodes);
+
+    // The first value initializes the filters, so they start settled. Without
+    // a snapshot the first block initializes them.
+    ADCSnapshot_t snapshot;
+    s_lastSequence = 0;
+    if (adcGetSnapshot(&snapshot) == ADC_ERR_OK)
+    {
+        s_pot1Value = filterEMA(&s_pot1Filter, filterMedian(&s_pot1Median, adcConvertToMicrovolt(snapshot.values[ADC_INPUT0])));
+        s_pot2Value = filterMovingAverage(&s_pot2Filter, filterMedian(&s_pot2Median, adcConvertToMicrovolt(snapshot.values[ADC_INPUT1])));
+        s_lastSequence = snapshot.sequence;
+    }
+
+    s_initialized = true;
+}
+
+void readPotentiometers()
+{
+    if (!s_initialized)
+    {
+        // The ADC runs before the application initialized the service
+        return;
+    }
+
+    ADCBlock_t block;
+    if (adcGetBlock(&block) != ADC_ERR_OK || (int32_t) (block.sequence - s_lastSequence) <= 0)
+    {
+        // No new block, filtering the same block twice would distort the filters
+        return;
+    }
+
+    if (s_lastSequence != 0)
+    {
+        s_skippedFrames += block.sequence - s_lastSequence - 1;
+    }
+    s_lastSequence = block.sequence + ADC_BLOCK_SEQUENCES - 1;
+
+    // The average of the block reduces the noise before the filters, which
+    // keep running once per block. The median keeps a spike out of the
+    // averaging filters, where it would raise the value for several blocks.
+    int32_t pot1Value = filterMedian(&s_pot1Median, adcConvertToMicrovolt(averageBlock(&block, ADC_INPUT0)));
+    int32_t pot2Value = filterMedian(&s_pot2Median, adcConvertToMicrovolt(averageBlock(&block, ADC_INPUT1)));
+
+    s_pot1Value = filterEMA(&s_pot1Filter, pot1Value);
+    s_pot2Value = filterMovingAverage(&s_pot2Filter, pot2Value);
+}
+
+uint32_t getSkippedADCFrames()
+{
+    return s_skippedFrames;
+}
+
+int32_t setADCMode(ADCMode_t mode)
+{
+    if ((uint32_t) mode >= sizeof(s_modeProfiles) / sizeof(s_modeProfiles[0]))
     {
-        readPot1();
+        return ADC_ERR_INVALID_PARAM;
     }
 
-    for(uint8_t i = 0; i < POT1_INIT_ITERATIONS; i++)
+    if (adcGetProfile() == s_modeProfiles[mode])
     {
-        readPot2();
+        // Restarting the acquisition would only lose a block
+        return ADC_ERR_OK;
     }
 
+    return adcSetProfile(s_modeProfiles[mode]);
+}
+
+void readInternalChannels()
+{
+    int32_t microvolt;
+
+    if (readChannelVoltage(ADC_TEMP, &s_lastChannelCounts[ADC_TEMP], &microvolt))
+    {
+        s_temperatureSensorValue = microvolt;
+    }
+    if (readChannelVoltage(ADC_VBAT, &s_lastChannelCounts[ADC_VBAT], &microvolt))
+    {
+        s_vbatValue = microvolt * VBAT_DIVIDER;
+    }
+    if (readChannelVoltage(ADC_VREF, &s_lastChannelCounts[ADC_VREF], &microvolt))
+    {
+        s_vrefintValue = microvolt;
+    }
+}
+
+int32_t getTemperatureSensorVoltage()
+{
+    return s_temperatureSensorValue;
+}
+
+int32_t getVbatVoltage()
+{
+    return s_vbatValue;
+}
+
+int32_t getVrefintVoltage()
+{
+    return s_vrefintValue;
 }
 
 int32_t getPot1Value()
@@ -73,29 +198,47 @@ int32_t getPot2Value()
     return s_pot2Value;
 }
 
-void readPot1()
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief   Averages the raw values of a channel over all sequences of a block
+ *
+ * @param   pBlock  Block of conversion sequences
+ * @param   channel ADC channel
+ *
+ * @return  Rounded average in digits
+ */
+static int32_t averageBlock(const ADCBlock_t* pBlock, ADC_Channel_t channel)
 {
-    static int32_t pot1LastOutput = 0;
-    int32_t adcValue = adcReadChannel(ADC_INPUT0);
-    // filteredValue = adcValue * alpha + (1 - alpha) * lastFilteredValue = adcValue / (1 / alpha) + (1 - 1 / (1 / alpha)) * lastFilteredValue = adcValue / (1 / alpha) + (lastFilteredValue - lastFilteredValue / (1 / alpha))
-    // With 1 / alpha = POT1_EMA_ALPHA_INV => filteredValue = adcValue / POT1_EMA_ALPHA_INV + (lastFilteredValue - lastFilteredValue / POT1_EMA_ALPHA_INV) = lastFilteredValue + (adcValue - lastFilteredValue) / POT1_EMA_ALPHA_INV
-    pot1LastOutput = pot1LastOutput + (adcValue - pot1LastOutput) / POT1_EMA_ALPHA_INV;
-    s_pot1Value = pot1LastOutput;
+    int32_t sum = ADC_BLOCK_SEQUENCES / 2;
+    for (int32_t i = 0; i < ADC_BLOCK_SEQUENCES; i++)
+    {
+        sum += pBlock->values[i][channel];
+    }
+
+    return sum / ADC_BLOCK_SEQUENCES;
 }
 
-void readPot2()
+/**
+ * @brief   Reads the decimated value of a channel if it's new
+ *
+ * @param   channel     ADC channel
+ * @param   pLastCount  Count of the last read value, updated
+ * @param   pMicrovolt  Receives the new value in µV
+ *
+ * @return  true if a new value was read
+ */
+static bool readChannelVoltage(ADC_Channel_t channel, uint16_t* pLastCount, int32_t* pMicrovolt)
 {
-    static int32_t lastInputs[POT2_WINDOW_SIZE];
-    int32_t adcValue = adcReadChannel(ADC_INPUT1);
-    int32_t sum = adcValue;
-    for(int i = POT2_WINDOW_SIZE - 1; i > 0; i--)
+    ADCChannelValue_t channelValue;
+    if (adcGetChannelValue(channel, &channelValue) != ADC_ERR_OK || channelValue.count == *pLastCount)
     {
-        lastInputs[i] = lastInputs[i-1];
-        sum += lastInputs[i];
+        return false;
     }
-    lastInputs[0] = adcValue;
-    s_pot2Value = sum / POT2_WINDOW_SIZE;
-}
 
-/***** PRIVATE FUNCTIONS *****************************************************/
+    *pLastCount = channelValue.count;
+    *pMicrovolt = adcConvertToMicrovolt(channelValue.value);
 
+    return true;
+}
@@ -31,6 +31,15 @@
 
 /***** TYPES *****************************************************************/
 
+/**
+ * @brief Acquisition modes of the ADC, each one selects an ADC profile
+ */
+typedef enum _ADCMode
+{
+    ADC_MODE_STANDARD,              //!< Sensors at the trigger frequency (gADCProfileStandard), active after the initialization
+    ADC_MODE_LOW_POWER,             //!< Sensors at 100 Hz (gADCProfileLowPower)
+    ADC_MODE_HIGH_RESOLUTION,       //!< Sensors with 16 times oversampling (gADCProfileHighResolution)
+} ADCMode_t;
 
 /***** PROTOTYPES ************************************************************/
 
@@ -54,16 +63,59 @@ int32_t getPot1Value();
 int32_t getPot2Value();
 
 /**
- * @brief   Reads the value of the first potentiometer and filters it with an exponential moving average filter.
- *          The filter is defined by the constant POT1_EMA_ALPHA_INV
+ * @brief   Processes the latest block of ADC conversion sequences, called once per block.
+ *          The block average of each potentiometer passes a median filter (POT_MEDIAN_WINDOW_SIZE)
+ *          against spikes and is then filtered, the first one with an
+ *          exponential moving average filter (POT1_EMA_SHIFT), the second one with a
+ *          moving average filter (POT2_WINDOW_SIZE). A block which was already filtered is ignored.
+ */
+void readPotentiometers();
+
+/**
+ * @brief   Returns the number of ADC conversion sequences which were overwritten before they were filtered
+ *
+ * @return  Number of skipped sequences since the initialization
+ */
+uint32_t getSkippedADCFrames();
+
+/**
+ * @brief   Switches the ADC to the profile of an acquisition mode. The block being
+ *          converted is lost, the filters of the potentiometers keep running once
+ *          per block (at the block rate of the new profile).
+ *
+ * @param   mode    Acquisition mode
+ *
+ * @return  0 if the mode is active, a negative ADC_ERR_xxx code otherwise
+ *          (the previous mode stays active)
  */
-void readPot1();
+int32_t setADCMode(ADCMode_t mode);
 
 /**
- * @brief   Reads the value of the second potentiometer and filters it with a moving average filter
- *          The filter is defined by the constant POT2_WINDOW_SIZE
+ * @brief   Reads the decimated values of the internal channels (temperature sensor,
+ *          VBAT, VREFINT), called once per block. Only new values are converted.
+ */
+void readInternalChannels();
+
+/**
+ * @brief   Returns the voltage of the internal temperature sensor
+ *
+ * @return  The voltage of the temperature sensor in µV, 0 before the first value
+ */
+int32_t getTemperatureSensorVoltage();
+
+/**
+ * @brief   Returns the voltage of the backup battery (VBAT)
+ *
+ * @return  The VBAT voltage in µV, 0 before the first value
+ */
+int32_t getVbatVoltage();
+
+/**
+ * @brief   Returns the voltage of the internal reference (VREFINT), measured against VDDA
+ *
+ * @return  The VREFINT voltage in µV, 0 before the first value
  */
-void readPot2();
+int32_t getVrefintVoltage();
 
 
 
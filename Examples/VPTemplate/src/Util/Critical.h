@@ -0,0 +1,76 @@
+/******************************************************************************
+ * @file Critical.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Critical sections and memory barriers for hardware independent
+ * modules (OS, Util)
+ *
+ * @details On the target the interrupts are disabled via PRIMASK. The
+ * modules using this header are also built for the host benchmarks, where
+ * no interrupts exist, so the critical section is empty and only the
+ * compiler/memory barrier remains.
+ *
+ *
+ *****************************************************************************/
+#ifndef _CRITICAL_H_
+#define _CRITICAL_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#if defined(__arm__)
+#define MEMORY_BARRIER()    __asm volatile ("dmb" ::: "memory")     //!< Orders the memory accesses before and after
+#else
+#define MEMORY_BARRIER()    __sync_synchronize()                    //!< Orders the memory accesses before and after
+#endif
+
+
+/***** TYPES *****************************************************************/
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Disables the interrupts
+ *
+ * @return Previous interrupt state, which has to be passed to criticalExit()
+ */
+static inline uint32_t criticalEnter(void)
+{
+#if defined(__arm__)
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+    return primask;
+#else
+    __sync_synchronize();
+    return 0;
+#endif
+}
+
+/**
+ * @brief Restores the interrupt state of the matching criticalEnter() call
+ *
+ * @param state Return value of criticalEnter()
+ */
+static inline void criticalExit(uint32_t state)
+{
+#if defined(__arm__)
+    __asm volatile ("msr primask, %0" :: "r" (state) : "memory");
+#else
+    (void) state;
+    __sync_synchronize();
+#endif
+}
+
+#endif
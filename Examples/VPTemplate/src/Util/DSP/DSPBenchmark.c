@@ -0,0 +1,235 @@
+/******************************************************************************
+ * @file DSPBenchmark.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Implementation of the cycle benchmark of the DSP kernels
+ *
+ * @details The blocks are seeded full scale noise (including -32768), the
+ * FIR filter is a moving average over DSP_BENCHMARK_FIR_TAPS samples. Each
+ * measurement includes the call, an interrupt during a run only raises
+ * that run, so the fastest of DSP_BENCHMARK_RUNS runs is reported.
+ *
+ * Linked with --gc-sections the code and the buffers are dropped from the
+ * firmware unless DSP_BENCHMARK_ENABLED calls dspRunBenchmark().
+ *
+ *
+ *****************************************************************************/
+
+/***** INCLUDES **************************************************************/
+#include "DSPBenchmark.h"
+#include "DSPKernels.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+static const uint32_t BENCHMARK_SEED = 12345u;          //!< Seed of the noise
+static const int16_t BENCHMARK_SCALE = 26214;           //!< 0.8 in Q15
+static const int16_t BENCHMARK_OFFSET = 12000;          //!< Offset of the scale benchmark, saturates some samples
+static const int16_t BENCHMARK_FIR_COEFFICIENT = 32768 / DSP_BENCHMARK_FIR_TAPS;   //!< Moving average in Q15
+
+
+/***** PRIVATE MACROS ********************************************************/
+
+/**
+ * @brief Measures DSP_BENCHMARK_RUNS runs of a statement
+ *
+ * @param getCycleCount Cycle counter
+ * @param pCycles       Receives the cycles of the fastest run
+ */
+#define BENCHMARK_MEASURE(getCycleCount, pCycles, statement) \
+    do { \
+        *(pCycles) = UINT32_MAX; \
+        for (uint32_t run = 0; run < DSP_BENCHMARK_RUNS; run++) \
+        { \
+            uint32_t start = (getCycleCount)(); \
+            statement; \
+            uint32_t cycles = (getCycleCount)() - start; \
+            if (cycles < *(pCycles)) \
+                *(pCycles) = cycles; \
+        } \
+    } while (0)
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static void benchmarkBuildSamples(void);
+static void benchmarkPrint(DSPPrintFunction printFunction, const char* pName, uint32_t packedCycles, uint32_t directCycles, bool match);
+static int16_t dspSaturate16(int64_t value);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+static int16_t s_samplesA[DSP_BENCHMARK_LENGTH + DSP_BENCHMARK_FIR_TAPS];   //!< First input (with FIR history)
+static int16_t s_samplesB[DSP_BENCHMARK_LENGTH];                            //!< Second input of the dot product
+static int16_t s_coefficients[DSP_BENCHMARK_FIR_TAPS];                      //!< Coefficients of the FIR filter
+static int16_t s_packedOutput[DSP_BENCHMARK_LENGTH];                        //!< Output of the kernel
+static int16_t s_directOutput[DSP_BENCHMARK_LENGTH];                        //!< Output of the direct implementation
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int32_t dspRunBenchmark(DSPCycleCounterFunction getCycleCount, DSPPrintFunction printFunction)
+{
+    if (getCycleCount == 0 || printFunction == 0)
+        return 0;
+
+    uint32_t packedCycles = 0;
+    uint32_t directCycles = 0;
+    int32_t mismatches = 0;
+    bool match = false;
+
+    benchmarkBuildSamples();
+    printFunction("DSP kernels (%u samples, %s, fastest of %u runs)\n\r", (unsigned) DSP_BENCHMARK_LENGTH,
+                  DSP_SIMD_ENABLED ? "SIMD instructions" : "C replacements", (unsigned) DSP_BENCHMARK_RUNS);
+
+    int64_t packedResult = 0;
+    int64_t directResult = 0;
+    BENCHMARK_MEASURE(getCycleCount, &packedCycles, packedResult = dspDotProduct16(s_samplesA, s_samplesB, DSP_BENCHMARK_LENGTH));
+    BENCHMARK_MEASURE(getCycleCount, &directCycles, directResult = dspDirectDotProduct16(s_samplesA, s_samplesB, DSP_BENCHMARK_LENGTH));
+    match = (packedResult == directResult);
+    benchmarkPrint(printFunction, "dot product", packedCycles, directCycles, match);
+    mismatches += match ? 0 : 1;
+
+    BENCHMARK_MEASURE(getCycleCount, &packedCycles,
+                      dspFir16(s_coefficients, DSP_BENCHMARK_FIR_TAPS, s_samplesA, s_packedOutput, DSP_BENCHMARK_LENGTH));
+    BENCHMARK_MEASURE(getCycleCount, &directCycles,
+                      dspDirectFir16(s_coefficients, DSP_BENCHMARK_FIR_TAPS, s_samplesA, s_directOutput, DSP_BENCHMARK_LENGTH));
+    match = (memcmp(s_packedOutput, s_directOutput, sizeof(s_packedOutput)) == 0);
+    benchmarkPrint(printFunction, "FIR 16 taps", packedCycles, directCycles, match);
+    mismatches += match ? 0 : 1;
+
+    BENCHMARK_MEASURE(getCycleCount, &packedCycles,
+                      dspScaleOffset16(s_samplesA, s_packedOutput, DSP_BENCHMARK_LENGTH, BENCHMARK_SCALE, BENCHMARK_OFFSET));
+    BENCHMARK_MEASURE(getCycleCount, &directCycles,
+                      dspDirectScaleOffset16(s_samplesA, s_directOutput, DSP_BENCHMARK_LENGTH, BENCHMARK_SCALE, BENCHMARK_OFFSET));
+    match = (memcmp(s_packedOutput, s_directOutput, sizeof(s_packedOutput)) == 0);
+    benchmarkPrint(printFunction, "scale and offset", packedCycles, directCycles, match);
+    mismatches += match ? 0 : 1;
+
+    int16_t packedMin = 0;
+    int16_t packedMax = 0;
+    int16_t directMin = 0;
+    int16_t directMax = 0;
+    BENCHMARK_MEASURE(getCycleCount, &packedCycles, dspMinMax16(s_samplesA, DSP_BENCHMARK_LENGTH, &packedMin, &packedMax));
+    BENCHMARK_MEASURE(getCycleCount, &directCycles, dspDirectMinMax16(s_samplesA, DSP_BENCHMARK_LENGTH, &directMin, &directMax));
+    match = (packedMin == directMin && packedMax == directMax);
+    benchmarkPrint(printFunction, "min/max", packedCycles, directCycles, match);
+    mismatches += match ? 0 : 1;
+
+    BENCHMARK_MEASURE(getCycleCount, &packedCycles, packedResult = dspSumOfSquares16(s_samplesA, DSP_BENCHMARK_LENGTH));
+    BENCHMARK_MEASURE(getCycleCount, &directCycles, directResult = dspDirectSumOfSquares16(s_samplesA, DSP_BENCHMARK_LENGTH));
+    match = (packedResult == directResult);
+    benchmarkPrint(printFunction, "sum of squares", packedCycles, directCycles, match);
+    mismatches += match ? 0 : 1;
+
+    return mismatches;
+}
+
+int64_t dspDirectDotProduct16(const int16_t* pA, const int16_t* pB, uint32_t length)
+{
+    int64_t acc = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        acc += (int32_t) pA[i] * pB[i];
+    }
+    return acc;
+}
+
+void dspDirectFir16(const int16_t* pCoefficients, uint32_t taps, const int16_t* pInput, int16_t* pOutput, uint32_t count)
+{
+    for (uint32_t n = 0; n < count; n++)
+    {
+        pOutput[n] = dspSaturate16(dspDirectDotProduct16(pCoefficients, &pInput[n], taps) >> DSP_Q15_SHIFT);
+    }
+}
+
+void dspDirectScaleOffset16(const int16_t* pInput, int16_t* pOutput, uint32_t length, int16_t scale, int16_t offset)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        pOutput[i] = dspSaturate16((int32_t) dspSaturate16(((int32_t) pInput[i] * scale) >> DSP_Q15_SHIFT) + offset);
+    }
+}
+
+void dspDirectMinMax16(const int16_t* pInput, uint32_t length, int16_t* pMin, int16_t* pMax)
+{
+    if (length == 0)
+        return;
+
+    *pMin = pInput[0];
+    *pMax = pInput[0];
+    for (uint32_t i = 1; i < length; i++)
+    {
+        if (pInput[i] < *pMin)
+            *pMin = pInput[i];
+        if (pInput[i] > *pMax)
+            *pMax = pInput[i];
+    }
+}
+
+int64_t dspDirectSumOfSquares16(const int16_t* pInput, uint32_t length)
+{
+    return dspDirectDotProduct16(pInput, pInput, length);
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief Fills the inputs with xorshift32 noise and the FIR coefficients
+ */
+static void benchmarkBuildSamples(void)
+{
+    uint32_t random = BENCHMARK_SEED;
+    for (uint32_t i = 0; i < DSP_BENCHMARK_LENGTH + DSP_BENCHMARK_FIR_TAPS; i++)
+    {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+
+        s_samplesA[i] = (int16_t) random;
+        if (i < DSP_BENCHMARK_LENGTH)
+        {
+            s_samplesB[i] = (int16_t) (random >> 16);
+        }
+    }
+    s_samplesA[3] = INT16_MIN;
+    s_samplesB[3] = INT16_MIN;
+
+    for (uint32_t k = 0; k < DSP_BENCHMARK_FIR_TAPS; k++)
+    {
+        s_coefficients[k] = BENCHMARK_FIR_COEFFICIENT;
+    }
+}
+
+/**
+ * @brief Prints the result line of a kernel, the speedup in hundredths
+ */
+static void benchmarkPrint(DSPPrintFunction printFunction, const char* pName, uint32_t packedCycles, uint32_t directCycles, bool match)
+{
+    uint32_t speedup = (packedCycles != 0) ? (uint32_t) (((uint64_t) directCycles * 100) / packedCycles) : 0;
+
+    printFunction("DSP %s: packed %u, direct %u cycles, speedup %u.%02ux, %s\n\r", pName, (unsigned) packedCycles,
+                  (unsigned) directCycles, (unsigned) (speedup / 100), (unsigned) (speedup % 100), match ? "match" : "MISMATCH");
+}
+
+/**
+ * @brief Saturates a value to the int16_t range
+ */
+static int16_t dspSaturate16(int64_t value)
+{
+    if (value > INT16_MAX)
+        return INT16_MAX;
+    if (value < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t) value;
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+ * @file DSPBenchmark.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Header file for the cycle benchmark of the DSP kernels
+ *
+ * @details The direct implementations process one sample per step with
+ * 32/64 bit arithmetic and define the results of the kernels. The host
+ * benchmark checks the kernels against them, the firmware measures both
+ * once at startup with the cycle counter (DSP_BENCHMARK_ENABLED), which
+ * shows the gain of the SIMD instructions on the Cortex-M4.
+ *
+ *
+ *****************************************************************************/
+#ifndef _DSP_BENCHMARK_H_
+#define _DSP_BENCHMARK_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#ifndef DSP_BENCHMARK_ENABLED
+#define DSP_BENCHMARK_ENABLED   0       //!< Measure the DSP kernels once at startup and log the cycles
+#endif
+
+#define DSP_BENCHMARK_LENGTH    256     //!< Samples per measured block
+#define DSP_BENCHMARK_RUNS      4       //!< Measured runs per kernel, the fastest one is reported
+#define DSP_BENCHMARK_FIR_TAPS  16      //!< Number of taps of the measured FIR filter
+
+
+/***** TYPES *****************************************************************/
+
+/**
+ * @brief Function pointer type for the cycle counter
+ */
+typedef uint32_t (*DSPCycleCounterFunction)(void);
+
+/**
+ * @brief Function pointer type for printf like output functions
+ */
+typedef int (*DSPPrintFunction)(const char* format, ...);
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Measures every kernel and its direct implementation on a block of
+ * DSP_BENCHMARK_LENGTH samples and prints the cycles, the speedup and
+ * whether both results match
+ *
+ * @param getCycleCount     Cycle counter (e.g. timerGetCycleCount())
+ * @param printFunction     Output function (e.g. outputLogf())
+ *
+ * @return Number of kernels whose result differs from the direct implementation
+ */
+int32_t dspRunBenchmark(DSPCycleCounterFunction getCycleCount, DSPPrintFunction printFunction);
+
+/**
+ * @brief Direct implementation of dspDotProduct16()
+ */
+int64_t dspDirectDotProduct16(const int16_t* pA, const int16_t* pB, uint32_t length);
+
+/**
+ * @brief Direct implementation of dspFir16()
+ */
+void dspDirectFir16(const int16_t* pCoefficients, uint32_t taps, const int16_t* pInput, int16_t* pOutput, uint32_t count);
+
+/**
+ * @brief Direct implementation of dspScaleOffset16()
+ */
+void dspDirectScaleOffset16(const int16_t* pInput, int16_t* pOutput, uint32_t length, int16_t scale, int16_t offset);
+
+/**
+ * @brief Direct implementation of dspMinMax16()
+ */
+void dspDirectMinMax16(const int16_t* pInput, uint32_t length, int16_t* pMin, int16_t* pMax);
+
+/**
+ * @brief Direct implementation of dspSumOfSquares16()
+ */
+int64_t dspDirectSumOfSquares16(const int16_t* pInput, uint32_t length);
+
+#endif
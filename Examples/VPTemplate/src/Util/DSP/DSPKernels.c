@@ -0,0 +1,298 @@
+/******************************************************************************
+ * @file DSPKernels.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Implementation of the DSP kernels on blocks of 16 bit samples
+ *
+ * @details Two neighbouring samples are read as one 32 bit word, the sample
+ * with the lower address is the lower half word (little endian). The
+ * instructions are wrapped by the DSP_* macros, which map to the CMSIS
+ * intrinsics on the target and to C functions on the host. An odd last
+ * sample is processed separately.
+ *
+ * The kernels don't check their pointers, like the filter functions they are
+ * called for every block.
+ *
+ *
+ *****************************************************************************/
+
+/***** INCLUDES **************************************************************/
+#include "DSPKernels.h"
+
+#if DSP_SIMD_ENABLED
+#include "cmsis_compiler.h"
+#else
+#include <string.h>
+#endif
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+#if DSP_SIMD_ENABLED
+
+#define DSP_READ_PAIR(pSample)          __UNALIGNED_UINT32_READ(pSample)            //!< Reads two samples
+#define DSP_WRITE_PAIR(pSample, pair)   __UNALIGNED_UINT32_WRITE((pSample), (pair)) //!< Writes two samples
+#define DSP_SMLALD(a, b, acc)           ((int64_t) __SMLALD((a), (b), (uint64_t) (acc)))   //!< acc + a.lo * b.lo + a.hi * b.hi
+#define DSP_SMULBB(a, b)                dspSmulbb((a), (b))                         //!< a.lo * b.lo
+#define DSP_SMULTB(a, b)                dspSmultb((a), (b))                         //!< a.hi * b.lo
+#define DSP_QADD16(a, b)                __QADD16((a), (b))                          //!< Saturating addition of both half words
+#define DSP_SSAT16(value)               __SSAT((value), 16)                         //!< Saturates to the int16_t range
+#define DSP_PACK(low, high)             __PKHBT((low), (high), 16)                  //!< Packs two samples into a word
+
+// SSUB16 sets the GE flags which SEL evaluates. Both are volatile asm statements,
+// so the compiler keeps their order and emits no other GE flag setting code in between
+#define DSP_MAX16(a, b)                 (__SSUB16((a), (b)), __SEL((a), (b)))       //!< Maximum of both half words
+#define DSP_MIN16(a, b)                 (__SSUB16((a), (b)), __SEL((b), (a)))       //!< Minimum of both half words
+
+#else
+
+#define DSP_READ_PAIR(pSample)          dspReadPair(pSample)
+#define DSP_WRITE_PAIR(pSample, pair)   dspWritePair((pSample), (pair))
+#define DSP_SMLALD(a, b, acc)           dspSmlald((a), (b), (acc))
+#define DSP_SMULBB(a, b)                dspSmulbb((a), (b))
+#define DSP_SMULTB(a, b)                dspSmultb((a), (b))
+#define DSP_QADD16(a, b)                dspQadd16((a), (b))
+#define DSP_SSAT16(value)               dspSsat16(value)
+#define DSP_PACK(low, high)             (((uint32_t) (low) & 0xFFFFu) | ((uint32_t) (high) << 16))
+#define DSP_MAX16(a, b)                 dspMax16((a), (b))
+#define DSP_MIN16(a, b)                 dspMin16((a), (b))
+
+#endif
+
+#define DSP_LOW(pair)                   ((int16_t) (pair))                          //!< Sample in the lower half word
+#define DSP_HIGH(pair)                  ((int16_t) ((pair) >> 16))                  //!< Sample in the upper half word
+#define DSP_DUPLICATE(sample)           ((uint32_t) (uint16_t) (sample) * 0x00010001u)  //!< Sample in both half words
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static int16_t dspDescaleQ15(int64_t acc);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+
+
+/***** PRIVATE FUNCTIONS (INSTRUCTION REPLACEMENTS) **************************/
+#if DSP_SIMD_ENABLED
+
+// CMSIS has no intrinsics for the half word multiplications
+
+__STATIC_FORCEINLINE int32_t dspSmulbb(uint32_t a, uint32_t b)
+{
+    int32_t result;
+    __ASM ("smulbb %0, %1, %2" : "=r" (result) : "r" (a), "r" (b));
+    return result;
+}
+
+__STATIC_FORCEINLINE int32_t dspSmultb(uint32_t a, uint32_t b)
+{
+    int32_t result;
+    __ASM ("smultb %0, %1, %2" : "=r" (result) : "r" (a), "r" (b));
+    return result;
+}
+
+#else
+
+static inline uint32_t dspReadPair(const int16_t* pSample)
+{
+    uint32_t pair;
+    memcpy(&pair, pSample, sizeof(pair));
+    return pair;
+}
+
+static inline void dspWritePair(int16_t* pSample, uint32_t pair)
+{
+    memcpy(pSample, &pair, sizeof(pair));
+}
+
+static inline int32_t dspSsat16(int32_t value)
+{
+    if (value > INT16_MAX)
+        return INT16_MAX;
+    if (value < INT16_MIN)
+        return INT16_MIN;
+    return value;
+}
+
+static inline int64_t dspSmlald(uint32_t a, uint32_t b, int64_t acc)
+{
+    return acc + (int32_t) DSP_LOW(a) * DSP_LOW(b) + (int32_t) DSP_HIGH(a) * DSP_HIGH(b);
+}
+
+static inline int32_t dspSmulbb(uint32_t a, uint32_t b)
+{
+    return (int32_t) DSP_LOW(a) * DSP_LOW(b);
+}
+
+static inline int32_t dspSmultb(uint32_t a, uint32_t b)
+{
+    return (int32_t) DSP_HIGH(a) * DSP_LOW(b);
+}
+
+static inline uint32_t dspQadd16(uint32_t a, uint32_t b)
+{
+    int32_t low = dspSsat16((int32_t) DSP_LOW(a) + DSP_LOW(b));
+    int32_t high = dspSsat16((int32_t) DSP_HIGH(a) + DSP_HIGH(b));
+    return DSP_PACK(low, high);
+}
+
+static inline uint32_t dspMax16(uint32_t a, uint32_t b)
+{
+    int16_t low = (DSP_LOW(a) >= DSP_LOW(b)) ? DSP_LOW(a) : DSP_LOW(b);
+    int16_t high = (DSP_HIGH(a) >= DSP_HIGH(b)) ? DSP_HIGH(a) : DSP_HIGH(b);
+    return DSP_PACK(low, high);
+}
+
+static inline uint32_t dspMin16(uint32_t a, uint32_t b)
+{
+    int16_t low = (DSP_LOW(a) >= DSP_LOW(b)) ? DSP_LOW(b) : DSP_LOW(a);
+    int16_t high = (DSP_HIGH(a) >= DSP_HIGH(b)) ? DSP_HIGH(b) : DSP_HIGH(a);
+    return DSP_PACK(low, high);
+}
+
+#endif
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int64_t dspDotProduct16(const int16_t* pA, const int16_t* pB, uint32_t length)
+{
+    int64_t acc = 0;
+    uint32_t i = 0;
+
+    for (; i + 1 < length; i += 2)
+    {
+        acc = DSP_SMLALD(DSP_READ_PAIR(&pA[i]), DSP_READ_PAIR(&pB[i]), acc);
+    }
+    if (i < length)
+    {
+        acc += (int32_t) pA[i] * pB[i];
+    }
+
+    return acc;
+}
+
+void dspFir16(const int16_t* pCoefficients, uint32_t taps, const int16_t* pInput, int16_t* pOutput, uint32_t count)
+{
+    uint32_t n = 0;
+
+    // Two outputs per pass share the coefficient loads
+    for (; n + 1 < count; n += 2)
+    {
+        const int16_t* pX = &pInput[n];
+        int64_t acc0 = 0;
+        int64_t acc1 = 0;
+        uint32_t k = 0;
+
+        for (; k + 1 < taps; k += 2)
+        {
+            uint32_t coefficients = DSP_READ_PAIR(&pCoefficients[k]);
+            acc0 = DSP_SMLALD(coefficients, DSP_READ_PAIR(&pX[k]), acc0);
+            acc1 = DSP_SMLALD(coefficients, DSP_READ_PAIR(&pX[k + 1]), acc1);
+        }
+        if (k < taps)
+        {
+            acc0 += (int32_t) pCoefficients[k] * pX[k];
+            acc1 += (int32_t) pCoefficients[k] * pX[k + 1];
+        }
+
+        pOutput[n] = dspDescaleQ15(acc0);
+        pOutput[n + 1] = dspDescaleQ15(acc1);
+    }
+    if (n < count)
+    {
+        pOutput[n] = dspDescaleQ15(dspDotProduct16(pCoefficients, &pInput[n], taps));
+    }
+}
+
+void dspScaleOffset16(const int16_t* pInput, int16_t* pOutput, uint32_t length, int16_t scale, int16_t offset)
+{
+    // One multiplication per sample, but SMULBB and SMULTB take the samples
+    // directly from the pair, so one load replaces two loads with sign extension
+    uint32_t scales = DSP_DUPLICATE(scale);
+    uint32_t offsets = DSP_DUPLICATE(offset);
+    uint32_t i = 0;
+
+    for (; i + 1 < length; i += 2)
+    {
+        uint32_t samples = DSP_READ_PAIR(&pInput[i]);
+        int32_t low = DSP_SSAT16(DSP_SMULBB(samples, scales) >> DSP_Q15_SHIFT);
+        int32_t high = DSP_SSAT16(DSP_SMULTB(samples, scales) >> DSP_Q15_SHIFT);
+        DSP_WRITE_PAIR(&pOutput[i], DSP_QADD16(DSP_PACK(low, high), offsets));
+    }
+    if (i < length)
+    {
+        int32_t value = DSP_SSAT16(((int32_t) pInput[i] * scale) >> DSP_Q15_SHIFT);
+        pOutput[i] = (int16_t) DSP_SSAT16(value + offset);
+    }
+}
+
+void dspMinMax16(const int16_t* pInput, uint32_t length, int16_t* pMin, int16_t* pMax)
+{
+    if (length == 0)
+        return;
+
+    uint32_t minimum = DSP_DUPLICATE(pInput[0]);
+    uint32_t maximum = minimum;
+    uint32_t i = 0;
+
+    for (; i + 1 < length; i += 2)
+    {
+        uint32_t samples = DSP_READ_PAIR(&pInput[i]);
+        minimum = DSP_MIN16(samples, minimum);
+        maximum = DSP_MAX16(samples, maximum);
+    }
+    if (i < length)
+    {
+        uint32_t samples = DSP_DUPLICATE(pInput[i]);
+        minimum = DSP_MIN16(samples, minimum);
+        maximum = DSP_MAX16(samples, maximum);
+    }
+
+    *pMin = (DSP_LOW(minimum) < DSP_HIGH(minimum)) ? DSP_LOW(minimum) : DSP_HIGH(minimum);
+    *pMax = (DSP_LOW(maximum) > DSP_HIGH(maximum)) ? DSP_LOW(maximum) : DSP_HIGH(maximum);
+}
+
+int64_t dspSumOfSquares16(const int16_t* pInput, uint32_t length)
+{
+    int64_t acc = 0;
+    uint32_t i = 0;
+
+    for (; i + 1 < length; i += 2)
+    {
+        uint32_t samples = DSP_READ_PAIR(&pInput[i]);
+        acc = DSP_SMLALD(samples, samples, acc);
+    }
+    if (i < length)
+    {
+        acc += (int32_t) pInput[i] * pInput[i];
+    }
+
+    return acc;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief Removes the Q15 scaling of an accumulator and saturates it to 16 bit
+ */
+static int16_t dspDescaleQ15(int64_t acc)
+{
+    acc >>= DSP_Q15_SHIFT;
+    if (acc > INT16_MAX)
+        return INT16_MAX;
+    if (acc < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t) acc;
+}
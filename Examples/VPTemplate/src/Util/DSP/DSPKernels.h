@@ -0,0 +1,105 @@
+/******************************************************************************
+ * @file DSPKernels.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Header file for the DSP kernels on blocks of 16 bit samples
+ *
+ * @details The kernels process two samples per 32 bit word with the SIMD
+ * instructions of the Cortex-M4 (SMLALD, QADD16, SSUB16/SEL) and the half
+ * word multiplications (SMULBB, SMULTB). Builds
+ * without the DSP extension (host benchmarks) use C functions with the
+ * same results instead of the instructions, so both builds run the same
+ * algorithm and produce bit identical outputs.
+ *
+ * The samples and coefficients are signed 16 bit values, coefficients and
+ * scale factors in Q15. The arrays don't need to be 32 bit aligned.
+ *
+ *
+ *****************************************************************************/
+#ifndef _DSP_KERNELS_H_
+#define _DSP_KERNELS_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define DSP_SIMD_ENABLED        1       //!< The kernels use the SIMD instructions
+#else
+#define DSP_SIMD_ENABLED        0       //!< The kernels use the C replacements of the SIMD instructions
+#endif
+
+#define DSP_Q15_SHIFT           15      //!< Number of fractional bits of Q15 values
+
+
+/***** TYPES *****************************************************************/
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Calculates the dot product of two vectors
+ *
+ * @param pA        First vector
+ * @param pB        Second vector
+ * @param length    Number of samples of both vectors
+ *
+ * @return Sum of the products pA[i] * pB[i]
+ */
+int64_t dspDotProduct16(const int16_t* pA, const int16_t* pB, uint32_t length);
+
+/**
+ * @brief Filters a block with a FIR filter
+ *        pOutput[n] = sum(pCoefficients[k] * pInput[n + k]) >> 15, saturated to 16 bit
+ *
+ * @param pCoefficients     Coefficients in Q15, the last one weights the newest input
+ * @param taps              Number of coefficients
+ * @param pInput            Input, taps - 1 samples of history followed by count new samples
+ * @param pOutput           Output (count samples)
+ * @param count             Number of output samples
+ */
+void dspFir16(const int16_t* pCoefficients, uint32_t taps, const int16_t* pInput, int16_t* pOutput, uint32_t count);
+
+/**
+ * @brief Scales a block and adds an offset
+ *        pOutput[i] = saturate(saturate((pInput[i] * scale) >> 15) + offset)
+ *
+ * @param pInput    Input samples
+ * @param pOutput   Output samples (may be the input)
+ * @param length    Number of samples
+ * @param scale     Scale factor in Q15
+ * @param offset    Offset added after the scaling
+ */
+void dspScaleOffset16(const int16_t* pInput, int16_t* pOutput, uint32_t length, int16_t scale, int16_t offset);
+
+/**
+ * @brief Determines the minimum and maximum of a block
+ *
+ * @param pInput    Input samples
+ * @param length    Number of samples (at least one)
+ * @param pMin      Receives the minimum
+ * @param pMax      Receives the maximum
+ */
+void dspMinMax16(const int16_t* pInput, uint32_t length, int16_t* pMin, int16_t* pMax);
+
+/**
+ * @brief Calculates the sum of squares of a block (e.g. for the RMS value)
+ *
+ * @param pInput    Input samples
+ * @param length    Number of samples
+ *
+ * @return Sum of pInput[i]^2
+ */
+int64_t dspSumOfSquares16(const int16_t* pInput, uint32_t length);
+
+#endif
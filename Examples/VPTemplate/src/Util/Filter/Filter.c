@@ -0,0 +1,535 @@
+/******************************************************************************
+ * @file Filter.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Implementation of the Filter library
+ *
+ * @details The scaled products are rounded to the nearest integer when the
+ * scaling is removed. The filter functions don't check their pointer, they
+ * are called for every sample; the init functions check the parameters.
+ *
+ *
+ *****************************************************************************/
+
+/***** INCLUDES **************************************************************/
+#include "Filter.h"
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define MEDIAN_HEAP_SLOT(pMedian, position) \
+    ((pMedian)->pNodes[(position) + (pMedian)->windowSize / 2].heapSlot)    //!< Window slot at a heap position
+
+#define MEDIAN_MIN_HEAP_COUNT(pMedian)  (((pMedian)->count - 1) / 2)           //!< Number of values in the min heap
+#define MEDIAN_MAX_HEAP_COUNT(pMedian)  ((pMedian)->count / 2)                 //!< Number of values in the max heap
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static int32_t filterDescale(int64_t value, uint8_t fractionalBits);
+static int32_t filterDivide(int64_t value, int32_t divisor);
+static bool medianIsLess(MedianFilterData_t* pMedian, int32_t positionA, int32_t positionB);
+static bool medianExchangeIfLess(MedianFilterData_t* pMedian, int32_t positionA, int32_t positionB);
+static bool medianMinHeapSiftUp(MedianFilterData_t* pMedian, int32_t position);
+static bool medianMaxHeapSiftUp(MedianFilterData_t* pMedian, int32_t position);
+static void medianMinHeapSiftDown(MedianFilterData_t* pMedian, int32_t position);
+static void medianMaxHeapSiftDown(MedianFilterData_t* pMedian, int32_t position);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int32_t filterInitEMA(EMAFilterData_t* pEMA, int32_t scalingFactor, int32_t alpha, bool resetFilter)
+{
+    if (pEMA == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    if (scalingFactor <= 0 || alpha <= 0 || alpha > scalingFactor)
+        return FILTER_ERR_INVALID_PARAM;
+
+    pEMA->scalingFactor = scalingFactor;
+    pEMA->alpha = alpha;
+
+    // alpha = 1 / 2^n replaces the multiplication and the division by a shift
+    pEMA->shift = -1;
+    if (scalingFactor % alpha == 0)
+    {
+        int32_t ratio = scalingFactor / alpha;
+        if ((ratio & (ratio - 1)) == 0)
+        {
+            pEMA->shift = 0;
+            while ((1 << pEMA->shift) < ratio)
+            {
+                pEMA->shift++;
+            }
+        }
+    }
+
+    if (resetFilter)
+    {
+        filterResetEMA(pEMA);
+    }
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterResetEMA(EMAFilterData_t* pEMA)
+{
+    if (pEMA == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    pEMA->firstValueAvailable = false;
+    pEMA->previousValue = 0;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterEMA(EMAFilterData_t* pEMA, int32_t sensorValue)
+{
+    if (!pEMA->firstValueAvailable)
+    {
+        pEMA->firstValueAvailable = true;
+        pEMA->previousValue = sensorValue;
+        return sensorValue;
+    }
+
+    // y = y + alpha * (x - y)
+    int64_t difference = (int64_t) sensorValue - pEMA->previousValue;
+    if (pEMA->shift >= 0)
+    {
+        pEMA->previousValue += filterDescale(difference, (uint8_t) pEMA->shift);
+    }
+    else
+    {
+        pEMA->previousValue += filterDivide(difference * pEMA->alpha, pEMA->scalingFactor);
+    }
+
+    return pEMA->previousValue;
+}
+
+int32_t filterInitMovingAverage(MovingAverageData_t* pMA, int32_t* pWindow, uint16_t windowSize)
+{
+    if (pMA == 0 || pWindow == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    if (windowSize == 0)
+        return FILTER_ERR_INVALID_PARAM;
+
+    pMA->pWindow = pWindow;
+    pMA->windowSize = windowSize;
+
+    return filterResetMovingAverage(pMA);
+}
+
+int32_t filterResetMovingAverage(MovingAverageData_t* pMA)
+{
+    if (pMA == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    pMA->index = 0;
+    pMA->count = 0;
+    pMA->sum = 0;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterMovingAverage(MovingAverageData_t* pMA, int32_t sensorValue)
+{
+    // The new value replaces the oldest one, the sum is updated by both
+    if (pMA->count == pMA->windowSize)
+    {
+        pMA->sum -= pMA->pWindow[pMA->index];
+    }
+    else
+    {
+        pMA->count++;
+    }
+
+    pMA->pWindow[pMA->index] = sensorValue;
+    pMA->sum += sensorValue;
+
+    pMA->index++;
+    if (pMA->index == pMA->windowSize)
+    {
+        pMA->index = 0;
+    }
+
+    return pMA->sum / pMA->count;
+}
+
+int32_t filterInitIIR(IIRFilterData_t* pIIR, int32_t b0, int32_t b1, int32_t a1, uint8_t fractionalBits, bool resetFilter)
+{
+    if (pIIR == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    // |a1| >= 1 would be unstable
+    if (fractionalBits > FILTER_MAX_FRACTIONAL_BITS ||
+        a1 <= -(1 << fractionalBits) || a1 >= (1 << fractionalBits))
+        return FILTER_ERR_INVALID_PARAM;
+
+    pIIR->b0 = b0;
+    pIIR->b1 = b1;
+    pIIR->a1 = a1;
+    pIIR->fractionalBits = fractionalBits;
+
+    if (resetFilter)
+    {
+        filterResetIIR(pIIR);
+    }
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterResetIIR(IIRFilterData_t* pIIR)
+{
+    if (pIIR == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    pIIR->firstValueAvailable = false;
+    pIIR->previousInput = 0;
+    pIIR->previousOutput = 0;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterIIR(IIRFilterData_t* pIIR, int32_t sensorValue)
+{
+    if (!pIIR->firstValueAvailable)
+    {
+        // Steady state for a constant input: y = x * (b0 + b1) / (1 + a1)
+        int64_t one = (int64_t) 1 << pIIR->fractionalBits;
+        pIIR->firstValueAvailable = true;
+        pIIR->previousInput = sensorValue;
+        pIIR->previousOutput = (int32_t) (((int64_t) sensorValue * ((int64_t) pIIR->b0 + pIIR->b1)) / (one + pIIR->a1));
+        return pIIR->previousOutput;
+    }
+
+    int64_t accumulator = (int64_t) pIIR->b0 * sensorValue
+                        + (int64_t) pIIR->b1 * pIIR->previousInput
+                        - (int64_t) pIIR->a1 * pIIR->previousOutput;
+
+    pIIR->previousInput = sensorValue;
+    pIIR->previousOutput = filterDescale(accumulator, pIIR->fractionalBits);
+
+    return pIIR->previousOutput;
+}
+
+int32_t filterInitFIR(FIRFilterData_t* pFIR, const int32_t* pCoefficients, int32_t* pHistory, uint16_t length, uint8_t fractionalBits)
+{
+    if (pFIR == 0 || pCoefficients == 0 || pHistory == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    if (length == 0 || fractionalBits > FILTER_MAX_FRACTIONAL_BITS)
+        return FILTER_ERR_INVALID_PARAM;
+
+    pFIR->pCoefficients = pCoefficients;
+    pFIR->pHistory = pHistory;
+    pFIR->length = length;
+    pFIR->fractionalBits = fractionalBits;
+
+    return filterResetFIR(pFIR);
+}
+
+int32_t filterResetFIR(FIRFilterData_t* pFIR)
+{
+    if (pFIR == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    pFIR->firstValueAvailable = false;
+    pFIR->index = 0;
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterFIR(FIRFilterData_t* pFIR, int32_t sensorValue)
+{
+    const int32_t* pCoefficients = pFIR->pCoefficients;
+    int32_t* pHistory = pFIR->pHistory;
+
+    if (!pFIR->firstValueAvailable)
+    {
+        // Steady state for a constant input
+        pFIR->firstValueAvailable = true;
+        for (uint16_t i = 0; i < pFIR->length; i++)
+        {
+            pHistory[i] = sensorValue;
+        }
+    }
+
+    pFIR->index++;
+    if (pFIR->index == pFIR->length)
+    {
+        pFIR->index = 0;
+    }
+    pHistory[pFIR->index] = sensorValue;
+
+    // The history is walked from the newest to the oldest value in two
+    // runs (down to the start of the array and from its end), which avoids
+    // a modulo per tap
+    int64_t accumulator = 0;
+    const int32_t* pCoefficient = pCoefficients;
+    for (int32_t i = pFIR->index; i >= 0; i--)
+    {
+        accumulator += (int64_t) *pCoefficient++ * pHistory[i];
+    }
+    for (int32_t i = pFIR->length - 1; i > pFIR->index; i--)
+    {
+        accumulator += (int64_t) *pCoefficient++ * pHistory[i];
+    }
+
+    return filterDescale(accumulator, pFIR->fractionalBits);
+}
+
+int32_t filterInitMedian(MedianFilterData_t* pMedian, MedianFilterNode_t* pNodes, uint16_t windowSize)
+{
+    if (pMedian == 0 || pNodes == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    if (windowSize == 0 || windowSize > INT16_MAX)
+        return FILTER_ERR_INVALID_PARAM;
+
+    pMedian->pNodes = pNodes;
+    pMedian->windowSize = windowSize;
+
+    return filterResetMedian(pMedian);
+}
+
+int32_t filterResetMedian(MedianFilterData_t* pMedian)
+{
+    if (pMedian == 0)
+        return FILTER_ERR_INVALID_PTR;
+
+    pMedian->index = 0;
+    pMedian->count = 0;
+
+    // While the window fills, the slots go alternately to the median, the
+    // max heap and the min heap: 0, -1, 1, -2, 2, ...
+    for (int32_t slot = 0; slot < pMedian->windowSize; slot++)
+    {
+        int32_t position = ((slot + 1) / 2) * ((slot & 1) ? -1 : 1);
+        pMedian->pNodes[slot].heapPosition = (int16_t) position;
+        MEDIAN_HEAP_SLOT(pMedian, position) = (uint16_t) slot;
+    }
+
+    return FILTER_ERR_OK;
+}
+
+int32_t filterMedian(MedianFilterData_t* pMedian, int32_t sensorValue)
+{
+    MedianFilterNode_t* pNode = &(pMedian->pNodes[pMedian->index]);
+    bool filling = pMedian->count < pMedian->windowSize;
+    int32_t position = pNode->heapPosition;
+    int32_t oldValue = pNode->value;
+
+    pNode->value = sensorValue;
+
+    pMedian->index++;
+    if (pMedian->index == pMedian->windowSize)
+    {
+        pMedian->index = 0;
+    }
+    if (filling)
+    {
+        pMedian->count++;
+    }
+
+    // The new value takes the place of the oldest one, only the heap which
+    // contains it has to be restored, unless it moves over the median
+    if (position > 0)
+    {
+        if (!filling && sensorValue > oldValue)
+        {
+            medianMinHeapSiftDown(pMedian, position * 2);
+        }
+        else if (medianMinHeapSiftUp(pMedian, position))
+        {
+            medianMaxHeapSiftDown(pMedian, -1);
+        }
+    }
+    else if (position < 0)
+    {
+        if (!filling && sensorValue < oldValue)
+        {
+            medianMaxHeapSiftDown(pMedian, position * 2);
+        }
+        else if (medianMaxHeapSiftUp(pMedian, position))
+        {
+            medianMinHeapSiftDown(pMedian, 1);
+        }
+    }
+    else
+    {
+        if (MEDIAN_MAX_HEAP_COUNT(pMedian) != 0)
+        {
+            medianMaxHeapSiftDown(pMedian, -1);
+        }
+        if (MEDIAN_MIN_HEAP_COUNT(pMedian) != 0)
+        {
+            medianMinHeapSiftDown(pMedian, 1);
+        }
+    }
+
+    int32_t median = pMedian->pNodes[MEDIAN_HEAP_SLOT(pMedian, 0)].value;
+    if ((pMedian->count & 1) == 0)
+    {
+        int32_t lower = pMedian->pNodes[MEDIAN_HEAP_SLOT(pMedian, -1)].value;
+        median = (int32_t) (((int64_t) median + lower) / 2);
+    }
+
+    return median;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief Removes the scaling of a value, rounded to the nearest integer
+ *
+ * @param value             Value scaled with 2^fractionalBits
+ * @param fractionalBits    Number of fractional bits
+ *
+ * @return The unscaled value
+ */
+static int32_t filterDescale(int64_t value, uint8_t fractionalBits)
+{
+    if (fractionalBits == 0)
+        return (int32_t) value;
+
+    return (int32_t) ((value + ((int64_t) 1 << (fractionalBits - 1))) >> fractionalBits);
+}
+
+/**
+ * @brief Divides a scaled value, rounded to the nearest integer like
+ * filterDescale() (halves are rounded up)
+ *
+ * @param value     Scaled value
+ * @param divisor   Scaling factor, positive
+ *
+ * @return The unscaled value
+ */
+static int32_t filterDivide(int64_t value, int32_t divisor)
+{
+    // The division truncates toward zero, the rounding needs the floor
+    int64_t dividend = value + divisor / 2;
+    int64_t quotient = dividend / divisor;
+    if (dividend % divisor < 0)
+        quotient--;
+
+    return (int32_t) quotient;
+}
+
+/**
+ * @brief Compares the values at two heap positions of the median filter
+ *
+ * @return Returns true if the value at positionA is less than at positionB
+ */
+static bool medianIsLess(MedianFilterData_t* pMedian, int32_t positionA, int32_t positionB)
+{
+    return pMedian->pNodes[MEDIAN_HEAP_SLOT(pMedian, positionA)].value <
+           pMedian->pNodes[MEDIAN_HEAP_SLOT(pMedian, positionB)].value;
+}
+
+/**
+ * @brief Exchanges the values at two heap positions of the median filter if
+ * the value at positionA is less than at positionB
+ *
+ * @return Returns true if the values were exchanged
+ */
+static bool medianExchangeIfLess(MedianFilterData_t* pMedian, int32_t positionA, int32_t positionB)
+{
+    if (!medianIsLess(pMedian, positionA, positionB))
+        return false;
+
+    uint16_t slotA = MEDIAN_HEAP_SLOT(pMedian, positionA);
+    uint16_t slotB = MEDIAN_HEAP_SLOT(pMedian, positionB);
+    MEDIAN_HEAP_SLOT(pMedian, positionA) = slotB;
+    MEDIAN_HEAP_SLOT(pMedian, positionB) = slotA;
+    pMedian->pNodes[slotA].heapPosition = (int16_t) positionB;
+    pMedian->pNodes[slotB].heapPosition = (int16_t) positionA;
+
+    return true;
+}
+
+/**
+ * @brief Moves a value of the min heap up towards the median
+ *
+ * @return Returns true if the value reached the median position
+ */
+static bool medianMinHeapSiftUp(MedianFilterData_t* pMedian, int32_t position)
+{
+    while (position > 0 && medianExchangeIfLess(pMedian, position, position / 2))
+    {
+        position /= 2;
+    }
+
+    return position == 0;
+}
+
+/**
+ * @brief Moves a value of the max heap up towards the median
+ *
+ * @return Returns true if the value reached the median position
+ */
+static bool medianMaxHeapSiftUp(MedianFilterData_t* pMedian, int32_t position)
+{
+    while (position < 0 && medianExchangeIfLess(pMedian, position / 2, position))
+    {
+        position /= 2;
+    }
+
+    return position == 0;
+}
+
+/**
+ * @brief Moves the parent of position down the min heap, the children of
+ * position i are 2i and 2i + 1
+ */
+static void medianMinHeapSiftDown(MedianFilterData_t* pMedian, int32_t position)
+{
+    int32_t count = MEDIAN_MIN_HEAP_COUNT(pMedian);
+    for (; position <= count; position *= 2)
+    {
+        // Continue with the smaller child
+        if (position > 1 && position < count && medianIsLess(pMedian, position + 1, position))
+        {
+            position++;
+        }
+        if (!medianExchangeIfLess(pMedian, position, position / 2))
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Moves the parent of position down the max heap, the children of
+ * position -i are -2i and -2i - 1
+ */
+static void medianMaxHeapSiftDown(MedianFilterData_t* pMedian, int32_t position)
+{
+    int32_t count = MEDIAN_MAX_HEAP_COUNT(pMedian);
+    for (; position >= -count; position *= 2)
+    {
+        // Continue with the larger child
+        if (position < -1 && position > -count && medianIsLess(pMedian, position, position - 1))
+        {
+            position--;
+        }
+        if (!medianExchangeIfLess(pMedian, position / 2, position))
+        {
+            break;
+        }
+    }
+}
@@ -10,6 +10,19 @@
  *
  * @brief Header file for Filter library
  *
+ * @details Fixed-point filters for sensor values: exponential moving
+ * average (EMA), moving average over a ring buffer, first order IIR and
+ * FIR stages and a sliding median, which rejects single outliers. The
+ * coefficients are scaled integers, the products are
+ * accumulated in 64 bit, so the inputs may use the full 32 bit range
+ * except for the moving average (the sum of the window has to fit into
+ * 32 bit).
+ *
+ * The windows and histories are provided by the caller, usually as arrays
+ * with a compile-time size passed with FILTER_INIT_MOVING_AVERAGE(),
+ * FILTER_INIT_FIR() and FILTER_INIT_MEDIAN(). The first value after a reset initializes the state
+ * as if the input had been constant, so the filters need no settling time.
+ *
  *
  *****************************************************************************/
 #ifndef _FILTER_H_
@@ -28,6 +41,31 @@
 #define FILTER_ERR_INVALID_PTR          -2      //!< Invalid pointer (Null Pointer)
 #define FILTER_ERR_INVALID_PARAM        -3      //!< Invalid parameter value
 
+#define FILTER_MAX_FRACTIONAL_BITS      30      //!< Maximum number of fractional bits of the coefficients
+
+/**
+ * @brief Initializes a moving average filter with a window array, the size
+ * of the window is taken from the array
+ */
+#define FILTER_INIT_MOVING_AVERAGE(pMA, window) \
+    filterInitMovingAverage((pMA), (window), (uint16_t) (sizeof(window) / sizeof((window)[0])))
+
+/**
+ * @brief Initializes a FIR filter with a coefficient and a history array of
+ * the same size, the length is taken from the arrays
+ */
+#define FILTER_INIT_FIR(pFIR, coefficients, history, fractionalBits) \
+    ((sizeof(coefficients) == sizeof(history)) ? \
+        filterInitFIR((pFIR), (coefficients), (history), (uint16_t) (sizeof(history) / sizeof((history)[0])), (fractionalBits)) : \
+        FILTER_ERR_INVALID_PARAM)
+
+/**
+ * @brief Initializes a median filter with a node array, the window size is
+ * taken from the array
+ */
+#define FILTER_INIT_MEDIAN(pMedian, nodes) \
+    filterInitMedian((pMedian), (nodes), (uint16_t) (sizeof(nodes) / sizeof((nodes)[0])))
+
 /***** TYPES *****************************************************************/
 
 /**
@@ -40,8 +78,81 @@ typedef struct _EMAFilterData
     int32_t alpha;                              //!< Alpha value (filter constant) as scaled value
     int32_t previousValue;                      //!< Previous value of the filter output
     int32_t scalingFactor;                      //!< Used scaling factor
+    int32_t shift;                              //!< log2(scalingFactor / alpha) if that is a power of two (no multiplication), otherwise -1
 } EMAFilterData_t;
 
+/**
+ * @brief Struct which represents a moving average filter
+ *
+ */
+typedef struct _MovingAverageData
+{
+    int32_t* pWindow;                           //!< Ring buffer of the last values
+    uint16_t windowSize;                        //!< Number of values of the window
+    uint16_t index;                             //!< Index of the oldest value in the window
+    uint16_t count;                             //!< Number of values in the window, less than windowSize after a reset
+    int32_t sum;                                //!< Running sum of the values in the window
+} MovingAverageData_t;
+
+/**
+ * @brief Struct which represents a first order IIR filter
+ *        y[n] = b0 * x[n] + b1 * x[n-1] - a1 * y[n-1]
+ *
+ */
+typedef struct _IIRFilterData
+{
+    bool firstValueAvailable;                   //!< Flag to indicate whether the previous values are set
+    int32_t b0;                                 //!< Coefficient of the input, scaled with 2^fractionalBits
+    int32_t b1;                                 //!< Coefficient of the previous input, scaled with 2^fractionalBits
+    int32_t a1;                                 //!< Coefficient of the previous output, scaled with 2^fractionalBits
+    uint8_t fractionalBits;                     //!< Number of fractional bits of the coefficients
+    int32_t previousInput;                      //!< Previous value of the filter input
+    int32_t previousOutput;                     //!< Previous value of the filter output
+} IIRFilterData_t;
+
+/**
+ * @brief Struct which represents a FIR filter
+ *
+ */
+typedef struct _FIRFilterData
+{
+    bool firstValueAvailable;                   //!< Flag to indicate whether the history is filled
+    const int32_t* pCoefficients;               //!< Coefficients scaled with 2^fractionalBits, [0] weights the newest value
+    int32_t* pHistory;                          //!< Ring buffer of the last inputs
+    uint16_t length;                            //!< Number of coefficients (taps)
+    uint16_t index;                             //!< Index of the newest value in the history
+    uint8_t fractionalBits;                     //!< Number of fractional bits of the coefficients
+} FIRFilterData_t;
+
+
+/**
+ * @brief Node of the median filter, one per value of the window
+ *
+ */
+typedef struct _MedianFilterNode
+{
+    int32_t value;                              //!< Value of the window slot
+    int16_t heapPosition;                       //!< Position of the window slot in the heaps (0: median, > 0: min heap, < 0: max heap)
+    uint16_t heapSlot;                          //!< Window slot stored at heap position (node index - windowSize / 2)
+} MedianFilterNode_t;
+
+/**
+ * @brief Struct which represents a sliding median filter
+ *
+ * @details The window is kept in two heaps around the median: a max heap
+ * of the smaller and a min heap of the larger values. A new value replaces
+ * the oldest one in its heap and is sifted up or down, which needs
+ * O(log windowSize) comparisons and no resort of the window.
+ *
+ */
+typedef struct _MedianFilterData
+{
+    MedianFilterNode_t* pNodes;                 //!< Nodes of the window
+    uint16_t windowSize;                        //!< Number of values of the window
+    uint16_t index;                             //!< Index of the oldest value in the window
+    uint16_t count;                             //!< Number of values in the window, less than windowSize after a reset
+} MedianFilterData_t;
+
 
 /***** PROTOTYPES ************************************************************/
 
@@ -78,4 +189,136 @@ int32_t filterResetEMA(EMAFilterData_t* pEMA);
  */
 int32_t filterEMA(EMAFilterData_t* pEMA, int32_t sensorValue);
 
+/**
+ * @brief Initialize a moving average filter, use FILTER_INIT_MOVING_AVERAGE()
+ * for windows with a compile-time size
+ *
+ * @param pMA               Pointer to the moving average filter struct
+ * @param pWindow           Array for the window (windowSize values)
+ * @param windowSize        Number of averaged values
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitMovingAverage(MovingAverageData_t* pMA, int32_t* pWindow, uint16_t windowSize);
+
+/**
+ * @brief Resets the moving average filter structure
+ *
+ * @param pMA               Pointer to the moving average filter struct
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterResetMovingAverage(MovingAverageData_t* pMA);
+
+/**
+ * @brief Adds the value to the window and returns the average, which needs
+ * constant time independent of the window size
+ *
+ * @param pMA               Pointer to the moving average filter struct
+ * @param sensorValue       Value which should be filtered
+ *
+ * @return The average of the window (of the values since the reset while
+ * the window isn't filled yet)
+ */
+int32_t filterMovingAverage(MovingAverageData_t* pMA, int32_t sensorValue);
+
+/**
+ * @brief Initialize a first order IIR filter with the provided coefficients
+ *
+ * @param pIIR              Pointer to the IIR filter struct
+ * @param b0                Coefficient of the input, scaled with 2^fractionalBits
+ * @param b1                Coefficient of the previous input, scaled with 2^fractionalBits
+ * @param a1                Coefficient of the previous output, scaled with 2^fractionalBits (|a1| < 2^fractionalBits)
+ * @param fractionalBits    Number of fractional bits (up to FILTER_MAX_FRACTIONAL_BITS)
+ * @param resetFilter       Flag to indicate whether the filter should be reset
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitIIR(IIRFilterData_t* pIIR, int32_t b0, int32_t b1, int32_t a1, uint8_t fractionalBits, bool resetFilter);
+
+/**
+ * @brief Resets the IIR filter structure
+ *
+ * @param pIIR              Pointer to the IIR filter struct
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterResetIIR(IIRFilterData_t* pIIR);
+
+/**
+ * @brief Performs the IIR filtering on the provided sensor value
+ *
+ * @param pIIR              Pointer to the IIR filter struct
+ * @param sensorValue       Value which should be filtered
+ *
+ * @return The filtered sensor value
+ */
+int32_t filterIIR(IIRFilterData_t* pIIR, int32_t sensorValue);
+
+/**
+ * @brief Initialize a FIR filter, use FILTER_INIT_FIR() for arrays with a
+ * compile-time size
+ *
+ * @param pFIR              Pointer to the FIR filter struct
+ * @param pCoefficients     Coefficients scaled with 2^fractionalBits (length values), [0] weights the newest value
+ * @param pHistory          Array for the last inputs (length values)
+ * @param length            Number of coefficients (taps)
+ * @param fractionalBits    Number of fractional bits (up to FILTER_MAX_FRACTIONAL_BITS)
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitFIR(FIRFilterData_t* pFIR, const int32_t* pCoefficients, int32_t* pHistory, uint16_t length, uint8_t fractionalBits);
+
+/**
+ * @brief Resets the FIR filter structure
+ *
+ * @param pFIR              Pointer to the FIR filter struct
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterResetFIR(FIRFilterData_t* pFIR);
+
+/**
+ * @brief Performs the FIR filtering on the provided sensor value
+ *
+ * @param pFIR              Pointer to the FIR filter struct
+ * @param sensorValue       Value which should be filtered
+ *
+ * @return The filtered sensor value
+ */
+int32_t filterFIR(FIRFilterData_t* pFIR, int32_t sensorValue);
+
+/**
+ * @brief Initialize a median filter, use FILTER_INIT_MEDIAN() for node
+ * arrays with a compile-time size
+ *
+ * @param pMedian           Pointer to the median filter struct
+ * @param pNodes            Array for the nodes (windowSize nodes)
+ * @param windowSize        Number of values of the window (up to INT16_MAX)
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterInitMedian(MedianFilterData_t* pMedian, MedianFilterNode_t* pNodes, uint16_t windowSize);
+
+/**
+ * @brief Resets the median filter structure
+ *
+ * @param pMedian           Pointer to the median filter struct
+ *
+ * @return Return FILTER_ERR_OK is no error occured
+ */
+int32_t filterResetMedian(MedianFilterData_t* pMedian);
+
+/**
+ * @brief Adds the value to the window and returns the median
+ *
+ * @param pMedian           Pointer to the median filter struct
+ * @param sensorValue       Value which should be filtered
+ *
+ * @return The median of the window (of the values since the reset while the
+ * window isn't filled yet), the mean of the two middle values for an even
+ * number of values
+ */
+int32_t filterMedian(MedianFilterData_t* pMedian, int32_t sensorValue);
+
 #endif
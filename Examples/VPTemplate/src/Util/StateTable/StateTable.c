@@ -15,7 +15,9 @@
 
 /***** INCLUDES **************************************************************/
 #include "StateTable.h"
-#include "Global.h"
+#include "Critical.h"
+
+#include <string.h>
 
 
 
@@ -29,7 +31,15 @@
 
 
 /***** PRIVATE PROTOTYPES ****************************************************/
-static bool stateTableFindState(StateTable_t* pStateTable, int32_t stateID, State_t** pFoundState);
+static uint8_t stateTableEventPriority(const StateTableDefinition_t* pDefinition, uint8_t event);
+static uint8_t stateTableDepth(const StateTableDefinition_t* pDefinition, uint8_t stateIndex);
+static int32_t stateTableTakeEvent(StateTable_t* pStateTable);
+static int32_t stateTableDispatchEvent(StateTable_t* pStateTable, int32_t currentEvent);
+static void stateTableTransition(StateTable_t* pStateTable, const StateTableEntry_t* pEntry, int32_t currentEvent);
+static uint8_t stateTableCommonAncestor(const StateTableDefinition_t* pDefinition, uint8_t stateIndexA, uint8_t stateIndexB);
+static void stateTableEnterState(StateTable_t* pStateTable);
+static void stateTableRemoveEvent(StateTable_t* pStateTable, uint8_t event);
+static int32_t stateTableRunToCompletion(StateTable_t* pStateTable);
 
 
 /***** PRIVATE VARIABLES *****************************************************/
@@ -38,125 +48,160 @@ static bool stateTableFindState(StateTable_t* pStateTable, int32_t stateID, Stat
 /***** PUBLIC FUNCTIONS ******************************************************/
 
 
-int32_t stateTableInitialize(StateTable_t* pStateTable, StateTableEntry_t* pTableEntries, int32_t entryCount, int32_t initStateID)
+int32_t stateTableInitialize(StateTable_t* pStateTable, const StateTableDefinition_t* pDefinition, void* pContext)
 {
     // Check for valid pointer
-    if (pStateTable == 0 || pTableEntries == 0)
+    if (pStateTable == 0 || pDefinition == 0 || pDefinition->pStates == 0 || pDefinition->pDispatch == 0)
         return STATETBL_ERR_INVALID_PTR;
 
-    // Initialize the State Table
-    pStateTable->pTableEntries          = pTableEntries;
-    pStateTable->stateTableEntryCount   = entryCount;
-
-    // Initialize the dynamic entry data
-    for (int32_t i=0; i<pStateTable->stateTableEntryCount; i++)
-    {
-        int32_t fromStateID = pStateTable->pTableEntries[i].stateIDFrom;
-        int32_t toStateID = pStateTable->pTableEntries[i].stateIDTo;
+    if (pDefinition->initialState >= pDefinition->stateCount)
+        return STATETBL_ERR_INVALID_STATE_ID;
 
-        // Find the state in the state list
-        State_t* pStateFrom = 0;
-        stateTableFindState(pStateTable, fromStateID, &pStateFrom);
+    // The definition is already resolved, only the instance data is set up
+    memset(pStateTable, 0, sizeof(StateTable_t));
 
-        State_t* pStateTo = 0;
-        stateTableFindState(pStateTable, toStateID, &pStateTo);
+    pStateTable->pDefinition            = pDefinition;
+    pStateTable->pContext               = pContext;
+    pStateTable->currentState           = pDefinition->initialState;
+    pStateTable->previousState          = STT_NO_STATE;
+    pStateTable->enteredDepth           = 0;
+    pStateTable->lastHandledEvent       = STT_NONE_EVENT;
+    pStateTable->runToCompletion        = false;
 
-        pStateTable->pTableEntries[i].pFromStateRef = pStateFrom;
-        pStateTable->pTableEntries[i].pToStateRef = pStateTo;
+    for (int32_t i=0; i<STATETBL_MAX_DEPTH; i++)
+    {
+        pStateTable->timers[i].pStateTable = pStateTable;
     }
 
-    pStateTable->currentStateID         = initStateID;
-    pStateTable->previousStateID        = STT_UNKNOWN_STATE;
-    pStateTable->pendingEvent           = STT_NONE_EVENT;
-    pStateTable->lastHandledEvent       = STT_NONE_EVENT;
+    return STATETBL_ERR_OK;
+}
 
-    stateTableFindState(pStateTable, pStateTable->currentStateID, &(pStateTable->pCurrentStateRef));
+int32_t stateTableAttachTimerWheel(StateTable_t* pStateTable, StateTimerWheel_t* pTimerWheel)
+{
+    // Check for valid pointer
+    if (pStateTable == 0 || pTimerWheel == 0)
+        return STATETBL_ERR_INVALID_PTR;
+
+    pStateTable->pTimerWheel = pTimerWheel;
 
     return STATETBL_ERR_OK;
 }
 
+int32_t stateTableAttachTrace(StateTable_t* pStateTable, StateTrace_t* pTrace)
+{
+    // Check for valid pointer
+    if (pStateTable == 0 || pTrace == 0)
+        return STATETBL_ERR_INVALID_PTR;
 
-int32_t stateTableRunCyclic(StateTable_t* pStateTable)
+    pStateTable->pTrace = pTrace;
+
+    return STATETBL_ERR_OK;
+}
+
+int32_t stateTableValidate(const StateTableDefinition_t* pDefinition)
 {
-    int32_t result = STATETBL_ERR_EVENT_UNHANDLED;
+    // Check for valid pointer
+    if (pDefinition == 0 || pDefinition->pStates == 0 || pDefinition->pDispatch == 0)
+        return STATETBL_ERR_INVALID_PTR;
 
-    // Get the current pending event and reset it in the table
-    // to indicate that the event has been processed
-    int32_t currentEvent        = pStateTable->pendingEvent;
-    pStateTable->pendingEvent   = STT_NONE_EVENT;
+    if (pDefinition->stateCount == 0 || pDefinition->stateCount >= STT_NO_STATE || pDefinition->initialState >= pDefinition->stateCount)
+        return STATETBL_ERR_INVALID_STATE_ID;
 
-    // Check for new Event
-    if (currentEvent != STT_NONE_EVENT)
+    for (int32_t i=0; i<pDefinition->stateCount; i++)
     {
-        // If there is an even, lets dispatch it
-        for (int32_t i=0; i<pStateTable->stateTableEntryCount; i++)
+        const State_t* pState = &(pDefinition->pStates[i]);
+        if (pState->timeout > 0 && (pState->timeoutEvent == STT_NONE_EVENT || pState->timeoutEvent >= pDefinition->eventCount))
+        {
+            return STATETBL_ERR_INVALID_EVENT_ID;
+        }
+
+        // Walk up to the top level state, also stops a cycle in the parent relation
+        uint8_t depth = 0;
+        for (uint8_t index = pDefinition->pStates[i].parentIndex; index != STT_NO_PARENT; index = pDefinition->pStates[index].parentIndex)
         {
-            StateTableEntry_t* pEntry = &(pStateTable->pTableEntries[i]);
-            // Iterate through the state table and try to find the entry for the state/event combination
-            if (pEntry->stateIDFrom == pStateTable->currentStateID && pEntry->eventID == currentEvent)
+            if (index >= pDefinition->stateCount || ++depth >= STATETBL_MAX_DEPTH)
             {
-                bool transitionAllowed = true;
+                return STATETBL_ERR_INVALID_STATE_ID;
+            }
+        }
 
-                // We found an entry with the actual state and event combination
-                if (pEntry->pGuard != 0)
+        for (int32_t j=0; j<pDefinition->eventCount; j++)
+        {
+            int32_t chainLength = 0;
+            const StateTableEntry_t* pEntry = pDefinition->pDispatch[i * pDefinition->eventCount + j];
+
+            for (; pEntry != 0; pEntry = pEntry->pNext)
+            {
+                // Every transition of a cell has to belong to the cell
+                if (pEntry->stateIndexFrom != i || pEntry->stateIndexTo >= pDefinition->stateCount)
                 {
-                    // Check if the transition is allowed
-                    transitionAllowed = pEntry->pGuard(pEntry, currentEvent);
+                    return STATETBL_ERR_INVALID_STATE_ID;
                 }
-
-                if (transitionAllowed == true)
+                if (j == STT_NONE_EVENT || pEntry->eventID != j || ++chainLength > UINT8_MAX)
                 {
-                    // Call the onExit function for the current state
-                    if (pEntry->pFromStateRef != 0)
-                    {
-                        if (pEntry->pFromStateRef->pOnExit != 0)
-                        {
-                            // Call OnExit
-                            pEntry->pFromStateRef->pOnExit(pEntry->pFromStateRef, currentEvent);
-                        }
-
-                        // Reset the OnEntry flag
-                        pEntry->pFromStateRef->onEntryCalled = false;
-                    }
-
-                    DEBUG_LOGF("State Transition from %d to %d with event %d\n\r", pStateTable->currentStateID, pEntry->stateIDTo, currentEvent);
-
-                    // Perform the transition
-                    pStateTable->previousStateID    = pStateTable->currentStateID;
-                    pStateTable->currentStateID     = pEntry->stateIDTo;
-                    pStateTable->pCurrentStateRef   = pEntry->pToStateRef;
-                    pStateTable->lastHandledEvent   = currentEvent;
-
-                    // On Entry will be called in the normal cycle
-
-                    result = STATETBL_ERR_OK;
-                    break;
+                    return STATETBL_ERR_INVALID_EVENT_ID;
                 }
             }
         }
     }
-    else
+
+    return STATETBL_ERR_OK;
+}
+
+
+int32_t stateTableRunCyclic(StateTable_t* pStateTable)
+{
+    int32_t result = STATETBL_ERR_EVENT_UNHANDLED;
+
+    // Check for valid pointer
+    if (pStateTable == 0 || pStateTable->pDefinition == 0)
+        return STATETBL_ERR_INVALID_PTR;
+
+    if (pStateTable->runToCompletion == true)
+        return stateTableRunToCompletion(pStateTable);
+
+    // A state reached by the last transition is entered before its first event,
+    // even if further events are already queued. Events sent by the entry
+    // functions of an idle state machine are processed in the next cycle.
+    bool eventPending = (pStateTable->eventCount != 0);
+    if (pStateTable->enteredDepth <= stateTableDepth(pStateTable->pDefinition, pStateTable->currentState))
     {
-        // No new event, then we check whether we need to call an Onentry function and continue with the normal
-        // cyclic state function
-        if (pStateTable->pCurrentStateRef != 0)
-        {
-            State_t *pCurrentState = pStateTable->pCurrentStateRef;
+        stateTableEnterState(pStateTable);
+    }
+
+    // Get the next pending event and remove it from the queue
+    // to indicate that the event has been processed
+    int32_t currentEvent = (eventPending == true) ? stateTableTakeEvent(pStateTable) : STT_NONE_EVENT;
 
-            // Check for onEntry call
-            if (pCurrentState->pOnEntry != 0 && pCurrentState->onEntryCalled == false)
+    // Check for new Event
+    if (currentEvent != STT_NONE_EVENT)
+    {
+        // Events without a transition are consumed until one causes a transition,
+        // the entry function of the new state has to run before the next event
+        for (int32_t consumedEvents = 1; ; consumedEvents++)
+        {
+            result = stateTableDispatchEvent(pStateTable, currentEvent);
+            if (result == STATETBL_ERR_OK || consumedEvents >= STATETBL_EVENTS_PER_CYCLE)
             {
-                pCurrentState->pOnEntry(pCurrentState, pStateTable->lastHandledEvent);
-                pCurrentState->onEntryCalled = true;
+                break;
             }
 
-            // Now call the cyclic function
-            if (pCurrentState->pOnState != 0)
+            currentEvent = stateTableTakeEvent(pStateTable);
+            if (currentEvent == STT_NONE_EVENT)
             {
-                pCurrentState->pOnState(pCurrentState, pStateTable->lastHandledEvent);
+                break;
             }
         }
     }
+    else
+    {
+        // No new event, the current state is entered already, so call the cyclic state function
+        const State_t* pCurrentState = &(pStateTable->pDefinition->pStates[pStateTable->currentState]);
+        if (pCurrentState->pOnState != 0)
+        {
+            pCurrentState->pOnState(pStateTable, pStateTable->lastHandledEvent);
+        }
+    }
 
     return result;
 }
@@ -164,21 +209,93 @@ int32_t stateTableRunCyclic(StateTable_t* pStateTable)
 int32_t stateTableSendEvent(StateTable_t* pStateTable, int32_t event)
 {
     // Check for valid pointer
-    if (pStateTable == 0 )
+    if (pStateTable == 0 || pStateTable->pDefinition == 0)
         return STATETBL_ERR_INVALID_PTR;
 
-    // Check if there is still an event pending. If so, we do not
-    // overwrite the old event but return an error
-    if (pStateTable->pendingEvent != STT_NONE_EVENT)
+    // Events outside of the dispatch matrix can't be handled by any transition
+    if (event <= STT_NONE_EVENT || event >= pStateTable->pDefinition->eventCount)
+        return STATETBL_ERR_INVALID_EVENT_ID;
+
+    int32_t result = STATETBL_ERR_OK;
+    const StateTableDefinition_t* pDefinition = pStateTable->pDefinition;
+    uint8_t priority = stateTableEventPriority(pDefinition, (uint8_t) event);
+
+    // The queue is shared with interrupts sending events
+    uint32_t state = criticalEnter();
+
+    // Coalesce the event with the same event already waiting in the queue
+    for (int32_t i=0; i<pStateTable->eventCount; i++)
     {
-        return STATETBL_ERR_EVENT_PENDING;
+        if (pStateTable->eventQueue[i] == event)
+        {
+            pStateTable->eventStatistics.coalescedCount++;
+            criticalExit(state);
+            return STATETBL_ERR_OK;
+        }
     }
-    else
+
+    int32_t count = pStateTable->eventCount;
+
+    if (count >= STATETBL_EVENT_QUEUE_SIZE)
     {
-        // If no pending event is waiting, we set the new event
-        pStateTable->pendingEvent = event;
+        // The last event is the newest one with the lowest priority, it makes
+        // room for the new event only if the new event is more important
+        pStateTable->eventStatistics.droppedCount++;
+        if (stateTableEventPriority(pDefinition, pStateTable->eventQueue[count - 1]) <= priority)
+        {
+            result = STATETBL_ERR_QUEUE_FULL;
+        }
+        else
+        {
+            count--;
+        }
     }
 
+    if (result == STATETBL_ERR_OK)
+    {
+        // Insert behind all events with the same or a higher priority
+        int32_t position = count;
+        while (position > 0 && stateTableEventPriority(pDefinition, pStateTable->eventQueue[position - 1]) > priority)
+        {
+            pStateTable->eventQueue[position] = pStateTable->eventQueue[position - 1];
+            position--;
+        }
+        pStateTable->eventQueue[position] = (uint8_t) event;
+        pStateTable->eventCount = (uint8_t) (count + 1);
+
+        pStateTable->eventStatistics.sentCount++;
+        if ((uint32_t) (count + 1) > pStateTable->eventStatistics.maxDepth)
+        {
+            pStateTable->eventStatistics.maxDepth = (uint32_t) (count + 1);
+        }
+    }
+
+    criticalExit(state);
+
+    return result;
+}
+
+int32_t stateTableSetRunToCompletion(StateTable_t* pStateTable, bool enabled)
+{
+    // Check for valid pointer
+    if (pStateTable == 0)
+        return STATETBL_ERR_INVALID_PTR;
+
+    pStateTable->runToCompletion = enabled;
+
+    return STATETBL_ERR_OK;
+}
+
+int32_t stateTableGetEventStatistics(StateTable_t* pStateTable, StateTableEventStatistics_t* pStatistics)
+{
+    // Check for valid pointer
+    if (pStateTable == 0 || pStatistics == 0)
+        return STATETBL_ERR_INVALID_PTR;
+
+    uint32_t state = criticalEnter();
+    *pStatistics = pStateTable->eventStatistics;
+    criticalExit(state);
+
     return STATETBL_ERR_OK;
 }
 
@@ -186,30 +303,336 @@ int32_t stateTableSendEvent(StateTable_t* pStateTable, int32_t event)
 /***** PRIVATE FUNCTIONS *****************************************************/
 
 /**
- * @brief Searches for a state in the state list with the provided state ID
+ * @brief Returns the priority of an event
+ *
+ * @param pDefinition   Definition of the state machine
+ * @param event         Event ID
+ * @return Priority of the event, 0 is the highest priority
+ */
+static uint8_t stateTableEventPriority(const StateTableDefinition_t* pDefinition, uint8_t event)
+{
+    if (pDefinition->pEventPriority == 0)
+    {
+        return STATETBL_EVENT_PRIORITY_DEFAULT;
+    }
+
+    return pDefinition->pEventPriority[event];
+}
+
+/**
+ * @brief Returns the nesting depth of a state
+ *
+ * @param pDefinition   Definition of the state machine
+ * @param stateIndex    Index of the state
+ * @return Number of ancestors of the state, 0 for a top level state
+ */
+static uint8_t stateTableDepth(const StateTableDefinition_t* pDefinition, uint8_t stateIndex)
+{
+    uint8_t depth = 0;
+
+    for (uint8_t index = pDefinition->pStates[stateIndex].parentIndex; index != STT_NO_PARENT; index = pDefinition->pStates[index].parentIndex)
+    {
+        depth++;
+    }
+
+    return depth;
+}
+
+/**
+ * @brief Removes the event with the highest priority from the event queue
+ *
+ * @param pStateTable   Pointer to the state table to use
+ * @return The removed event or STT_NONE_EVENT if the queue is empty
+ */
+static int32_t stateTableTakeEvent(StateTable_t* pStateTable)
+{
+    int32_t event = STT_NONE_EVENT;
+
+    uint32_t state = criticalEnter();
+
+    if (pStateTable->eventCount > 0)
+    {
+        event = pStateTable->eventQueue[0];
+        pStateTable->eventCount--;
+        for (int32_t i=0; i<pStateTable->eventCount; i++)
+        {
+            pStateTable->eventQueue[i] = pStateTable->eventQueue[i + 1];
+        }
+    }
+
+    criticalExit(state);
+
+    return event;
+}
+
+/**
+ * @brief Performs the transition for an event in the current state
  *
  * @param pStateTable   Pointer to the state table to use
- * @param stateID       State ID to search for
- * @param pFoundState   Poitner to the found state entry
- * @return true         If the state with the state ID was found
- * @return false        If the state was not found
+ * @param currentEvent  Event to dispatch
+ * @return STATETBL_ERR_OK if a transition was performed, STATETBL_ERR_EVENT_UNHANDLED
+ * if the current state has no (allowed) transition for the event
  */
-static bool stateTableFindState(StateTable_t* pStateTable, int32_t stateID, State_t** pFoundState)
+static int32_t stateTableDispatchEvent(StateTable_t* pStateTable, int32_t currentEvent)
 {
-    bool foundState = false;
-    *pFoundState = 0;
+    const StateTableDefinition_t* pDefinition = pStateTable->pDefinition;
 
-    for (int32_t i=0; i<pStateTable->stateCount; i++)
+    // Events not handled by a state bubble up to its ancestors
+    uint8_t stateIndex = pStateTable->currentState;
+    while (stateIndex != STT_NO_PARENT)
     {
-        State_t* pState = &(pStateTable->pStateList[i]);
-        if (pState->stateID == stateID)
+        // Look up the first transition for the state/event combination
+        const StateTableEntry_t* pEntry = pDefinition->pDispatch[stateIndex * pDefinition->eventCount + currentEvent];
+
+        // Try the transitions for this combination until a guard allows one
+        for (; pEntry != 0; pEntry = pEntry->pNext)
         {
-            // We found the state entry for the requested ID
-            *pFoundState = pState;
-            foundState = true;
+            bool transitionAllowed = true;
+            uint8_t guardResult = STATE_TRACE_GUARD_NONE;
+
+            if (pEntry->pGuard != 0)
+            {
+                // Check if the transition is allowed
+                transitionAllowed = pEntry->pGuard(pStateTable, pEntry, currentEvent);
+                guardResult = (transitionAllowed == true) ? STATE_TRACE_GUARD_PASSED : STATE_TRACE_GUARD_REJECTED;
+            }
+
+            if (pStateTable->pTrace != 0)
+            {
+                stateTraceRecord(pStateTable->pTrace, pStateTable->currentState, pEntry->stateIndexTo, (uint8_t) currentEvent, guardResult);
+            }
+
+            if (transitionAllowed == true)
+            {
+                stateTableTransition(pStateTable, pEntry, currentEvent);
+                return STATETBL_ERR_OK;
+            }
+        }
+
+        stateIndex = pDefinition->pStates[stateIndex].parentIndex;
+    }
+
+    return STATETBL_ERR_EVENT_UNHANDLED;
+}
+
+/**
+ * @brief Performs a transition: exits the states from the current state up to
+ * the least common ancestor (LCA) of the source and the target state and
+ * switches to the target state. The entry functions from below the LCA down
+ * to the target state are called by stateTableEnterState().
+ *
+ * A transition to the own state exits and enters the source state again. A
+ * transition from an ancestor to one of its descendants doesn't exit the
+ * ancestor (local transition). States whose entry function hasn't been
+ * called yet aren't exited.
+ *
+ * @param pStateTable   Pointer to the state table to use
+ * @param pEntry        Transition to perform
+ * @param currentEvent  Event which triggered the transition
+ */
+static void stateTableTransition(StateTable_t* pStateTable, const StateTableEntry_t* pEntry, int32_t currentEvent)
+{
+    const StateTableDefinition_t* pDefinition = pStateTable->pDefinition;
+
+    uint8_t ancestorIndex = stateTableCommonAncestor(pDefinition, pEntry->stateIndexFrom, pEntry->stateIndexTo);
+    if (ancestorIndex == pEntry->stateIndexFrom && pEntry->stateIndexFrom == pEntry->stateIndexTo)
+    {
+        ancestorIndex = pDefinition->pStates[ancestorIndex].parentIndex;
+    }
+
+    // Exit from the innermost state outwards
+    uint8_t stateIndex = pStateTable->currentState;
+    int32_t depth = stateTableDepth(pDefinition, stateIndex);
+    while (stateIndex != ancestorIndex && stateIndex != STT_NO_PARENT)
+    {
+        const State_t* pState = &(pDefinition->pStates[stateIndex]);
+        if (depth < pStateTable->enteredDepth)
+        {
+            if (pState->pOnExit != 0)
+            {
+                // Call OnExit
+                pState->pOnExit(pStateTable, currentEvent);
+            }
+
+            // A timeout of the state must not reach the next state
+            if (pState->timeout > 0 && pStateTable->pTimerWheel != 0)
+            {
+                stateTimerCancel(pStateTable->pTimerWheel, &(pStateTable->timers[depth]));
+                stateTableRemoveEvent(pStateTable, pState->timeoutEvent);
+            }
+        }
+
+        stateIndex = pState->parentIndex;
+        depth--;
+    }
+
+    // The states down to the common ancestor stay entered
+    if (depth + 1 < pStateTable->enteredDepth)
+    {
+        pStateTable->enteredDepth = (uint8_t) (depth + 1);
+    }
+
+    // Perform the transition
+    pStateTable->previousState      = pStateTable->currentState;
+    pStateTable->currentState       = pEntry->stateIndexTo;
+    pStateTable->lastHandledEvent   = (uint8_t) currentEvent;
+
+    // On Entry will be called in the normal cycle
+}
+
+/**
+ * @brief Searches the least common ancestor of two states, a state counts as
+ * its own ancestor
+ *
+ * @param pDefinition   Definition of the state machine
+ * @param stateIndexA   Index of the first state
+ * @param stateIndexB   Index of the second state
+ * @return Index of the common ancestor or STT_NO_PARENT if the states have no
+ * common ancestor
+ */
+static uint8_t stateTableCommonAncestor(const StateTableDefinition_t* pDefinition, uint8_t stateIndexA, uint8_t stateIndexB)
+{
+    uint8_t depthA = stateTableDepth(pDefinition, stateIndexA);
+    uint8_t depthB = stateTableDepth(pDefinition, stateIndexB);
+
+    // Bring both states to the same depth, then ascend in parallel
+    for (; depthA > depthB; depthA--)
+    {
+        stateIndexA = pDefinition->pStates[stateIndexA].parentIndex;
+    }
+    for (; depthB > depthA; depthB--)
+    {
+        stateIndexB = pDefinition->pStates[stateIndexB].parentIndex;
+    }
+    while (stateIndexA != stateIndexB)
+    {
+        stateIndexA = pDefinition->pStates[stateIndexA].parentIndex;
+        stateIndexB = pDefinition->pStates[stateIndexB].parentIndex;
+    }
+
+    return stateIndexA;
+}
+
+/**
+ * @brief Calls the onEntry functions of the current state and its ancestors
+ * which haven't been entered yet, from the outermost state inwards
+ *
+ * @param pStateTable   Pointer to the state table to use
+ */
+static void stateTableEnterState(StateTable_t* pStateTable)
+{
+    const StateTableDefinition_t* pDefinition = pStateTable->pDefinition;
+    uint8_t path[STATETBL_MAX_DEPTH];
+    int32_t pathLength = 0;
+
+    // Path from the current state up to the top level state
+    for (uint8_t index = pStateTable->currentState; index != STT_NO_PARENT && pathLength < STATETBL_MAX_DEPTH; index = pDefinition->pStates[index].parentIndex)
+    {
+        path[pathLength++] = index;
+    }
+
+    // The already entered ancestors stay active
+    while (pStateTable->enteredDepth < pathLength)
+    {
+        const State_t* pState = &(pDefinition->pStates[path[pathLength - 1 - pStateTable->enteredDepth]]);
+
+        if (pState->timeout > 0 && pStateTable->pTimerWheel != 0)
+        {
+            StateTimer_t* pTimer = &(pStateTable->timers[pStateTable->enteredDepth]);
+            pTimer->event = pState->timeoutEvent;
+            stateTimerArm(pStateTable->pTimerWheel, pTimer, pState->timeout);
+        }
+
+        pStateTable->enteredDepth++;
+
+        if (pState->pOnEntry != 0)
+        {
+            pState->pOnEntry(pStateTable, pStateTable->lastHandledEvent);
+        }
+    }
+}
+
+/**
+ * @brief Removes an event from the event queue
+ *
+ * @param pStateTable   Pointer to the state table to use
+ * @param event         Event to remove
+ */
+static void stateTableRemoveEvent(StateTable_t* pStateTable, uint8_t event)
+{
+    uint32_t state = criticalEnter();
+
+    // Events are coalesced, so the event is queued at most once
+    for (int32_t i=0; i<pStateTable->eventCount; i++)
+    {
+        if (pStateTable->eventQueue[i] == event)
+        {
+            pStateTable->eventCount--;
+            for (int32_t j=i; j<pStateTable->eventCount; j++)
+            {
+                pStateTable->eventQueue[j] = pStateTable->eventQueue[j + 1];
+            }
             break;
         }
     }
 
-    return foundState;
+    criticalExit(state);
+}
+
+/**
+ * @brief Run to completion cycle: processes the events including the ones sent
+ * by the entry and state functions until the state machine is quiescent.
+ * The entry function of a new state runs directly after the transition, the
+ * state function of the final state runs once per cycle. At most
+ * STATETBL_RTC_MAX_STEPS events are processed, further events stay queued
+ * for the next cycle, so two states sending events to each other can't
+ * block the caller.
+ *
+ * @param pStateTable   Pointer to the state table to use
+ * @return STATETBL_ERR_OK if at least one transition was performed
+ */
+static int32_t stateTableRunToCompletion(StateTable_t* pStateTable)
+{
+    int32_t result = STATETBL_ERR_EVENT_UNHANDLED;
+    bool stateFunctionCalled = false;
+
+    for (int32_t steps = 0; ; )
+    {
+        // Entry actions may send events as well (e.g. the result of a self test)
+        stateTableEnterState(pStateTable);
+
+        int32_t currentEvent = stateTableTakeEvent(pStateTable);
+        if (currentEvent != STT_NONE_EVENT)
+        {
+            if (stateTableDispatchEvent(pStateTable, currentEvent) == STATETBL_ERR_OK)
+            {
+                result = STATETBL_ERR_OK;
+            }
+
+            steps++;
+            if (steps >= STATETBL_RTC_MAX_STEPS)
+            {
+                // The entry function of the last state runs in the next cycle
+                pStateTable->eventStatistics.stepLimitCount++;
+                break;
+            }
+        }
+        else if (stateFunctionCalled == false)
+        {
+            // The state function may send events, which are processed in this cycle as well
+            const State_t* pCurrentState = &(pStateTable->pDefinition->pStates[pStateTable->currentState]);
+            if (pCurrentState->pOnState != 0)
+            {
+                pCurrentState->pOnState(pStateTable, pStateTable->lastHandledEvent);
+            }
+            stateFunctionCalled = true;
+        }
+        else
+        {
+            // Quiescent: no event pending and all actions done
+            break;
+        }
+    }
+
+    return result;
 }
@@ -10,6 +10,50 @@
  *
  * @brief file for a generic state table implementation
  *
+ * @details A state machine is split into a constant definition and the
+ * runtime instances. The definition (states, transitions, guards, dispatch
+ * matrix and event priorities) is completely resolved by index and can be
+ * placed in flash, the instance (StateTable_t) only holds the current
+ * state, the event queue and the statistics. Several instances can run the
+ * same definition, each with its own context pointer (e.g. one per pump).
+ *
+ * States and transitions reference states by their index in the state
+ * list. The dispatch matrix [state index][event ID] holds the first
+ * transition for each combination, further transitions for the same
+ * combination (e.g. with different guards) are chained via pNext.
+ * Dispatching an event is therefore a single lookup. stateTableValidate()
+ * checks the consistency of a definition, e.g. in a host test.
+ *
+ * Events are collected in a small queue per instance, sorted by the
+ * priority of the event (0 is the highest priority) and in sending order
+ * within the same priority. An event which is already queued is coalesced.
+ * If the queue is full, the newest event with the lowest priority is
+ * dropped, so fault events are never lost behind less important ones.
+ * stateTableSendEvent() may be called from interrupts.
+ *
+ * States can be nested by a parent state index. An event which has no
+ * (allowed) transition in the current state bubbles up to its ancestors, so
+ * common transitions are only listed once at the parent. A transition exits
+ * the states up to the least common ancestor of the source and the target
+ * state and enters the states below it down to the target state. The
+ * target state of a transition should be a leaf state, the state function
+ * is only called for the current (innermost) state.
+ *
+ * A state can declare a timeout: the timeout event is sent after the state
+ * has been active for the given time (see StateTimer.h). The timers of an
+ * instance are driven by a timer wheel attached with
+ * stateTableAttachTimerWheel(), without a wheel the timeouts are ignored.
+ *
+ * The transitions and rejected guards are recorded as binary records into
+ * a trace buffer attached with stateTableAttachTrace() (see StateTrace.h),
+ * nothing is formatted or printed while the event is dispatched.
+ *
+ * By default a transition consumes one stateTableRunCyclic() call and the
+ * entry function of the new state runs in the next call. In the run to
+ * completion mode (stateTableSetRunToCompletion()) a single call processes
+ * the events, the exit, transition and entry actions until the state
+ * machine is quiescent, bounded by STATETBL_RTC_MAX_STEPS events.
+ *
  *
  *****************************************************************************/
 #ifndef _STATE_TABLE_H_
@@ -19,6 +63,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "StateTimer.h"
+#include "StateTrace.h"
+
 
 
 /***** CONSTANTS *************************************************************/
@@ -31,111 +78,195 @@
 #define STATETBL_ERR_INVALID_EVENT_ID       -3      //!< Invalid event ID found
 #define STATETBL_ERR_EVENT_PENDING          -4      //!< New event sent but still an event is pending
 #define STATETBL_ERR_EVENT_UNHANDLED        -5      //!< Event couldn't be handled
+#define STATETBL_ERR_QUEUE_FULL             -6      //!< Event queue is full, the event was dropped
 
-#define STT_INVALID_STATE                   -1      //!< Invalid state
-#define STT_INITIAL_STATE                   0       //!< Initial state for startup of State Machine
-#define STT_UNKNOWN_STATE                   1       //!< Unknown state ID
+#define STT_NO_STATE                        0xFF    //!< Invalid state index (e.g. no previous state)
+#define STT_NO_PARENT                       STT_NO_STATE    //!< Parent state index of a top level state
 
 #define STT_NONE_EVENT                      0       //!< ID for "No Event"
 
-#
+#ifndef STATETBL_MAX_DEPTH
+#define STATETBL_MAX_DEPTH                  4       //!< Maximum nesting depth of the states
+#endif
+
+#ifndef STATETBL_EVENT_QUEUE_SIZE
+#define STATETBL_EVENT_QUEUE_SIZE           8       //!< Maximum number of queued events per state table
+#endif
+
+#ifndef STATETBL_EVENTS_PER_CYCLE
+#define STATETBL_EVENTS_PER_CYCLE           4       //!< Maximum number of events consumed per stateTableRunCyclic() call
+#endif
+
+#ifndef STATETBL_RTC_MAX_STEPS
+#define STATETBL_RTC_MAX_STEPS              8       //!< Maximum number of events processed per run to completion cycle
+#endif
+
+#define STATETBL_EVENT_PRIORITY_HIGHEST     0       //!< Highest event priority (e.g. fault events)
+#define STATETBL_EVENT_PRIORITY_DEFAULT     128     //!< Priority of the events without a priority table
 
 
 /***** TYPES *****************************************************************/
 // Forward Declaration for StateEntry
-typedef struct _State State_t;
+typedef struct _StateTable StateTable_t;
 typedef struct _StateTableEntry StateTableEntry_t;
 
 /**
  * @brief Function pointer for state function (state, on entry, on exit)
  *
  */
-typedef int32_t (*StateFunction)(State_t* pState, int32_t eventID);
+typedef int32_t (*StateFunction)(StateTable_t* pStateTable, int32_t eventID);
 
 /**
  * @brief Function pointer for the transition guards to check whether a
  * transistion is allowed or not
  *
  */
-typedef bool (*TransitionGuardFunction)(StateTableEntry_t* pEntry, int32_t eventID);
+typedef bool (*TransitionGuardFunction)(StateTable_t* pStateTable, const StateTableEntry_t* pEntry, int32_t eventID);
 
 /**
- * @brief Struct to represent a state in the state machine
+ * @brief Struct to represent a state in the state machine (constant)
  *
  */
 typedef struct _State
 {
-    // Static fields used for state configuration
-    int32_t stateID;                        //!< ID of the state
     StateFunction pOnEntry;                 //!< Function pointer for the on entry function of the state
     StateFunction pOnState;                 //!< Function Pointer for the state function
     StateFunction pOnExit;                  //!< Function pointer for the on exit function of the state
-
-    // Dynamic fields used during runtime
-    bool onEntryCalled;                     //!< Flag to indicate whethter the onEntry function has been called
+    uint8_t parentIndex;                    //!< Index of the parent state, STT_NO_PARENT for a top level state
+    uint8_t timeoutEvent;                   //!< Event sent when the timeout expired
+    uint32_t timeout;                       //!< Time in milliseconds after the entry until timeoutEvent is sent, 0 for no timeout
 } State_t;
 
 /**
- * @brief Struct to represent an entry in the state table
+ * @brief Struct to represent an entry in the state table (constant)
  *
  */
 typedef struct _StateTableEntry
 {
-    // Static fileds used for state table configuration
-    int32_t stateIDFrom;                    //!< ID of the state the transition starts from
-    int32_t stateIDTo;                      //!< ID of the state the transition will go to
-    int32_t eventID;                        //!< Event which triggers the transition
+    uint8_t stateIndexFrom;                 //!< Index of the state the transition starts from
+    uint8_t stateIndexTo;                   //!< Index of the state the transition will go to
+    uint8_t eventID;                        //!< Event which triggers the transition
 
     TransitionGuardFunction pGuard;         //!< Function pointer for a transition guard function
 
-    // Dynamic files used during runtime
-    State_t* pFromStateRef;                 //!< Pointer to the "from state object"
-    State_t* pToStateRef;                   //!< Poitner to the "to state object"
+    const StateTableEntry_t* pNext;         //!< Next transition for the same state/event combination, tried if the guard rejects
 } StateTableEntry_t;
 
 /**
- * @brief Struct which represents the state table respectivly the
- * complete state machine including current and previous state
+ * @brief Constant definition of a state machine, shared by all instances
+ *
+ */
+typedef struct _StateTableDefinition
+{
+    const State_t* pStates;                 //!< List of all states, the position is the state index
+    uint8_t stateCount;                     //!< Number of total states
+    uint8_t eventCount;                     //!< Number of event IDs (columns of the dispatch matrix)
+    uint8_t initialState;                   //!< Index of the initial state
+
+    const StateTableEntry_t* const* pDispatch;  //!< Dispatch matrix [stateCount][eventCount] with the first transition or 0
+    const uint8_t* pEventPriority;          //!< Priority per event ID, 0 for STATETBL_EVENT_PRIORITY_DEFAULT for all events
+} StateTableDefinition_t;
+
+/**
+ * @brief Statistics of the event queue of a state table
+ *
+ */
+typedef struct _StateTableEventStatistics
+{
+    uint32_t sentCount;                     //!< Number of queued events
+    uint32_t coalescedCount;                //!< Number of events merged with an already queued event
+    uint32_t droppedCount;                  //!< Number of events lost because the queue was full
+    uint32_t maxDepth;                      //!< Maximum number of queued events
+    uint32_t stepLimitCount;                //!< Number of run to completion cycles ended by STATETBL_RTC_MAX_STEPS
+} StateTableEventStatistics_t;
+
+/**
+ * @brief Runtime instance of a state machine including current and previous state
  *
  */
-typedef struct _StateTable
+struct _StateTable
 {
-    int32_t stateTableEntryCount;           //!< Number of entries in the state table
-    StateTableEntry_t* pTableEntries;       //!< Array of state table entries
+    const StateTableDefinition_t* pDefinition;  //!< Definition of the state machine
+    void* pContext;                         //!< User data of the instance, passed through to the state functions
 
-    int32_t stateCount;                     //!< Number of total states
-    State_t* pStateList;                    //!< List of all states
+    uint8_t currentState;                   //!< Index of the current state
+    uint8_t previousState;                  //!< Index of the previous state
+    uint8_t enteredDepth;                   //!< Number of states from the top level state down to the current state which have been entered
+    uint8_t lastHandledEvent;               //!< Last handled event
 
-    int32_t currentStateID;                 //!< ID of the current state
-    int32_t previousStateID;                //!< ID of the previous state
+    bool runToCompletion;                   //!< Process all events and entry actions within one cycle
 
-    State_t *pCurrentStateRef;              //!< Pointer to the current state object
+    volatile uint8_t eventCount;            //!< Number of pending events
+    uint8_t eventQueue[STATETBL_EVENT_QUEUE_SIZE];  //!< Pending events, sorted by priority
+    StateTableEventStatistics_t eventStatistics;    //!< Statistics of the event queue
 
-    int32_t pendingEvent;                   //!< Current pending event
+    StateTimerWheel_t* pTimerWheel;         //!< Timer wheel driving the state timeouts (may be 0)
+    StateTimer_t timers[STATETBL_MAX_DEPTH];    //!< Timeout timer per level of the active state path
 
-    int32_t lastHandledEvent;               //!< Last handled event
-} StateTable_t;
+    StateTrace_t* pTrace;                   //!< Trace buffer of the transitions (may be 0)
+};
 
 
 /***** PROTOTYPES ************************************************************/
 
 /**
- * @brief Initializes the state table instance with the table entries and needed configuration parameter
+ * @brief Initializes a state machine instance with its definition. The
+ * definition isn't modified and may be shared by several instances.
  *
  * @param pStateTable       Pointer to the state table instance
- * @param pTableEntries     Pointer to the list of transitions
- * @param entryCount        Number of entries in the transition list
- * @param initStateID       State ID for the initial state
+ * @param pDefinition       Pointer to the definition of the state machine
+ * @param pContext          User data of the instance (may be 0)
  *
  * @return Returns STATETBL_ERR_OK if no error occured
  */
-int32_t stateTableInitialize(StateTable_t* pStateTable, StateTableEntry_t* pTableEntries, int32_t entryCount, int32_t initStateID);
+int32_t stateTableInitialize(StateTable_t* pStateTable, const StateTableDefinition_t* pDefinition, void* pContext);
+
+/**
+ * @brief Checks a definition: valid state indices and nesting depth, every
+ * transition of the dispatch matrix belongs to its state/event combination,
+ * valid timeout events
+ *
+ * @param pDefinition       Pointer to the definition of the state machine
+ *
+ * @return Returns STATETBL_ERR_OK if the definition is consistent,
+ * STATETBL_ERR_INVALID_STATE_ID or STATETBL_ERR_INVALID_EVENT_ID otherwise
+ */
+int32_t stateTableValidate(const StateTableDefinition_t* pDefinition);
+
+/**
+ * @brief Attaches a timer wheel to a state machine instance, which drives the
+ * timeouts of the states. Has to be called after stateTableInitialize() and
+ * before the first stateTableRunCyclic() call.
+ *
+ * @param pStateTable       Pointer to the state table instance
+ * @param pTimerWheel       Pointer to the (shared) timer wheel
+ *
+ * @return Returns STATETBL_ERR_OK if no error occured
+ */
+int32_t stateTableAttachTimerWheel(StateTable_t* pStateTable, StateTimerWheel_t* pTimerWheel);
+
+/**
+ * @brief Attaches a trace buffer to a state machine instance, which records
+ * the transitions. Has to be called after stateTableInitialize().
+ *
+ * @param pStateTable       Pointer to the state table instance
+ * @param pTrace            Pointer to the trace buffer
+ *
+ * @return Returns STATETBL_ERR_OK if no error occured
+ */
+int32_t stateTableAttachTrace(StateTable_t* pStateTable, StateTrace_t* pTrace);
 
 /**
  * @brief Cyclic run function for the state machine. This function performs either the
  * state transitions if an event is pending or it calles the state function if such a
  * function is provided for the current state
  *
+ * Up to STATETBL_EVENTS_PER_CYCLE pending events are consumed per call. Events
+ * without a transition are dropped, the first transition ends the call so the
+ * entry function of the new state runs before the next event is processed.
+ * The entry functions run at the beginning of the next call; if no event was
+ * pending, the events they send are processed from the call after on.
+ *
  * @param pStateTable   Pointer to the state machine instance
  *
  * @return Returns STATETBL_ERR_OK if no error occured
@@ -144,13 +275,36 @@ int32_t stateTableRunCyclic(StateTable_t* pStateTable);
 
 /**
  * @brief Sends an event to the state machine instance which is processed in the next
- * state machien cycle
+ * state machien cycle. The function is interrupt safe.
  *
  * @param pStateTable   Pointer to the state machine instance
  * @param event         Event ID to send to the state machine
  *
- * @return Returns STATETBL_ERR_OK if no error occured
+ * @return Returns STATETBL_ERR_OK if the event was queued or coalesced,
+ * STATETBL_ERR_QUEUE_FULL if the queue only holds events of the same or a
+ * higher priority
  */
 int32_t stateTableSendEvent(StateTable_t* pStateTable, int32_t event);
 
+/**
+ * @brief Enables or disables the run to completion mode. The mode is disabled
+ * by stateTableInitialize().
+ *
+ * @param pStateTable   Pointer to the state machine instance
+ * @param enabled       true to process events until the state machine is quiescent
+ *
+ * @return Returns STATETBL_ERR_OK if no error occured
+ */
+int32_t stateTableSetRunToCompletion(StateTable_t* pStateTable, bool enabled);
+
+/**
+ * @brief Returns the statistics of the event queue
+ *
+ * @param pStateTable   Pointer to the state machine instance
+ * @param pStatistics   Pointer to the struct which receives the statistics
+ *
+ * @return Returns STATETBL_ERR_OK if no error occured
+ */
+int32_t stateTableGetEventStatistics(StateTable_t* pStateTable, StateTableEventStatistics_t* pStatistics);
+
 #endif
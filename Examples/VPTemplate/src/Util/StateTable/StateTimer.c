@@ -0,0 +1,156 @@
+/******************************************************************************
+ * @file StateTimer.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Implementation of the state timers (hashed timer wheel)
+ *
+ *
+ *****************************************************************************/
+
+/***** INCLUDES **************************************************************/
+#include "StateTimer.h"
+#include "StateTable.h"
+
+#include <string.h>
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define STATE_TIMER_SLOT(time)      (((time) / STATE_TIMER_RESOLUTION_MS) & (STATE_TIMER_WHEEL_SLOTS - 1))    //!< Slot of a point in time
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+static void stateTimerUnlink(StateTimerWheel_t* pWheel, StateTimer_t* pTimer);
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int32_t stateTimerWheelInitialize(StateTimerWheel_t* pWheel, StateTimerGetTick pGetTick)
+{
+    if (pWheel == 0 || pGetTick == 0)
+        return STATE_TIMER_ERR_INVALID_PTR;
+
+    memset(pWheel, 0, sizeof(StateTimerWheel_t));
+    pWheel->pGetTick = pGetTick;
+    pWheel->now = pGetTick();
+
+    return STATE_TIMER_ERR_OK;
+}
+
+int32_t stateTimerWheelAdvance(StateTimerWheel_t* pWheel)
+{
+    if (pWheel == 0 || pWheel->pGetTick == 0)
+        return STATE_TIMER_ERR_INVALID_PTR;
+
+    uint32_t now = pWheel->pGetTick();
+    int32_t expiredCount = 0;
+
+    if (pWheel->armedCount > 0)
+    {
+        // Visit the slots from the last advance up to now, at most one revolution
+        uint32_t slotSteps = now / STATE_TIMER_RESOLUTION_MS - pWheel->now / STATE_TIMER_RESOLUTION_MS;
+        if (slotSteps >= STATE_TIMER_WHEEL_SLOTS)
+        {
+            slotSteps = STATE_TIMER_WHEEL_SLOTS - 1;
+        }
+
+        uint32_t slot = STATE_TIMER_SLOT(pWheel->now);
+        for (uint32_t i = 0; i <= slotSteps; i++)
+        {
+            StateTimer_t* pTimer = pWheel->slots[slot];
+            while (pTimer != 0)
+            {
+                StateTimer_t* pNext = pTimer->pNext;
+
+                // Timers of a later revolution stay in the slot
+                if ((int32_t) (now - pTimer->expiry) >= 0)
+                {
+                    stateTimerUnlink(pWheel, pTimer);
+                    stateTableSendEvent(pTimer->pStateTable, pTimer->event);
+                    expiredCount++;
+                }
+
+                pTimer = pNext;
+            }
+
+            slot = (slot + 1) & (STATE_TIMER_WHEEL_SLOTS - 1);
+        }
+    }
+
+    pWheel->now = now;
+
+    return expiredCount;
+}
+
+void stateTimerArm(StateTimerWheel_t* pWheel, StateTimer_t* pTimer, uint32_t timeout)
+{
+    stateTimerCancel(pWheel, pTimer);
+
+    pTimer->expiry = pWheel->pGetTick() + timeout;
+
+    // Insert at the head of the slot
+    StateTimer_t** ppSlot = &(pWheel->slots[STATE_TIMER_SLOT(pTimer->expiry)]);
+    pTimer->pPrevious = 0;
+    pTimer->pNext = *ppSlot;
+    if (*ppSlot != 0)
+    {
+        (*ppSlot)->pPrevious = pTimer;
+    }
+    *ppSlot = pTimer;
+
+    pTimer->armed = true;
+    pWheel->armedCount++;
+}
+
+void stateTimerCancel(StateTimerWheel_t* pWheel, StateTimer_t* pTimer)
+{
+    if (pTimer->armed == true)
+    {
+        stateTimerUnlink(pWheel, pTimer);
+    }
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
+
+/**
+ * @brief Removes an armed timer from its slot
+ *
+ * @param pWheel        Pointer to the timer wheel
+ * @param pTimer        Pointer to the timer
+ */
+static void stateTimerUnlink(StateTimerWheel_t* pWheel, StateTimer_t* pTimer)
+{
+    if (pTimer->pPrevious != 0)
+    {
+        pTimer->pPrevious->pNext = pTimer->pNext;
+    }
+    else
+    {
+        pWheel->slots[STATE_TIMER_SLOT(pTimer->expiry)] = pTimer->pNext;
+    }
+
+    if (pTimer->pNext != 0)
+    {
+        pTimer->pNext->pPrevious = pTimer->pPrevious;
+    }
+
+    pTimer->pNext = 0;
+    pTimer->pPrevious = 0;
+    pTimer->armed = false;
+    pWheel->armedCount--;
+}
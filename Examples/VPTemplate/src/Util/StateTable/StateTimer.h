@@ -0,0 +1,131 @@
+/******************************************************************************
+ * @file StateTimer.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Header file for the state timers of the state table
+ *
+ * @details A state can declare a timeout: after the state has been active
+ * for the given time, its timeout event is sent to the state machine. The
+ * timer is armed when the state is entered and cancelled when it is exited.
+ *
+ * All timers of all state machine instances are kept in one shared hashed
+ * timer wheel. A timer is stored in the slot of its expiry time, advancing
+ * the wheel only visits the slots passed since the last call and the timers
+ * in these slots. Timers further away than one wheel revolution stay in
+ * their slot until their round has come. Arming and cancelling is O(1).
+ *
+ * @remark: The wheel is not interrupt safe, it has to be advanced from the
+ * same task which runs the state machines.
+ *
+ *
+ *****************************************************************************/
+#ifndef _STATE_TIMER_H_
+#define _STATE_TIMER_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#define STATE_TIMER_ERR_OK                  0       //!< No error occured
+#define STATE_TIMER_ERR_INVALID_PTR         -1      //!< Invalid pointer (null pointer)
+
+#ifndef STATE_TIMER_WHEEL_SLOTS
+#define STATE_TIMER_WHEEL_SLOTS             32      //!< Number of slots of the timer wheel (power of two)
+#endif
+
+#ifndef STATE_TIMER_RESOLUTION_MS
+#define STATE_TIMER_RESOLUTION_MS           10      //!< Time covered by one slot in milliseconds
+#endif
+
+#if (STATE_TIMER_WHEEL_SLOTS & (STATE_TIMER_WHEEL_SLOTS - 1)) != 0
+#error "STATE_TIMER_WHEEL_SLOTS must be a power of two"
+#endif
+
+
+/***** TYPES *****************************************************************/
+struct _StateTable;
+
+/**
+ * @brief Function pointer to get the current time in milliseconds (e.g. HAL_GetTick)
+ *
+ */
+typedef uint32_t (*StateTimerGetTick)(void);
+
+/**
+ * @brief Timer of one state (level of the active state path) of a state machine instance
+ *
+ */
+typedef struct _StateTimer
+{
+    struct _StateTimer* pNext;              //!< Next timer in the same slot
+    struct _StateTimer* pPrevious;          //!< Previous timer in the same slot
+    struct _StateTable* pStateTable;        //!< State machine which receives the event
+    uint32_t expiry;                        //!< Expiry time in milliseconds
+    uint8_t event;                          //!< Event sent on expiry
+    bool armed;                             //!< Timer is in the wheel
+} StateTimer_t;
+
+/**
+ * @brief Timer wheel shared by the state machine instances
+ *
+ */
+typedef struct _StateTimerWheel
+{
+    StateTimer_t* slots[STATE_TIMER_WHEEL_SLOTS];   //!< Timer lists per slot
+    StateTimerGetTick pGetTick;             //!< Time source
+    uint32_t now;                           //!< Time of the last advance in milliseconds
+    uint32_t armedCount;                    //!< Number of armed timers
+} StateTimerWheel_t;
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Initializes a timer wheel
+ *
+ * @param pWheel        Pointer to the timer wheel
+ * @param pGetTick      Time source in milliseconds
+ *
+ * @return STATE_TIMER_ERR_OK if no error occured
+ */
+int32_t stateTimerWheelInitialize(StateTimerWheel_t* pWheel, StateTimerGetTick pGetTick);
+
+/**
+ * @brief Advances the wheel to the current time and sends the events of all
+ * expired timers. Without armed timers the call returns immediately.
+ *
+ * @param pWheel        Pointer to the timer wheel
+ *
+ * @return Number of expired timers
+ */
+int32_t stateTimerWheelAdvance(StateTimerWheel_t* pWheel);
+
+/**
+ * @brief Arms a timer relative to the current time of the time source
+ *
+ * @param pWheel        Pointer to the timer wheel
+ * @param pTimer        Pointer to the timer (re-armed if already armed)
+ * @param timeout       Timeout in milliseconds
+ */
+void stateTimerArm(StateTimerWheel_t* pWheel, StateTimer_t* pTimer, uint32_t timeout);
+
+/**
+ * @brief Cancels a timer, nothing happens if the timer isn't armed
+ *
+ * @param pWheel        Pointer to the timer wheel
+ * @param pTimer        Pointer to the timer
+ */
+void stateTimerCancel(StateTimerWheel_t* pWheel, StateTimer_t* pTimer);
+
+#endif
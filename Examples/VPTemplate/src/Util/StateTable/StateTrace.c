@@ -0,0 +1,105 @@
+/******************************************************************************
+ * @file StateTrace.c
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Implementation of the binary transition trace
+ *
+ * @details The writer may overwrite the record the reader is about to
+ * copy, so both sides move the indices and copy the record inside a short
+ * critical section.
+ *
+ *
+ *****************************************************************************/
+
+/***** INCLUDES **************************************************************/
+#include "StateTrace.h"
+#include "Critical.h"
+
+#include <string.h>
+
+
+/***** PRIVATE CONSTANTS *****************************************************/
+
+
+/***** PRIVATE MACROS ********************************************************/
+#define STATE_TRACE_INDEX_MASK      (STATE_TRACE_SIZE - 1)      //!< Mask to get the ring index
+
+
+/***** PRIVATE TYPES *********************************************************/
+
+
+/***** PRIVATE PROTOTYPES ****************************************************/
+
+
+/***** PRIVATE VARIABLES *****************************************************/
+
+
+/***** PUBLIC FUNCTIONS ******************************************************/
+
+int32_t stateTraceInitialize(StateTrace_t* pTrace, StateTraceGetTimestamp pGetTimestamp)
+{
+    if (pTrace == 0)
+        return STATE_TRACE_ERR_INVALID_PTR;
+
+    memset(pTrace, 0, sizeof(StateTrace_t));
+    pTrace->pGetTimestamp = pGetTimestamp;
+
+    return STATE_TRACE_ERR_OK;
+}
+
+void stateTraceRecord(StateTrace_t* pTrace, uint8_t stateIndexFrom, uint8_t stateIndexTo, uint8_t eventID, uint8_t guardResult)
+{
+    uint32_t timestamp = (pTrace->pGetTimestamp != 0) ? pTrace->pGetTimestamp() : 0;
+
+    uint32_t state = criticalEnter();
+
+    uint32_t head = pTrace->head;
+    StateTraceRecord_t* pRecord = &(pTrace->records[head & STATE_TRACE_INDEX_MASK]);
+    pRecord->timestamp      = timestamp;
+    pRecord->stateIndexFrom = stateIndexFrom;
+    pRecord->stateIndexTo   = stateIndexTo;
+    pRecord->eventID        = eventID;
+    pRecord->guardResult    = guardResult;
+
+    pTrace->head = head + 1;
+
+    // Drop the oldest record if the reader fell behind
+    if (pTrace->head - pTrace->tail > STATE_TRACE_SIZE)
+    {
+        pTrace->tail = pTrace->head - STATE_TRACE_SIZE;
+        pTrace->overwrittenCount++;
+    }
+
+    criticalExit(state);
+}
+
+int32_t stateTraceRead(StateTrace_t* pTrace, StateTraceRecord_t* pRecord)
+{
+    if (pTrace == 0 || pRecord == 0)
+        return STATE_TRACE_ERR_INVALID_PTR;
+
+    int32_t result = STATE_TRACE_ERR_EMPTY;
+
+    uint32_t state = criticalEnter();
+
+    uint32_t tail = pTrace->tail;
+    if (tail != pTrace->head)
+    {
+        *pRecord = pTrace->records[tail & STATE_TRACE_INDEX_MASK];
+        pTrace->tail = tail + 1;
+        result = STATE_TRACE_ERR_OK;
+    }
+
+    criticalExit(state);
+
+    return result;
+}
+
+
+/***** PRIVATE FUNCTIONS *****************************************************/
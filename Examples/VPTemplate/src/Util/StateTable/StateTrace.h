@@ -0,0 +1,121 @@
+/******************************************************************************
+ * @file StateTrace.h
+ *
+ * @author Lukas Reil
+ * @date   16.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ ******************************************************************************
+ *
+ * @brief Header file for the binary transition trace of the state table
+ *
+ * @details The state table records its transitions and rejected guards as
+ * fixed-size binary records into a RAM ring buffer. Recording is a copy of
+ * eight bytes, the formatting is done later by the reader, e.g. a low
+ * priority task or a debugger dump of the buffer.
+ *
+ * If the reader falls behind, the oldest records are overwritten, so the
+ * buffer always holds the latest transitions (e.g. the way into a failure
+ * state). The number of overwritten records is counted.
+ *
+ *
+ *****************************************************************************/
+#ifndef _STATE_TRACE_H_
+#define _STATE_TRACE_H_
+
+/***** INCLUDES **************************************************************/
+#include <stdint.h>
+
+
+/***** CONSTANTS *************************************************************/
+
+
+/***** MACROS ****************************************************************/
+#define STATE_TRACE_ERR_OK                  0       //!< No error occured
+#define STATE_TRACE_ERR_INVALID_PTR         -1      //!< Invalid pointer (null pointer)
+#define STATE_TRACE_ERR_EMPTY               -2      //!< No record available
+
+#ifndef STATE_TRACE_SIZE
+#define STATE_TRACE_SIZE                    32      //!< Number of records of the ring buffer (power of two)
+#endif
+
+#if (STATE_TRACE_SIZE & (STATE_TRACE_SIZE - 1)) != 0
+#error "STATE_TRACE_SIZE must be a power of two"
+#endif
+
+#define STATE_TRACE_GUARD_NONE              0       //!< Transition without a guard
+#define STATE_TRACE_GUARD_PASSED            1       //!< Transition allowed by its guard
+#define STATE_TRACE_GUARD_REJECTED          2       //!< Transition rejected by its guard, the state didn't change
+
+
+/***** TYPES *****************************************************************/
+
+/**
+ * @brief Function pointer for the time stamp of the records (e.g. HAL_GetTick)
+ *
+ */
+typedef uint32_t (*StateTraceGetTimestamp)(void);
+
+/**
+ * @brief A single trace record
+ *
+ */
+typedef struct _StateTraceRecord
+{
+    uint32_t timestamp;                     //!< Time stamp of the transition
+    uint8_t stateIndexFrom;                 //!< Current state when the event was dispatched
+    uint8_t stateIndexTo;                   //!< Target state of the transition
+    uint8_t eventID;                        //!< Event which triggered the transition
+    uint8_t guardResult;                    //!< STATE_TRACE_GUARD_NONE, _PASSED or _REJECTED
+} StateTraceRecord_t;
+
+/**
+ * @brief Ring buffer of the trace records
+ *
+ */
+typedef struct _StateTrace
+{
+    StateTraceRecord_t records[STATE_TRACE_SIZE];   //!< Ring buffer of the records
+    volatile uint32_t head;                 //!< Free running write index
+    volatile uint32_t tail;                 //!< Free running read index
+    StateTraceGetTimestamp pGetTimestamp;   //!< Time stamp function (may be 0)
+    uint32_t overwrittenCount;              //!< Number of records overwritten before they were read
+} StateTrace_t;
+
+
+/***** PROTOTYPES ************************************************************/
+
+/**
+ * @brief Initializes a trace buffer
+ *
+ * @param pTrace            Pointer to the trace buffer
+ * @param pGetTimestamp     Time stamp function of the records (may be 0)
+ *
+ * @return STATE_TRACE_ERR_OK if no error occured
+ */
+int32_t stateTraceInitialize(StateTrace_t* pTrace, StateTraceGetTimestamp pGetTimestamp);
+
+/**
+ * @brief Adds a record, overwrites the oldest record if the buffer is full
+ *
+ * @param pTrace            Pointer to the trace buffer
+ * @param stateIndexFrom    Current state
+ * @param stateIndexTo      Target state
+ * @param eventID           Event which triggered the transition
+ * @param guardResult       Result of the guard (STATE_TRACE_GUARD_xxx)
+ */
+void stateTraceRecord(StateTrace_t* pTrace, uint8_t stateIndexFrom, uint8_t stateIndexTo, uint8_t eventID, uint8_t guardResult);
+
+/**
+ * @brief Reads and removes the oldest record
+ *
+ * @param pTrace            Pointer to the trace buffer
+ * @param pRecord           Pointer to the struct which receives the record
+ *
+ * @return STATE_TRACE_ERR_OK if a record was read, STATE_TRACE_ERR_EMPTY if
+ * the buffer is empty
+ */
+int32_t stateTraceRead(StateTrace_t* pTrace, StateTraceRecord_t* pRecord);
+
+#endif
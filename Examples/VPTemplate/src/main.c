@@ -20,6 +20,7 @@
 
 #include "Util/Global.h"
 #include "Util/printf.h"
+#include "Util/DSP/DSPBenchmark.h"
 #include "LogOutput.h"
 
 #include "UARTModule.h"
@@ -28,18 +29,24 @@
 #include "ADCModule.h"
 #include "TimerModule.h"
 #include "DisplayModule.h"
+#include "PowerModule.h"
 #include "Scheduler.h"
+#include "Kernel.h"
 
 #include "App/Application.h"
 #include "App/AppTasks.h"
 
 #include "GlobalObjects.h"
+#include "ADCService.h"
 
 
 /***** PRIVATE CONSTANTS *****************************************************/
 
 
 /***** PRIVATE MACROS ********************************************************/
+#define STATISTICS_REPORT_PERIOD    10000       //!< Period of the runtime statistics report in ticks (ms)
+
+#define STATISTICS_REPORT_ENABLED   (LOG_OUTPUT_ENABLED && SCHED_PROFILING_ENABLED)    //!< Enable the runtime statistics report
 
 
 /***** PRIVATE TYPES *********************************************************/
@@ -47,10 +54,19 @@
 
 /***** PRIVATE PROTOTYPES ****************************************************/
 static int32_t initializePeripherals();
+static void onADCConversionComplete(void);
+#if STATISTICS_REPORT_ENABLED
+static CoroutineState coReportStatistics(Coroutine* pCo);
+#endif
 
 
 /***** PRIVATE VARIABLES *****************************************************/
 static Scheduler gScheduler;            // Global Scheduler instance
+static DeferredWorkQueue gADCWorkQueue; // Deferred work posted by the ADC DMA interrupt
+#if STATISTICS_REPORT_ENABLED
+static Coroutine gReportCoroutine;      // Coroutine which prints the runtime statistics
+static uint32_t s_reportTaskIndex = 0;  // Task index of the report, kept across the yields
+#endif
 
 
 /***** PUBLIC FUNCTIONS ******************************************************/
@@ -68,19 +84,72 @@ int main(void)
     // Initialize Peripherals
     initializePeripherals();
 
+#if DSP_BENCHMARK_ENABLED && LOG_OUTPUT_ENABLED
+    // Measures the DSP kernels once with the cycle counter, before the
+    // scheduler runs (DSP_BENCHMARK_ENABLED in DSPBenchmark.h)
+    dspRunBenchmark(timerGetCycleCount, outputLogf);
+#endif
+
     // Prepare Scheduler
     // ...
     appInitialize();
 
     registerHALTickFunction(&gScheduler, HAL_GetTick);
-
-    registerTask(&gScheduler, 10, taskApp10ms);
-    registerTask(&gScheduler, 50, taskApp50ms);
-    registerTask(&gScheduler, 250, taskApp250ms);
+    registerIdleFunction(&gScheduler, powerEnterIdle);
+#if SCHED_PROFILING_ENABLED
+    registerCycleCounterFunction(&gScheduler, timerGetCycleCount, SystemCoreClock / 1000);
+#endif
+
+    // Sampling the inputs or the stack usage several times in a row after a
+    // stall gives no new information, so the missed releases are skipped.
+    // The application task keeps catching up, as the hysteresis counters of
+    // the motor monitoring count calls.
+    // The phases are spread by the scheduler, so the tasks don't release on
+    // the same tick.
+    SchedulerTaskConfig task10msConfig = {
+        .period = 10,
+        .pTask = taskApp10ms,
+        .overrunPolicy = SCHED_OVERRUN_SKIP_TO_NOW,
+        .phase = SCHED_PHASE_AUTO,
+    };
+    SchedulerTaskConfig task50msConfig = {
+        .period = 50,
+        .pTask = taskApp50ms,
+        .overrunPolicy = SCHED_OVERRUN_CATCH_UP,
+        .phase = SCHED_PHASE_AUTO,
+    };
+    SchedulerTaskConfig task250msConfig = {
+        .period = 250,
+        .pTask = taskApp250ms,
+        .overrunPolicy = SCHED_OVERRUN_SKIP_TO_NOW,
+        .phase = SCHED_PHASE_AUTO,
+    };
+
+    // The potentiometers are filtered right after each block of conversion sequences
+    deferredWorkInitQueue(&gADCWorkQueue, 0, timerGetCycleCount);
+    registerDeferredWorkQueue(&gScheduler, &gADCWorkQueue);
+    adcRegisterConversionCallback(onADCConversionComplete);
+
+    registerTaskConfig(&gScheduler, &task10msConfig);
+    registerTaskConfig(&gScheduler, &task50msConfig);
+    registerTaskConfig(&gScheduler, &task250msConfig);
+
+#if STATISTICS_REPORT_ENABLED
+    registerCoroutine(&gScheduler, &gReportCoroutine, coReportStatistics);
+#endif
 
 
     // Initialize Scheduler
     schedInitialize(&gScheduler);
+#if LOG_OUTPUT_ENABLED
+    schedPrintTimeline(&gScheduler, outputLogf);
+#endif
+
+#if KERNEL_PREEMPTIVE_ENABLED
+    // Run the tasks as preemptive threads, only returns on error and then
+    // falls back to the cooperative scheduler
+    kernelStart(&gScheduler);
+#endif
 
     while (1)
     {
@@ -112,8 +181,74 @@ static int32_t initializePeripherals()
     displayInitialize();
 
     // Initialize Timer, DMA and ADC for sensor measurements
+    // The ADC profile sets the trigger rate of the timer
     timerInitialize();
     adcInitialize();
 
+    // Initialize cycle counter for the execution time profiling
+    timerInitializeCycleCounter();
+
+    // Initialize wake-up timer for the tickless idle
+    powerInitialize();
+
     return ERROR_OK;
 }
+
+/**
+ * @brief Called from the DMA interrupt after every block of ADC conversion
+ * sequences, defers the processing of the block to the scheduler (in
+ * kernel mode to the deferred work thread)
+ */
+static void onADCConversionComplete(void)
+{
+    deferredWorkPost(&gADCWorkQueue, workADCSequence, 0);
+#if KERNEL_PREEMPTIVE_ENABLED
+    kernelNotifyDeferredWork();
+#endif
+}
+
+#if STATISTICS_REPORT_ENABLED
+/**
+ * @brief Prints the task profiles and the deferred work statistics
+ * periodically, one line per scheduler cycle to keep the UART buffer and
+ * the super loop free
+ *
+ * @param pCo Pointer to the coroutine control block
+ *
+ * @return State of the coroutine
+ */
+static CoroutineState coReportStatistics(Coroutine* pCo)
+{
+    CO_BEGIN(pCo);
+
+    while (1)
+    {
+        CO_SLEEP_FOR(pCo, STATISTICS_REPORT_PERIOD);
+
+        for (s_reportTaskIndex = 0; s_reportTaskIndex < gScheduler.registeredTaskCount; s_reportTaskIndex++)
+        {
+            SchedulerTaskProfile profile;
+            uint32_t missedReleases = 0;
+
+            schedGetTaskProfile(&gScheduler, s_reportTaskIndex, &profile);
+            schedGetMissedReleases(&gScheduler, s_reportTaskIndex, &missedReleases);
+            DEBUG_LOGF("Task %u: runs %u, cycles min %u mean %u max %u, jitter max %u, missed %u\n\r",
+                s_reportTaskIndex, profile.runCount, profile.minCycles, profile.meanCycles, profile.maxCycles,
+                profile.maxStartJitter, missedReleases);
+
+            CO_YIELD(pCo);
+        }
+
+        DeferredWorkStatistics statistics;
+        deferredWorkGetStatistics(&gADCWorkQueue, &statistics);
+        DEBUG_LOGF("ADC work: posted %u, dropped %u, depth max %u, latency mean %u max %u cycles\n\r",
+            statistics.postCount, statistics.droppedCount, statistics.maxDepth, statistics.meanLatency, statistics.maxLatency);
+        CO_YIELD(pCo);
+
+        DEBUG_LOGF("ADC profile %s: temperature sensor %d uV, VBAT %d uV, VREFINT %d uV\n\r",
+            adcGetProfile()->pName, getTemperatureSensorVoltage(), getVbatVoltage(), getVrefintVoltage());
+    }
+
+    CO_END(pCo);
+}
+#endif
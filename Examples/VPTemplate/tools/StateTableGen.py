@@ -0,0 +1,439 @@
+#!/usr/bin/env python3
+"""
+State table code generator
+
+Reads a compact description of a state machine (states, events, guards,
+actions, transitions) and generates:
+
+  <name>.h    enums for the state and event IDs, the prototypes of the
+              actions and guards and the declaration of the definition
+  <name>.c    the constant StateTableDefinition_t: state list, transitions,
+              index resolved dispatch matrix and event priorities
+  <name>.dot  Graphviz diagram of the state machine
+
+The description is checked while generating (unknown or duplicate names,
+nesting depth, unreachable states, events without a transition, shadowed
+transitions, unhandled timeout events). Any error stops the generation, so
+an inconsistent state machine fails the build instead of the target.
+
+Format of the description (one item per line, '#' starts a comment, the
+comment of a state or event line documents its ID):
+
+  machine <Name>
+  initial <STATE>
+  state <NAME> [parent=<NAME>] [entry=<fn>] [do=<fn>] [exit=<fn>] [timeout=<ms>:<EVENT>]
+  event <NAME> [priority=highest|default|<0..255>]
+  <FROM> -> <TO> on <EVENT> [if <guard>]
+
+Usage: StateTableGen.py <description> <output base path>
+"""
+
+import os
+import sys
+
+
+STATE_PREFIX = "STATE_ID_"
+EVENT_PREFIX = "EVT_ID_"
+MAX_DEPTH = 4                   # STATETBL_MAX_DEPTH
+NO_PARENT = "STT_NO_PARENT"
+
+PRIORITY_NAMES = {
+    "highest": "STATETBL_EVENT_PRIORITY_HIGHEST",
+    "default": "STATETBL_EVENT_PRIORITY_DEFAULT",
+}
+
+
+class GeneratorError(Exception):
+    pass
+
+
+class State:
+    def __init__(self, name, line):
+        self.name = name
+        self.line = line
+        self.parent = None
+        self.entry = None
+        self.do = None
+        self.exit = None
+        self.timeout = 0
+        self.timeoutEvent = None
+        self.doc = ""
+
+
+class Event:
+    def __init__(self, name, line):
+        self.name = name
+        self.line = line
+        self.priority = "default"
+        self.doc = ""
+
+
+class Transition:
+    def __init__(self, source, target, event, guard, line):
+        self.source = source
+        self.target = target
+        self.event = event
+        self.guard = guard
+        self.line = line
+
+
+class StateMachine:
+    def __init__(self):
+        self.name = None
+        self.initial = None
+        self.states = []
+        self.events = []
+        self.transitions = []
+        self.errors = []
+        self.warnings = []
+
+    def state(self, name):
+        return next((s for s in self.states if s.name == name), None)
+
+    def event(self, name):
+        return next((e for e in self.events if e.name == name), None)
+
+    def ancestors(self, state):
+        """ State itself and its ancestors, innermost first """
+        chain = []
+        while state is not None and state not in chain:
+            chain.append(state)
+            state = self.state(state.parent) if state.parent else None
+        return chain
+
+    def isLeaf(self, state):
+        return not any(s.parent == state.name for s in self.states)
+
+
+def parseDescription(path):
+    machine = StateMachine()
+
+    with open(path) as file:
+        for lineNumber, line in enumerate(file, 1):
+            where = "%s:%d" % (path, lineNumber)
+            code, _, comment = line.partition("#")
+            tokens = code.split()
+            if not tokens:
+                continue
+
+            keyword = tokens[0]
+            if keyword == "machine" and len(tokens) == 2:
+                machine.name = tokens[1]
+            elif keyword == "initial" and len(tokens) == 2:
+                machine.initial = tokens[1]
+            elif keyword == "state" and len(tokens) >= 2:
+                state = State(tokens[1], where)
+                for option in tokens[2:]:
+                    key, _, value = option.partition("=")
+                    if key == "parent":
+                        state.parent = value
+                    elif key in ("entry", "do", "exit"):
+                        setattr(state, key, value)
+                    elif key == "timeout" and ":" in value:
+                        time, _, state.timeoutEvent = value.partition(":")
+                        if not time.isdigit() or int(time) == 0:
+                            raise GeneratorError("%s: invalid timeout '%s'" % (where, time))
+                        state.timeout = int(time)
+                    else:
+                        raise GeneratorError("%s: unknown state option '%s'" % (where, option))
+                state.doc = comment.strip()
+                machine.states.append(state)
+            elif keyword == "event" and len(tokens) >= 2:
+                event = Event(tokens[1], where)
+                for option in tokens[2:]:
+                    key, _, value = option.partition("=")
+                    if key == "priority" and (value in PRIORITY_NAMES or (value.isdigit() and int(value) <= 255)):
+                        event.priority = value
+                    else:
+                        raise GeneratorError("%s: unknown event option '%s'" % (where, option))
+                event.doc = comment.strip()
+                machine.events.append(event)
+            elif len(tokens) in (5, 7) and tokens[1] == "->" and tokens[3] == "on" and (len(tokens) == 5 or tokens[5] == "if"):
+                guard = tokens[6] if len(tokens) == 7 else None
+                machine.transitions.append(Transition(tokens[0], tokens[2], tokens[4], guard, where))
+            else:
+                raise GeneratorError("%s: syntax error" % where)
+
+    return machine
+
+
+def checkStateMachine(machine):
+    errors = machine.errors
+    warnings = machine.warnings
+
+    if machine.name is None:
+        errors.append("missing 'machine' line")
+    if not machine.states:
+        errors.append("no states defined")
+    if machine.initial is None or machine.state(machine.initial) is None:
+        errors.append("unknown or missing initial state '%s'" % machine.initial)
+    if len(machine.states) >= 255 or len(machine.events) >= 255:
+        errors.append("too many states or events (indices are uint8_t)")
+
+    for items, kind in ((machine.states, "state"), (machine.events, "event")):
+        names = [item.name for item in items]
+        for item in items:
+            if names.count(item.name) > 1:
+                errors.append("%s: duplicate %s '%s'" % (item.line, kind, item.name))
+
+    for state in machine.states:
+        if state.parent is not None and machine.state(state.parent) is None:
+            errors.append("%s: unknown parent state '%s'" % (state.line, state.parent))
+        elif len(machine.ancestors(state)) > MAX_DEPTH or machine.ancestors(state)[-1].parent is not None:
+            errors.append("%s: state '%s' is nested too deep or its parents form a cycle" % (state.line, state.name))
+        if state.timeoutEvent is not None and machine.event(state.timeoutEvent) is None:
+            errors.append("%s: unknown timeout event '%s'" % (state.line, state.timeoutEvent))
+
+    for transition in machine.transitions:
+        for name, lookup in ((transition.source, machine.state), (transition.target, machine.state), (transition.event, machine.event)):
+            if lookup(name) is None:
+                errors.append("%s: unknown state or event '%s'" % (transition.line, name))
+
+    if errors:
+        return
+
+    # A transition after an unguarded one for the same state and event is never taken
+    for index, transition in enumerate(machine.transitions):
+        for previous in machine.transitions[:index]:
+            if (previous.source, previous.event) == (transition.source, transition.event) and previous.guard is None:
+                errors.append("%s: transition is shadowed by the unguarded transition in %s" % (transition.line, previous.line))
+                break
+
+    for transition in machine.transitions:
+        if not machine.isLeaf(machine.state(transition.target)):
+            warnings.append("%s: target state '%s' isn't a leaf state" % (transition.line, transition.target))
+
+    # Reachability: a reached state activates its ancestors, the transitions
+    # of the ancestors apply to it as well
+    reached = [machine.state(machine.initial)]
+    for state in reached:
+        for ancestor in machine.ancestors(state):
+            for transition in machine.transitions:
+                target = machine.state(transition.target)
+                if transition.source == ancestor.name and target not in reached:
+                    reached.append(target)
+
+    active = set()
+    for state in reached:
+        active.update(s.name for s in machine.ancestors(state))
+
+    for state in machine.states:
+        if state.name not in active:
+            errors.append("%s: state '%s' is unreachable" % (state.line, state.name))
+
+    for event in machine.events:
+        if not any(t.event == event.name for t in machine.transitions):
+            errors.append("%s: event '%s' is not handled by any transition" % (event.line, event.name))
+
+    for state in machine.states:
+        if state.timeoutEvent is not None:
+            scope = [s.name for s in machine.ancestors(state)]
+            if not any(t.event == state.timeoutEvent and t.source in scope for t in machine.transitions):
+                errors.append("%s: timeout event '%s' isn't handled in state '%s'" % (state.line, state.timeoutEvent, state.name))
+
+
+def fileHeader(fileName, brief):
+    return (
+        "/******************************************************************************\n"
+        " * @file %s\n"
+        " *\n"
+        " * @brief %s\n"
+        " *\n"
+        " * @details Generated by tools/StateTableGen.py, do not edit. Change the\n"
+        " * description (.sm) instead, the firmware build regenerates this file.\n"
+        " *\n"
+        " *\n"
+        " *****************************************************************************/\n" % (fileName, brief))
+
+
+def enumerator(name, value, doc):
+    line = "    %s = %s," % (name, value)
+    return (line.ljust(40) + "//!< " + doc if doc else line) + "\n"
+
+
+def functionName(value):
+    return value if value else "0"
+
+
+def generateHeader(machine, baseName):
+    guard = "_" + "".join("_" + c if c.isupper() and i > 0 and not baseName[i - 1].isupper() else c
+                          for i, c in enumerate(baseName)).upper() + "_H_"
+
+    actions = []
+    for state in machine.states:
+        for action in (state.entry, state.do, state.exit):
+            if action and action not in actions:
+                actions.append(action)
+    guards = []
+    for transition in machine.transitions:
+        if transition.guard and transition.guard not in guards:
+            guards.append(transition.guard)
+
+    out = [fileHeader(baseName + ".h", "IDs and definition of the %s state machine" % machine.name)]
+    out.append("#ifndef %s\n#define %s\n\n" % (guard, guard))
+    out.append("/***** INCLUDES **************************************************************/\n")
+    out.append("#include \"Util/StateTable/StateTable.h\"\n\n\n")
+    out.append("/***** CONSTANTS *************************************************************/\n\n\n")
+    out.append("/***** MACROS ****************************************************************/\n\n\n")
+    out.append("/***** TYPES *****************************************************************/\n\n")
+
+    out.append("/**\n * @brief State IDs, the ID is the index in the state list\n *\n */\n")
+    out.append("typedef enum _%sStateID\n{\n" % machine.name)
+    for index, state in enumerate(machine.states):
+        out.append(enumerator(STATE_PREFIX + state.name, index, state.doc))
+    out.append(enumerator(STATE_PREFIX + "COUNT", len(machine.states), "Number of states"))
+    out.append("} %sStateID_t;\n\n" % machine.name)
+
+    out.append("/**\n * @brief Event IDs, 0 is STT_NONE_EVENT\n *\n */\n")
+    out.append("typedef enum _%sEventID\n{\n" % machine.name)
+    for index, event in enumerate(machine.events):
+        out.append(enumerator(EVENT_PREFIX + event.name, index + 1, event.doc))
+    out.append(enumerator(EVENT_PREFIX + "COUNT", len(machine.events) + 1, "Number of event IDs including STT_NONE_EVENT"))
+    out.append("} %sEventID_t;\n\n\n" % machine.name)
+
+    out.append("/***** PROTOTYPES ************************************************************/\n\n")
+    out.append("// Actions of the states, implemented by the application\n")
+    for action in actions:
+        out.append("int32_t %s(StateTable_t* pStateTable, int32_t eventID);\n" % action)
+    if guards:
+        out.append("\n// Transition guards, implemented by the application\n")
+        for guardName in guards:
+            out.append("bool %s(StateTable_t* pStateTable, const StateTableEntry_t* pEntry, int32_t eventID);\n" % guardName)
+    out.append("\n/**\n * @brief Definition of the %s state machine (constant, in flash)\n *\n */\n" % machine.name)
+    out.append("extern const StateTableDefinition_t g%sStateMachine;\n\n#endif\n" % machine.name)
+    return "".join(out)
+
+
+def generateSource(machine, baseName):
+    stateIDs = {s.name: STATE_PREFIX + s.name for s in machine.states}
+    eventIDs = {e.name: EVENT_PREFIX + e.name for e in machine.events}
+
+    out = [fileHeader(baseName + ".c", "Constant definition of the %s state machine" % machine.name)]
+    out.append("/***** INCLUDES **************************************************************/\n")
+    out.append("#include \"%s.h\"\n\n\n" % baseName)
+    out.append("/***** PRIVATE VARIABLES *****************************************************/\n\n")
+
+    out.append("/**\n * @brief List of the states, the position in the list is the state ID\n *\n */\n")
+    out.append("static const State_t s_states[%sCOUNT] =\n{\n" % STATE_PREFIX)
+    for state in machine.states:
+        parent = stateIDs[state.parent] if state.parent else NO_PARENT
+        timeout = ", %s, %d" % (eventIDs[state.timeoutEvent], state.timeout) if state.timeoutEvent else ""
+        out.append("    [%s] = {%s, %s, %s, %s%s},\n" % (stateIDs[state.name], functionName(state.entry),
+                                                        functionName(state.do), functionName(state.exit), parent, timeout))
+    out.append("};\n\n")
+
+    # Transitions of the same state and event are chained in the order of the description
+    chains = {}
+    for index, transition in enumerate(machine.transitions):
+        chains.setdefault((transition.source, transition.event), []).append(index)
+
+    out.append("/**\n * @brief Transitions: FROM_STATE_ID, TO_STATE_ID, EVENT_ID, guard and the\n")
+    out.append(" * next transition for the same state and event (0 if none)\n *\n */\n")
+    out.append("static const StateTableEntry_t s_transitions[%d] =\n{\n" % len(machine.transitions))
+    for index, transition in enumerate(machine.transitions):
+        chain = chains[(transition.source, transition.event)]
+        position = chain.index(index)
+        nextEntry = "&s_transitions[%d]" % chain[position + 1] if position + 1 < len(chain) else "0"
+        out.append("    [%d] = {%s, %s, %s, %s, %s},\n" % (index, stateIDs[transition.source], stateIDs[transition.target],
+                                                         eventIDs[transition.event], functionName(transition.guard), nextEntry))
+    out.append("};\n\n")
+
+    out.append("/**\n * @brief Dispatch matrix [STATE_ID][EVT_ID] with the first transition for\n")
+    out.append(" * each combination, all other combinations aren't handled\n *\n */\n")
+    out.append("static const StateTableEntry_t* const s_dispatch[%sCOUNT][%sCOUNT] =\n{\n" % (STATE_PREFIX, EVENT_PREFIX))
+    for (source, event), chain in chains.items():
+        out.append("    [%s][%s] = &s_transitions[%d],\n" % (stateIDs[source], eventIDs[event], chain[0]))
+    out.append("};\n\n")
+
+    out.append("/**\n * @brief Priorities of the events\n *\n */\n")
+    out.append("static const uint8_t s_eventPriority[%sCOUNT] =\n{\n" % EVENT_PREFIX)
+    out.append("    [STT_NONE_EVENT] = %s,\n" % PRIORITY_NAMES["default"])
+    for event in machine.events:
+        out.append("    [%s] = %s,\n" % (eventIDs[event.name], PRIORITY_NAMES.get(event.priority, event.priority)))
+    out.append("};\n\n\n")
+
+    out.append("/***** PUBLIC VARIABLES ******************************************************/\n\n")
+    out.append("const StateTableDefinition_t g%sStateMachine =\n{\n" % machine.name)
+    out.append("    s_states, %sCOUNT, %sCOUNT, %s, &s_dispatch[0][0], s_eventPriority\n};\n"
+               % (STATE_PREFIX, EVENT_PREFIX, stateIDs[machine.initial]))
+    return "".join(out)
+
+
+def generateDiagram(machine):
+    def node(state):
+        # Edges of a parent state start or end at the border of its cluster
+        leaf = state
+        while not machine.isLeaf(leaf):
+            leaf = next(s for s in machine.states if s.parent == leaf.name)
+        return leaf.name, "cluster_" + state.name if leaf is not state else None
+
+    def emit(parent, indent):
+        lines = []
+        for state in (s for s in machine.states if s.parent == parent):
+            if machine.isLeaf(state):
+                actions = ["%s/ %s" % (kind, name) for kind, name in (("entry", state.entry), ("do", state.do), ("exit", state.exit)) if name]
+                if state.timeoutEvent:
+                    actions.append("after %d ms/ %s" % (state.timeout, state.timeoutEvent))
+                label = "\\n".join([state.name] + actions)
+                lines.append("%s%s [label=\"%s\"];\n" % (indent, state.name, label))
+            else:
+                lines.append("%ssubgraph cluster_%s {\n%s    label=\"%s\";\n" % (indent, state.name, indent, state.name))
+                lines.extend(emit(state.name, indent + "    "))
+                lines.append("%s}\n" % indent)
+        return lines
+
+    out = ["// Generated by tools/StateTableGen.py, do not edit\n"]
+    out.append("digraph %s {\n    compound=true;\n    node [shape=box, style=rounded];\n" % machine.name)
+    out.append("    __initial [shape=point];\n")
+    out.extend(emit(None, "    "))
+    out.append("    __initial -> %s;\n" % machine.initial)
+
+    for transition in machine.transitions:
+        source, tail = node(machine.state(transition.source))
+        target, head = node(machine.state(transition.target))
+        label = transition.event + (" [%s]" % transition.guard if transition.guard else "")
+        attributes = ["label=\"%s\"" % label]
+        if tail:
+            attributes.append("ltail=%s" % tail)
+        if head:
+            attributes.append("lhead=%s" % head)
+        out.append("    %s -> %s [%s];\n" % (source, target, ", ".join(attributes)))
+
+    out.append("}\n")
+    return "".join(out)
+
+
+def writeFile(path, content):
+    with open(path, "w") as file:
+        file.write(content)
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+        return 2
+
+    description, outputBase = argv[1], argv[2]
+    try:
+        machine = parseDescription(description)
+    except GeneratorError as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 1
+
+    checkStateMachine(machine)
+    for warning in machine.warnings:
+        print("warning: %s" % warning, file=sys.stderr)
+    for error in machine.errors:
+        print("error: %s" % error, file=sys.stderr)
+    if machine.errors:
+        return 1
+
+    baseName = os.path.basename(outputBase)
+    writeFile(outputBase + ".h", generateHeader(machine, baseName))
+    writeFile(outputBase + ".c", generateSource(machine, baseName))
+    writeFile(outputBase + ".dot", generateDiagram(machine))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))